@@ -0,0 +1,213 @@
+#ifndef CACHE_TOPOLOGY_H
+#define CACHE_TOPOLOGY_H
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+// 缓存拓扑：Linux 上读取 /sys/devices/system/cpu/cpuN/cache/index*，
+// 每一级给出容量、行大小、组相联路数、组数以及共享该缓存的 CPU 列表。
+// /proc/cpuinfo 里没有 "L3 cache" 这样的行，sysconf 也不提供共享关系和相联度，
+// 所以各个分块计算器（BlockSizeCalculator / TileSizeCalculator / compute_tile_sizes）统一从这里取数。
+// sysfs 不可用时（容器裁剪、macOS）依次回退到 sysconf / sysctl 和典型默认值。
+
+// 一级缓存的描述
+struct CacheLevelInfo {
+    int level = 0;                 // 1 / 2 / 3
+    std::string type;              // "Data" / "Instruction" / "Unified"
+    int64_t size = 0;              // 字节
+    int line_size = 64;            // 缓存行大小（字节）
+    int ways = 0;                  // 组相联路数，0 表示未知
+    int sets = 0;                  // 组数，0 表示未知
+    std::string shared_cpu_list;   // 原始字符串，如 "0-3,8-11"
+    std::vector<int> shared_cpus;  // 展开后的 CPU 编号
+
+    // 共享该缓存的逻辑 CPU 数（至少为 1）
+    int sharing() const { return shared_cpus.empty() ? 1 : static_cast<int>(shared_cpus.size()); }
+
+    // 平均到每个逻辑 CPU 的容量
+    int64_t per_cpu_size() const { return size / sharing(); }
+
+    // 分块时一个线程可以假定独占的容量：跨核共享的末级缓存（L3 及以上）按共享的逻辑 CPU 数平分，
+    // 所有核同时跑分块内核时各自的块加起来才不会超过整个 L3；L1 / L2 只与同核的超线程共享，按整体容量
+    int64_t blocking_size() const { return level >= 3 ? per_cpu_size() : size; }
+
+    // 组数未知时由容量、行大小和路数推出
+    int num_sets() const {
+        if (sets > 0) return sets;
+        if (ways > 0 && line_size > 0) return static_cast<int>(size / (static_cast<int64_t>(ways) * line_size));
+        return 0;
+    }
+};
+
+class CacheTopology {
+public:
+    // 进程内只探测一次（CPU 0 的视角）
+    static const CacheTopology& get() {
+        static const CacheTopology topo = detect(0);
+        return topo;
+    }
+
+    // 探测指定 CPU 的缓存层次
+    static CacheTopology detect(int cpu) {
+        CacheTopology t;
+        t.read_sysfs(cpu);
+        if (t.levels_.empty()) t.read_fallback();
+        return t;
+    }
+
+    // 某一级的数据缓存（Data 或 Unified），不存在时返回 nullptr
+    const CacheLevelInfo* data_cache(int level) const {
+        for (const CacheLevelInfo& c : levels_) {
+            if (c.level == level && c.type != "Instruction") return &c;
+        }
+        return nullptr;
+    }
+
+    // 某一级数据缓存的容量，不存在时返回 fallback
+    int64_t data_cache_size(int level, int64_t fallback) const {
+        const CacheLevelInfo* c = data_cache(level);
+        return c && c->size > 0 ? c->size : fallback;
+    }
+
+    // 某一级数据缓存用于分块的容量（CacheLevelInfo::blocking_size），不存在时返回 fallback
+    int64_t data_cache_blocking_size(int level, int64_t fallback) const {
+        const CacheLevelInfo* c = data_cache(level);
+        return c && c->size > 0 ? c->blocking_size() : fallback;
+    }
+
+    const std::vector<CacheLevelInfo>& levels() const { return levels_; }
+    bool from_sysfs() const { return from_sysfs_; }
+
+    void print() const {
+        std::cout << "Cache topology (" << (from_sysfs_ ? "sysfs" : "fallback") << "):\n";
+        for (const CacheLevelInfo& c : levels_) {
+            std::cout << "  L" << c.level << " " << c.type << ": " << c.size / 1024 << "KB, line " << c.line_size
+                      << "B, " << c.ways << "-way, " << c.num_sets() << " sets, shared by " << c.sharing()
+                      << " CPUs";
+            if (!c.shared_cpu_list.empty()) std::cout << " [" << c.shared_cpu_list << "]";
+            std::cout << "\n";
+        }
+    }
+
+    // 解析 "0-3,8,10-11" 形式的 CPU 列表
+    static std::vector<int> parse_cpu_list(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (item.empty()) continue;
+            size_t dash = item.find('-');
+            int lo = std::stoi(item.substr(0, dash));
+            int hi = dash == std::string::npos ? lo : std::stoi(item.substr(dash + 1));
+            for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+        }
+        return cpus;
+    }
+
+    // 解析 "48K" / "2048K" / "105M" 形式的容量
+    static int64_t parse_size(const std::string& s) {
+        if (s.empty()) return 0;
+        int64_t v = std::stoll(s);
+        switch (s.back()) {
+            case 'K': return v * 1024;
+            case 'M': return v * 1024 * 1024;
+            case 'G': return v * 1024 * 1024 * 1024;
+            default: return v;
+        }
+    }
+
+private:
+    static bool read_line(const std::string& path, std::string& out) {
+        std::ifstream f(path);
+        if (!f || !std::getline(f, out)) return false;
+        while (!out.empty() && (out.back() == '\n' || out.back() == ' ')) out.pop_back();
+        return true;
+    }
+
+    static int read_int(const std::string& path, int fallback) {
+        std::string s;
+        if (!read_line(path, s) || s.empty()) return fallback;
+        return std::stoi(s);
+    }
+
+    void read_sysfs(int cpu) {
+        const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cache/index";
+        for (int idx = 0;; ++idx) {
+            const std::string dir = base + std::to_string(idx) + "/";
+            std::string level, size;
+            if (!read_line(dir + "level", level) || !read_line(dir + "size", size)) break;
+            CacheLevelInfo c;
+            c.level = std::stoi(level);
+            read_line(dir + "type", c.type);
+            c.size = parse_size(size);
+            c.line_size = read_int(dir + "coherency_line_size", 64);
+            c.ways = read_int(dir + "ways_of_associativity", 0);
+            c.sets = read_int(dir + "number_of_sets", 0);
+            if (read_line(dir + "shared_cpu_list", c.shared_cpu_list)) c.shared_cpus = parse_cpu_list(c.shared_cpu_list);
+            levels_.push_back(c);
+        }
+        from_sysfs_ = !levels_.empty();
+    }
+
+    void add_fallback(int level, const char* type, int64_t size, int line_size, int ways) {
+        if (size <= 0) return;
+        CacheLevelInfo c;
+        c.level = level;
+        c.type = type;
+        c.size = size;
+        c.line_size = line_size > 0 ? line_size : 64;
+        c.ways = ways > 0 ? ways : 0;
+        levels_.push_back(c);
+    }
+
+    void read_fallback() {
+#ifdef __linux__
+        int line = static_cast<int>(sysconf(_SC_LEVEL1_DCACHE_LINESIZE));
+        add_fallback(1, "Data", sysconf(_SC_LEVEL1_DCACHE_SIZE), line, static_cast<int>(sysconf(_SC_LEVEL1_DCACHE_ASSOC)));
+        add_fallback(2, "Unified", sysconf(_SC_LEVEL2_CACHE_SIZE), line, static_cast<int>(sysconf(_SC_LEVEL2_CACHE_ASSOC)));
+        add_fallback(3, "Unified", sysconf(_SC_LEVEL3_CACHE_SIZE), line, static_cast<int>(sysconf(_SC_LEVEL3_CACHE_ASSOC)));
+#elif defined(__APPLE__)
+        int64_t l1 = 0, l2 = 0, l3 = 0, line = 0;
+        size_t len = sizeof(int64_t);
+        sysctlbyname("hw.l1dcachesize", &l1, &len, NULL, 0);
+        len = sizeof(int64_t);
+        sysctlbyname("hw.l2cachesize", &l2, &len, NULL, 0);
+        len = sizeof(int64_t);
+        sysctlbyname("hw.l3cachesize", &l3, &len, NULL, 0);
+        len = sizeof(int64_t);
+        sysctlbyname("hw.cachelinesize", &line, &len, NULL, 0);
+        add_fallback(1, "Data", l1, static_cast<int>(line), 0);
+        add_fallback(2, "Unified", l2, static_cast<int>(line), 0);
+        add_fallback(3, "Unified", l3, static_cast<int>(line), 0);
+#endif
+        if (levels_.empty()) {
+            std::cerr << "Warning: Cache detection not supported on this platform, using defaults.\n";
+            add_fallback(1, "Data", 32 * 1024, 64, 8);
+            add_fallback(2, "Unified", 256 * 1024, 64, 8);
+            add_fallback(3, "Unified", 8 * 1024 * 1024, 64, 16);
+        }
+    }
+
+    std::vector<CacheLevelInfo> levels_;
+    bool from_sysfs_ = false;
+};
+
+// 把 "L1d cache" / "L1 cache" / "L2 cache" / "L3 cache" 这类名字映射到缓存级别，无法识别时返回 0
+inline int cache_level_from_name(const std::string& name) {
+    size_t pos = name.find('L');
+    if (pos == std::string::npos || pos + 1 >= name.size()) return 0;
+    char d = name[pos + 1];
+    return (d >= '1' && d <= '4') ? d - '0' : 0;
+}
+
+#endif // CACHE_TOPOLOGY_H
@@ -0,0 +1,132 @@
+#ifndef PADDED_MATRIX_H
+#define PADDED_MATRIX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <numeric>
+
+#include "CacheTopology.h"
+
+// 按缓存组相联几何选择前导维（leading dimension）的行主序矩阵。
+//
+// 组相联缓存中，地址按 (地址 / 行大小) % 组数 映射到组。行步长为 ld * sizeof(T) 字节时，
+// 沿一列向下访问的第 r 行落在第 (r * 步长 / 行大小) % 组数 组。512、1024 这类二次幂宽度的
+// 步长恰好是组数 × 行大小的约数或倍数，连续几十行只落在少数几个组里，超过路数就互相驱逐：
+// 分块 GEMM 读 B 的一列、写 C 的一个块时 L1 命中率会掉一半以上。
+// 把步长（以缓存行计）取成与组数互素的值，相邻 sets 行就覆盖全部组；组数是 2 的幂时即奇数行。
+// 步长仍是整数个缓存行，行首保持对齐，SIMD 加载不受影响。
+
+// 单级缓存下的前导维：cols 列、元素大小 elem 字节、缓存行 line 字节、sets 组。
+// 一行不足一个缓存行或几何信息未知时不填充
+inline int padded_leading_dim(int cols, size_t elem, int line, int sets) {
+    if (cols <= 0 || elem == 0 || line <= 0 || line % static_cast<int>(elem) != 0) return cols;
+    const int64_t row_bytes = static_cast<int64_t>(cols) * elem;
+    if (row_bytes < line || sets <= 1) return cols;
+    int64_t lines = (row_bytes + line - 1) / line;
+    while (std::gcd<int64_t, int64_t>(lines, sets) != 1) ++lines;
+    return static_cast<int>(lines * line / static_cast<int64_t>(elem));
+}
+
+// 同时照顾 L1 和 L2：步长与两级的组数都互素（两者都是 2 的幂时就是奇数个缓存行）。
+// L3 按切片哈希分布，简单的取模模型不适用，这里不考虑
+inline int padded_leading_dim(int cols, size_t elem, const CacheTopology& topo = CacheTopology::get()) {
+    const CacheLevelInfo* l1 = topo.data_cache(1);
+    if (!l1) return cols;
+    int ld = padded_leading_dim(cols, elem, l1->line_size, l1->num_sets());
+    const CacheLevelInfo* l2 = topo.data_cache(2);
+    if (ld == cols || !l2 || l2->line_size != l1->line_size) return ld;
+    // 在 L1 的结果上继续按缓存行递增，直到与 L2 组数也互素
+    const int line = l1->line_size;
+    for (int64_t lines = static_cast<int64_t>(ld) * elem / line;; ++lines) {
+        if (std::gcd<int64_t, int64_t>(lines, l1->num_sets()) == 1 &&
+            (l2->num_sets() <= 1 || std::gcd<int64_t, int64_t>(lines, l2->num_sets()) == 1))
+            return static_cast<int>(lines * line / static_cast<int64_t>(elem));
+    }
+}
+
+// 行主序矩阵，行与行之间隔 ld 个元素（ld >= cols），首地址按 64 字节对齐。
+// 填充部分始终为 0，可以直接把 data() / ld() 交给带前导维的内核
+template <typename T>
+class PaddedMatrix {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    PaddedMatrix() = default;
+
+    // 前导维由本机缓存几何决定
+    PaddedMatrix(int rows, int cols) : PaddedMatrix(rows, cols, padded_leading_dim(cols, sizeof(T))) {}
+
+    // 显式指定前导维（ld == cols 即普通的紧凑矩阵，便于对比）
+    PaddedMatrix(int rows, int cols, int ld) : rows_(rows), cols_(cols), ld_(std::max(ld, cols)) {
+        size_t bytes = static_cast<size_t>(rows_) * ld_ * sizeof(T);
+        bytes = std::max<size_t>((bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT, ALIGNMENT);
+        data_ = static_cast<T*>(std::aligned_alloc(ALIGNMENT, bytes));
+        if (!data_) throw std::bad_alloc();
+        std::memset(data_, 0, bytes);
+    }
+
+    ~PaddedMatrix() { std::free(data_); }
+
+    PaddedMatrix(const PaddedMatrix&) = delete;
+    PaddedMatrix& operator=(const PaddedMatrix&) = delete;
+
+    PaddedMatrix(PaddedMatrix&& o) noexcept : rows_(o.rows_), cols_(o.cols_), ld_(o.ld_), data_(o.data_) {
+        o.data_ = nullptr;
+        o.rows_ = o.cols_ = o.ld_ = 0;
+    }
+
+    PaddedMatrix& operator=(PaddedMatrix&& o) noexcept {
+        if (this != &o) {
+            std::free(data_);
+            rows_ = o.rows_;
+            cols_ = o.cols_;
+            ld_ = o.ld_;
+            data_ = o.data_;
+            o.data_ = nullptr;
+            o.rows_ = o.cols_ = o.ld_ = 0;
+        }
+        return *this;
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int ld() const { return ld_; }
+    bool padded() const { return ld_ != cols_; }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    T* row(int i) { return data_ + static_cast<size_t>(i) * ld_; }
+    const T* row(int i) const { return data_ + static_cast<size_t>(i) * ld_; }
+
+    T& operator()(int i, int j) { return row(i)[j]; }
+    const T& operator()(int i, int j) const { return row(i)[j]; }
+
+    // 与紧凑存储（或任意前导维 src_ld）之间逐行拷贝
+    void load(const T* src, int src_ld) {
+        for (int i = 0; i < rows_; ++i) std::copy(src + static_cast<size_t>(i) * src_ld,
+                                                  src + static_cast<size_t>(i) * src_ld + cols_, row(i));
+    }
+    void load(const T* src) { load(src, cols_); }
+
+    void store(T* dst, int dst_ld) const {
+        for (int i = 0; i < rows_; ++i) std::copy(row(i), row(i) + cols_, dst + static_cast<size_t>(i) * dst_ld);
+    }
+    void store(T* dst) const { store(dst, cols_); }
+
+    // 只写有效列，填充保持为 0
+    void fill(T value) {
+        for (int i = 0; i < rows_; ++i) std::fill(row(i), row(i) + cols_, value);
+    }
+
+private:
+    int rows_ = 0;
+    int cols_ = 0;
+    int ld_ = 0;
+    T* data_ = nullptr;
+};
+
+#endif // PADDED_MATRIX_H
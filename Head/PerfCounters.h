@@ -0,0 +1,299 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+// 基于 perf_event_open 的硬件计数器：判断分块内核究竟卡在 L1、LLC、DTLB 还是 FMA 端口上。
+//
+//   cycles / instructions   IPC
+//   l1d_misses              L1D 读缺失（PERF_COUNT_HW_CACHE_L1D）
+//   llc_misses              末级缓存缺失
+//   dtlb_misses             DTLB 读缺失
+//   fp_scalar / fp_128 / fp_256 / fp_512
+//                           Intel FP_ARITH_INST_RETIRED（事件 0xC7）的单精度各宽度计数，
+//                           FMA 计两次，所以 flops = scalar + 4*fp_128 + 8*fp_256 + 16*fp_512
+//   page_faults             软件事件，大页 / 首次访问的效果直接体现在这里
+//
+// 每个事件单独打开（不组成 group），通用计数器不够时内核会轮换复用，读数按
+// time_enabled / time_running 放大。计数器打开后一直运行，不做 RESET / DISABLE：
+// 一次测量是两次读数之差，所以测量可以任意嵌套（基准外层的测量与内核里的 PERF_SCOPE 互不干扰）。计数只覆盖调用线程（pid = 0, cpu = -1），
+// 线程池中的工作线程不计入。
+// 打不开的事件（虚拟机没有 PMU、perf_event_paranoid 过高、非 Intel 的 FP_ARITH）单独标记为不可用，
+// 全部不可用时 stop 返回空的 PerfSample（valid 全为 false），调用方无需判断。
+//
+// 用法：
+//   PerfCounters& pc = PerfCounters::get();     // 当前线程的计数器
+//   PerfSnapshot t0 = pc.start();  kernel(...);  PerfSample s = pc.stop(t0);
+// 或在函数内部（定义 PERF_COUNTERS_ENABLE 时生效，否则展开为空）：
+//   PERF_SCOPE("gemm_blocked");
+//   ...
+//   perf_scope_report();                          // 打印各作用域累计值
+
+enum PerfEvent {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_FP_SCALAR,
+    PERF_FP_128,
+    PERF_FP_256,
+    PERF_FP_512,
+    PERF_PAGE_FAULTS,
+    PERF_NUM_EVENTS
+};
+
+inline const char* perf_event_name(int e) {
+    static const char* names[PERF_NUM_EVENTS] = {"cycles",    "instructions", "l1d_misses", "llc_misses",
+                                                 "dtlb_misses", "fp_scalar",  "fp_128",     "fp_256",
+                                                 "fp_512",    "page_faults"};
+    return e >= 0 && e < PERF_NUM_EVENTS ? names[e] : "unknown";
+}
+
+// 一次测量的结果；未打开的事件 valid[e] 为 false
+struct PerfSample {
+    double value[PERF_NUM_EVENTS] = {0};
+    bool valid[PERF_NUM_EVENTS] = {false};
+
+    bool any() const {
+        for (bool v : valid)
+            if (v) return true;
+        return false;
+    }
+
+    double ipc() const {
+        return valid[PERF_CYCLES] && valid[PERF_INSTRUCTIONS] && value[PERF_CYCLES] > 0
+                   ? value[PERF_INSTRUCTIONS] / value[PERF_CYCLES]
+                   : 0.0;
+    }
+
+    // 单精度浮点运算数（FMA 计 2），FP_ARITH 不可用时返回 0
+    double flops() const {
+        if (!valid[PERF_FP_SCALAR]) return 0.0;
+        return value[PERF_FP_SCALAR] + 4 * value[PERF_FP_128] + 8 * value[PERF_FP_256] + 16 * value[PERF_FP_512];
+    }
+
+    PerfSample& operator+=(const PerfSample& o) {
+        for (int e = 0; e < PERF_NUM_EVENTS; ++e) {
+            value[e] += o.value[e];
+            valid[e] = valid[e] || o.valid[e];
+        }
+        return *this;
+    }
+
+    void print(std::ostream& os = std::cout) const {
+        for (int e = 0; e < PERF_NUM_EVENTS; ++e)
+            if (valid[e]) os << "  " << std::setw(13) << std::left << perf_event_name(e) << value[e] << "\n";
+        if (valid[PERF_CYCLES] && valid[PERF_INSTRUCTIONS]) os << "  " << std::setw(13) << "IPC" << ipc() << "\n";
+        if (valid[PERF_FP_SCALAR]) os << "  " << std::setw(13) << "flops" << flops() << "\n";
+        if (!any()) os << "  (perf counters unavailable)\n";
+        os << std::right;
+    }
+};
+
+// 计数器的原始读数：value, time_enabled, time_running
+struct PerfSnapshot {
+    uint64_t raw[PERF_NUM_EVENTS][3] = {};
+    bool valid[PERF_NUM_EVENTS] = {false};
+};
+
+class PerfCounters {
+public:
+    // 当前线程的计数器：perf 事件绑定到打开它的线程
+    static PerfCounters& get() {
+        static thread_local PerfCounters pc;
+        return pc;
+    }
+
+    PerfCounters() {
+        for (int& fd : fd_) fd = -1;
+#if defined(__linux__)
+        open(PERF_CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open(PERF_INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open(PERF_L1D_MISSES, PERF_TYPE_HW_CACHE, cache_config(PERF_COUNT_HW_CACHE_L1D));
+        open(PERF_LLC_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        open(PERF_DTLB_MISSES, PERF_TYPE_HW_CACHE, cache_config(PERF_COUNT_HW_CACHE_DTLB));
+        if (is_intel()) {
+            // FP_ARITH_INST_RETIRED.{SCALAR,128B_PACKED,256B_PACKED,512B_PACKED}_SINGLE
+            open(PERF_FP_SCALAR, PERF_TYPE_RAW, 0xC7 | (0x02 << 8));
+            open(PERF_FP_128, PERF_TYPE_RAW, 0xC7 | (0x08 << 8));
+            open(PERF_FP_256, PERF_TYPE_RAW, 0xC7 | (0x20 << 8));
+            open(PERF_FP_512, PERF_TYPE_RAW, 0xC7 | (0x80 << 8));
+        }
+        open(PERF_PAGE_FAULTS, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+#endif
+    }
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (int fd : fd_)
+            if (fd >= 0) close(fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const {
+        for (int fd : fd_)
+            if (fd >= 0) return true;
+        return false;
+    }
+
+    bool has(PerfEvent e) const { return fd_[e] >= 0; }
+
+    // 读出所有计数器的当前值
+    PerfSnapshot snapshot() const {
+        PerfSnapshot snap;
+#if defined(__linux__)
+        for (int e = 0; e < PERF_NUM_EVENTS; ++e) {
+            if (fd_[e] < 0) continue;
+            snap.valid[e] = read(fd_[e], snap.raw[e], sizeof(snap.raw[e])) == static_cast<ssize_t>(sizeof(snap.raw[e]));
+        }
+#endif
+        return snap;
+    }
+
+    // 开始一次测量：只取快照，不影响其他正在进行的测量
+    PerfSnapshot start() const { return snapshot(); }
+
+    // 结束测量：与 begin 的差值，按这段时间内的复用比例放大
+    PerfSample stop(const PerfSnapshot& begin) const {
+        PerfSnapshot end = snapshot();
+        PerfSample s;
+        for (int e = 0; e < PERF_NUM_EVENTS; ++e) {
+            if (!begin.valid[e] || !end.valid[e]) continue;
+            const double value = static_cast<double>(end.raw[e][0] - begin.raw[e][0]);
+            const double enabled = static_cast<double>(end.raw[e][1] - begin.raw[e][1]);
+            const double running = static_cast<double>(end.raw[e][2] - begin.raw[e][2]);
+            s.valid[e] = true;
+            s.value[e] = running > 0 && running < enabled ? value * enabled / running : value;
+        }
+        return s;
+    }
+
+private:
+#if defined(__linux__)
+    static uint64_t cache_config(uint64_t cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+
+    void open(PerfEvent e, uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 0;  // 打开即开始计数，之后只读不停
+        attr.exclude_kernel = 1;  // perf_event_paranoid = 2 时只允许统计用户态
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        if (type == PERF_TYPE_SOFTWARE) attr.exclude_kernel = 0;  // 缺页在内核中处理
+        fd_[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd_[e] < 0 && type == PERF_TYPE_SOFTWARE) {
+            attr.exclude_kernel = 1;
+            fd_[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+    }
+#endif
+
+    static bool is_intel() {
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned a, b, c, d;
+        if (!__get_cpuid(0, &a, &b, &c, &d)) return false;
+        return b == 0x756e6547 && d == 0x49656e69 && c == 0x6c65746e;  // "GenuineIntel"
+#else
+        return false;
+#endif
+    }
+
+    int fd_[PERF_NUM_EVENTS];
+};
+
+// 按名字累计的作用域统计（所有线程共享，加锁合并）
+class PerfScopeRegistry {
+public:
+    static PerfScopeRegistry& get() {
+        static PerfScopeRegistry r;
+        return r;
+    }
+
+    void add(const std::string& name, const PerfSample& s) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& e = entries_[name];
+        e.sample += s;
+        ++e.calls;
+    }
+
+    void report(std::ostream& os = std::cout) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& kv : entries_) {
+            os << "[perf] " << kv.first << " (" << kv.second.calls << " calls)\n";
+            kv.second.sample.print(os);
+        }
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+    }
+
+private:
+    struct Entry {
+        PerfSample sample;
+        long calls = 0;
+    };
+    std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+};
+
+// RAII 作用域：构造时取快照，析构时把差值累计到 name 下；传入 out 时同时写出本次结果。
+// 作用域可以嵌套，外层的计数包含内层
+class PerfScope {
+public:
+    explicit PerfScope(const char* name, PerfSample* out = nullptr)
+        : name_(name), out_(out), begin_(PerfCounters::get().start()) {}
+
+    ~PerfScope() {
+        PerfSample s = PerfCounters::get().stop(begin_);
+        if (out_) *out_ = s;
+        if (name_) PerfScopeRegistry::get().add(name_, s);
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    const char* name_;
+    PerfSample* out_;
+    PerfSnapshot begin_;
+};
+
+inline void perf_scope_report(std::ostream& os = std::cout) { PerfScopeRegistry::get().report(os); }
+
+// 内核内部的插桩点：默认编译为空，定义 PERF_COUNTERS_ENABLE 后才打开计数器
+#define PERF_SCOPE_CONCAT_(a, b) a##b
+#define PERF_SCOPE_CONCAT(a, b) PERF_SCOPE_CONCAT_(a, b)
+#ifdef PERF_COUNTERS_ENABLE
+#define PERF_SCOPE(name) PerfScope PERF_SCOPE_CONCAT(perf_scope_, __LINE__)(name)
+#else
+#define PERF_SCOPE(name) ((void)0)
+#endif
+
+#endif // PERF_COUNTERS_H
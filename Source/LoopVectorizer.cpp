@@ -1,12 +1,143 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
+#include "../tilesize/TitleSizeCalculator.h"
+
+/*
+编译：
+g++ -O2 -std=c++17 LoopVectorizer.cpp -o loop_vectorizer
+执行：./loop_vectorizer [M N K] [生成的源文件]
+
+一个很小的循环 IR 和变换流水线：
+  - 下标是仿射表达式（变量系数 + 常数），split / unroll 时做代入，向量化时直接读出步长
+  - 语句：ForNode（常数范围）、VectorizedStmt（向量化后的循环）、IfNode（split 不整除时的边界守卫）、
+          BlockStmt、StoreStmt（buf[idx] = / += 值表达式）
+  - 变换：Split、Reorder、Tile、Unroll、Simplify，以及 LoopVectorizer
+  - Interpreter 直接执行 IR，用来验证变换前后语义一致
+  - CodeEmitter 生成 C++ 源码，向量化循环按宽度生成 SSE / AVX2 / AVX-512 intrinsics
+main 把 TileSizeCalculator 给出的三级分块（与 tilesize/GemmBlocked.h 的循环结构相同）表示成 IR 变换，
+形状整除时生成的内核没有任何 std::min 边界，不整除时只在叶子语句上留下守卫。
+*/
+
+// ===================== 仿射下标 =====================
+
+using Env = std::map<std::string, int64_t>;
+
+struct Affine {
+    std::map<std::string, int64_t> coeff;
+    int64_t constant = 0;
+
+    static Affine Var(const std::string& name, int64_t c = 1) {
+        Affine a;
+        a.coeff[name] = c;
+        return a;
+    }
+    static Affine Const(int64_t c) {
+        Affine a;
+        a.constant = c;
+        return a;
+    }
+
+    Affine operator+(const Affine& o) const {
+        Affine r = *this;
+        for (const auto& kv : o.coeff) r.coeff[kv.first] += kv.second;
+        r.constant += o.constant;
+        r.Normalize();
+        return r;
+    }
+    Affine operator*(int64_t s) const {
+        Affine r;
+        for (const auto& kv : coeff) r.coeff[kv.first] = kv.second * s;
+        r.constant = constant * s;
+        r.Normalize();
+        return r;
+    }
+
+    int64_t CoeffOf(const std::string& v) const {
+        auto it = coeff.find(v);
+        return it == coeff.end() ? 0 : it->second;
+    }
+
+    // v := e
+    Affine Substitute(const std::string& v, const Affine& e) const {
+        int64_t c = CoeffOf(v);
+        if (c == 0) return *this;
+        Affine r = *this;
+        r.coeff.erase(v);
+        return r + e * c;
+    }
+
+    int64_t Eval(const Env& env) const {
+        int64_t r = constant;
+        for (const auto& kv : coeff) r += kv.second * env.at(kv.first);
+        return r;
+    }
+
+    std::string Str() const {
+        std::ostringstream ss;
+        bool first = true;
+        for (const auto& kv : coeff) {
+            if (!first) ss << " + ";
+            if (kv.second != 1) ss << kv.second << "*";
+            ss << kv.first;
+            first = false;
+        }
+        if (constant != 0 || first) ss << (first ? "" : " + ") << constant;
+        return ss.str();
+    }
+
+private:
+    void Normalize() {
+        for (auto it = coeff.begin(); it != coeff.end();) it = it->second == 0 ? coeff.erase(it) : std::next(it);
+    }
+};
+
+// 守卫条件 expr < limit
+struct Bound {
+    Affine expr;
+    int64_t limit;
+};
+
+// ===================== 值表达式 =====================
+
+class ValueExpr {
+public:
+    virtual ~ValueExpr() = default;
+};
+using ValuePtr = std::shared_ptr<ValueExpr>;
+
+class LoadExpr : public ValueExpr {
+public:
+    std::string buffer;
+    Affine index;
+    LoadExpr(std::string buf, Affine idx) : buffer(std::move(buf)), index(std::move(idx)) {}
+};
+
+class BinaryExpr : public ValueExpr {
+public:
+    char op;  // '+' 或 '*'
+    ValuePtr a, b;
+    BinaryExpr(char o, ValuePtr x, ValuePtr y) : op(o), a(std::move(x)), b(std::move(y)) {}
+};
+
+// ===================== 语句 =====================
 
 class Stmt {
     public:
         virtual ~Stmt() = default;
 };
+using StmtPtr = std::shared_ptr<Stmt>;
 
 class ForNode : public Stmt {
     public:
@@ -19,19 +150,259 @@ class ForNode : public Stmt {
 
 };
 
-
+// 向量化后的循环：extent 即向量宽度，body 中每条语句按 extent 个通道同时执行
 class VectorizedStmt : public Stmt {
 
 public:
      std::string loop_var;
      int extent;
+     std::shared_ptr<Stmt> body;
 
-     VectorizedStmt(std::string var, int ext)
-            : loop_var(var), extent(ext) {}
+     VectorizedStmt(std::string var, int ext, std::shared_ptr<Stmt> b = nullptr)
+            : loop_var(var), extent(ext), body(b) {}
+
+
+};
+
+class BlockStmt : public Stmt {
+public:
+    std::vector<StmtPtr> stmts;
+    explicit BlockStmt(std::vector<StmtPtr> s = {}) : stmts(std::move(s)) {}
+};
 
+class IfNode : public Stmt {
+public:
+    std::vector<Bound> conds;  // 全部满足才执行
+    StmtPtr body;
+    IfNode(std::vector<Bound> c, StmtPtr b) : conds(std::move(c)), body(std::move(b)) {}
+};
 
+class StoreStmt : public Stmt {
+public:
+    std::string buffer;
+    Affine index;
+    ValuePtr value;
+    bool accumulate;  // true: buffer[index] += value
+    StoreStmt(std::string buf, Affine idx, ValuePtr v, bool acc)
+        : buffer(std::move(buf)), index(std::move(idx)), value(std::move(v)), accumulate(acc) {}
 };
 
+template <typename T>
+static std::shared_ptr<T> As(const StmtPtr& s) {
+    return std::dynamic_pointer_cast<T>(s);
+}
+
+// ===================== 通用遍历 =====================
+
+static ValuePtr SubstituteValue(const ValuePtr& v, const std::string& var, const Affine& e) {
+    if (auto ld = std::dynamic_pointer_cast<LoadExpr>(v)) return std::make_shared<LoadExpr>(ld->buffer, ld->index.Substitute(var, e));
+    if (auto bin = std::dynamic_pointer_cast<BinaryExpr>(v))
+        return std::make_shared<BinaryExpr>(bin->op, SubstituteValue(bin->a, var, e), SubstituteValue(bin->b, var, e));
+    return v;
+}
+
+// 把语句中的循环变量 var 替换成仿射表达式 e
+static StmtPtr Substitute(const StmtPtr& s, const std::string& var, const Affine& e) {
+    if (auto f = As<ForNode>(s)) return std::make_shared<ForNode>(f->loop_var, f->extent, Substitute(f->body, var, e));
+    if (auto v = As<VectorizedStmt>(s))
+        return std::make_shared<VectorizedStmt>(v->loop_var, v->extent, Substitute(v->body, var, e));
+    if (auto b = As<BlockStmt>(s)) {
+        std::vector<StmtPtr> out;
+        for (const auto& c : b->stmts) out.push_back(Substitute(c, var, e));
+        return std::make_shared<BlockStmt>(out);
+    }
+    if (auto g = As<IfNode>(s)) {
+        std::vector<Bound> conds;
+        for (const auto& c : g->conds) conds.push_back({c.expr.Substitute(var, e), c.limit});
+        return std::make_shared<IfNode>(conds, Substitute(g->body, var, e));
+    }
+    if (auto st = As<StoreStmt>(s))
+        return std::make_shared<StoreStmt>(st->buffer, st->index.Substitute(var, e), SubstituteValue(st->value, var, e),
+                                           st->accumulate);
+    return s;
+}
+
+// 给所有叶子语句加上守卫：守卫放在最内层，循环嵌套保持完美嵌套，Reorder 仍然可用
+static StmtPtr GuardLeaves(const StmtPtr& s, const Bound& bound) {
+    if (auto f = As<ForNode>(s)) return std::make_shared<ForNode>(f->loop_var, f->extent, GuardLeaves(f->body, bound));
+    if (auto v = As<VectorizedStmt>(s))
+        return std::make_shared<VectorizedStmt>(v->loop_var, v->extent, GuardLeaves(v->body, bound));
+    if (auto b = As<BlockStmt>(s)) {
+        std::vector<StmtPtr> out;
+        for (const auto& c : b->stmts) out.push_back(GuardLeaves(c, bound));
+        return std::make_shared<BlockStmt>(out);
+    }
+    if (auto g = As<IfNode>(s)) {
+        std::vector<Bound> conds = g->conds;
+        conds.push_back(bound);
+        return std::make_shared<IfNode>(conds, g->body);
+    }
+    return std::make_shared<IfNode>(std::vector<Bound>{bound}, s);
+}
+
+// 找到名为 var 的循环并用 fn 的结果替换；找不到时抛异常
+template <typename Fn>
+static StmtPtr ReplaceLoop(const StmtPtr& s, const std::string& var, Fn fn, bool& found) {
+    if (auto f = As<ForNode>(s)) {
+        if (f->loop_var == var) {
+            found = true;
+            return fn(f);
+        }
+        return std::make_shared<ForNode>(f->loop_var, f->extent, ReplaceLoop(f->body, var, fn, found));
+    }
+    if (auto v = As<VectorizedStmt>(s))
+        return std::make_shared<VectorizedStmt>(v->loop_var, v->extent, ReplaceLoop(v->body, var, fn, found));
+    if (auto b = As<BlockStmt>(s)) {
+        std::vector<StmtPtr> out;
+        for (const auto& c : b->stmts) out.push_back(ReplaceLoop(c, var, fn, found));
+        return std::make_shared<BlockStmt>(out);
+    }
+    if (auto g = As<IfNode>(s)) return std::make_shared<IfNode>(g->conds, ReplaceLoop(g->body, var, fn, found));
+    return s;
+}
+
+template <typename Fn>
+static StmtPtr ReplaceLoop(const StmtPtr& s, const std::string& var, Fn fn) {
+    bool found = false;
+    StmtPtr r = ReplaceLoop(s, var, fn, found);
+    if (!found) throw std::invalid_argument("loop '" + var + "' not found");
+    return r;
+}
+
+// 是否存在名为 var 的循环（化简可能已经去掉了长度为 1 的循环）
+static bool HasLoop(const StmtPtr& s, const std::string& var) {
+    bool found = false;
+    ReplaceLoop(s, var, [](const std::shared_ptr<ForNode>& f) -> StmtPtr { return f; }, found);
+    return found;
+}
+
+// ===================== 变换 =====================
+
+// 区间分析：在已知循环范围下，判断守卫是否恒真 / 恒假
+static bool RangeOf(const Affine& e, const std::map<std::string, int>& ranges, int64_t& lo, int64_t& hi) {
+    lo = hi = e.constant;
+    for (const auto& kv : e.coeff) {
+        auto it = ranges.find(kv.first);
+        if (it == ranges.end()) return false;
+        int64_t span = kv.second * (it->second - 1);
+        (span < 0 ? lo : hi) += span;
+    }
+    return true;
+}
+
+// 化简：长度为 1 的循环代入 0 后去掉，长度为 0 的循环删除，恒真的守卫条件删除，恒假的守卫连同语句删除，
+// 嵌套的 BlockStmt 展平
+static StmtPtr Simplify(const StmtPtr& s, std::map<std::string, int> ranges = {}) {
+    if (auto f = As<ForNode>(s)) {
+        if (f->extent <= 0) return std::make_shared<BlockStmt>();
+        if (f->extent == 1) return Simplify(Substitute(f->body, f->loop_var, Affine::Const(0)), ranges);
+        ranges[f->loop_var] = f->extent;
+        StmtPtr body = Simplify(f->body, ranges);
+        if (auto b = As<BlockStmt>(body))
+            if (b->stmts.empty()) return body;
+        return std::make_shared<ForNode>(f->loop_var, f->extent, body);
+    }
+    if (auto v = As<VectorizedStmt>(s)) {
+        ranges[v->loop_var] = v->extent;
+        return std::make_shared<VectorizedStmt>(v->loop_var, v->extent, Simplify(v->body, ranges));
+    }
+    if (auto b = As<BlockStmt>(s)) {
+        std::vector<StmtPtr> out;
+        for (const auto& c : b->stmts) {
+            StmtPtr r = Simplify(c, ranges);
+            if (auto rb = As<BlockStmt>(r))
+                out.insert(out.end(), rb->stmts.begin(), rb->stmts.end());
+            else
+                out.push_back(r);
+        }
+        if (out.size() == 1) return out[0];
+        return std::make_shared<BlockStmt>(out);
+    }
+    if (auto g = As<IfNode>(s)) {
+        std::vector<Bound> conds;
+        for (const auto& c : g->conds) {
+            int64_t lo, hi;
+            bool known = RangeOf(c.expr, ranges, lo, hi);
+            if (known && hi < c.limit) continue;
+            if (known && lo >= c.limit) return std::make_shared<BlockStmt>();
+            conds.push_back(c);
+        }
+        StmtPtr body = Simplify(g->body, ranges);
+        return conds.empty() ? body : std::make_shared<IfNode>(conds, body);
+    }
+    return s;
+}
+
+// var -> (outer, inner)，var = outer * factor + inner；不整除时给叶子语句加守卫 var < extent
+static StmtPtr Split(const StmtPtr& s, const std::string& var, int factor, const std::string& outer,
+                     const std::string& inner) {
+    if (factor <= 0) throw std::invalid_argument("Split: factor must be positive");
+    return ReplaceLoop(s, var, [&](const std::shared_ptr<ForNode>& f) -> StmtPtr {
+        const int f_eff = std::min(factor, f->extent);
+        const int outer_extent = (f->extent + f_eff - 1) / f_eff;
+        Affine e = Affine::Var(outer, f_eff) + Affine::Var(inner);
+        StmtPtr body = Substitute(f->body, var, e);
+        if (f->extent % f_eff != 0) body = GuardLeaves(body, {e, f->extent});
+        return std::make_shared<ForNode>(outer, outer_extent, std::make_shared<ForNode>(inner, f_eff, body));
+    });
+}
+
+// 重排完美嵌套中的若干循环：order 中的循环按给定顺序占据它们原来所在的那些层，其它层不动。
+// 循环范围都是常数，交换顺序不改变迭代空间；是否满足依赖由调用方保证（GEMM 的归约只改变求和顺序）
+static StmtPtr Reorder(const StmtPtr& s, const std::vector<std::string>& order) {
+    std::set<std::string> wanted(order.begin(), order.end());
+    if (auto f = As<ForNode>(s)) {
+        if (!wanted.count(f->loop_var))
+            return std::make_shared<ForNode>(f->loop_var, f->extent, Reorder(f->body, order));
+        // 从这里往下收集完美嵌套的循环链
+        std::vector<std::shared_ptr<ForNode>> chain;
+        StmtPtr cur = s;
+        size_t hit = 0;
+        while (auto cf = As<ForNode>(cur)) {
+            chain.push_back(cf);
+            hit += wanted.count(cf->loop_var);
+            if (hit == wanted.size()) break;
+            cur = cf->body;
+        }
+        if (hit != wanted.size()) throw std::invalid_argument("Reorder: loops are not perfectly nested");
+        std::map<std::string, std::shared_ptr<ForNode>> by_name;
+        for (const auto& c : chain) by_name[c->loop_var] = c;
+        std::vector<std::shared_ptr<ForNode>> headers;
+        size_t next = 0;
+        for (const auto& c : chain) headers.push_back(wanted.count(c->loop_var) ? by_name[order[next++]] : c);
+        StmtPtr body = chain.back()->body;
+        for (size_t i = headers.size(); i-- > 0;) body = std::make_shared<ForNode>(headers[i]->loop_var, headers[i]->extent, body);
+        return body;
+    }
+    if (auto b = As<BlockStmt>(s)) {
+        std::vector<StmtPtr> out;
+        for (const auto& c : b->stmts) out.push_back(Reorder(c, order));
+        return std::make_shared<BlockStmt>(out);
+    }
+    return s;
+}
+
+// 二维分块 = 两次 Split + Reorder
+static StmtPtr Tile(const StmtPtr& s, const std::string& x, const std::string& y, int fx, int fy) {
+    StmtPtr r = Split(s, x, fx, x + "o", x + "i");
+    r = Split(r, y, fy, y + "o", y + "i");
+    return Reorder(r, {x + "o", y + "o", x + "i", y + "i"});
+}
+
+// 完全展开：循环体按每个取值复制一份，再化简掉可静态判定的守卫
+static StmtPtr Unroll(const StmtPtr& s, const std::string& var) {
+    return Simplify(ReplaceLoop(s, var, [&](const std::shared_ptr<ForNode>& f) -> StmtPtr {
+        std::vector<StmtPtr> copies;
+        for (int k = 0; k < f->extent; ++k) copies.push_back(Substitute(f->body, var, Affine::Const(k)));
+        return std::make_shared<BlockStmt>(copies);
+    }));
+}
+
+// ===================== 向量化 =====================
+
+// 把指定循环变成 VectorizedStmt。attributes 为目标指令集（"sse" / "avx2" / "avx512"），决定允许的最大宽度。
+// 合法条件：循环体只含（可带守卫的）赋值语句，守卫与向量变量无关，写入下标对向量变量步长为 1，
+// 读取下标步长为 0（广播）或 1（连续加载），且同一缓冲区的读写之间没有跨通道依赖；不满足时打印原因并保持原循环
 class LoopVectorizer {
 
 public:
@@ -46,33 +417,500 @@ public:
 
     }
 
+    std::shared_ptr<Stmt> operator() (std::shared_ptr<Stmt> stmt, const std::string& var) {
+        return ReplaceLoop(stmt, var, [&](const std::shared_ptr<ForNode>& f) { return Vectorize(f); });
+    }
+
 
 private:
     std::string attributes;
+
+    int MaxLanes() const {
+        if (attributes == "avx512") return 16;
+        if (attributes == "avx2") return 8;
+        return 4;
+    }
+
+    static bool CheckValue(const ValuePtr& v, const std::string& var, std::string& why) {
+        if (auto ld = std::dynamic_pointer_cast<LoadExpr>(v)) {
+            int64_t c = ld->index.CoeffOf(var);
+            if (c != 0 && c != 1) {
+                why = "load " + ld->buffer + " has stride " + std::to_string(c);
+                return false;
+            }
+            return true;
+        }
+        if (auto bin = std::dynamic_pointer_cast<BinaryExpr>(v)) return CheckValue(bin->a, var, why) && CheckValue(bin->b, var, why);
+        return true;
+    }
+
+    static bool CheckBody(const StmtPtr& s, const std::string& var, std::string& why) {
+        if (auto b = As<BlockStmt>(s)) {
+            for (const auto& c : b->stmts)
+                if (!CheckBody(c, var, why)) return false;
+            return true;
+        }
+        if (auto g = As<IfNode>(s)) {
+            for (const auto& c : g->conds)
+                if (c.expr.CoeffOf(var) != 0) {
+                    why = "guard depends on the vector lane";
+                    return false;
+                }
+            return CheckBody(g->body, var, why);
+        }
+        if (auto st = As<StoreStmt>(s)) {
+            if (st->index.CoeffOf(var) != 1) {
+                why = "store " + st->buffer + " is not contiguous";
+                return false;
+            }
+            return CheckValue(st->value, var, why);
+        }
+        why = "body contains a nested loop";
+        return false;
+    }
+
+    struct Access {
+        std::string buffer;
+        Affine index;
+        bool write;
+    };
+
+    static void CollectAccesses(const ValuePtr& v, std::vector<Access>& out) {
+        if (auto ld = std::dynamic_pointer_cast<LoadExpr>(v)) out.push_back({ld->buffer, ld->index, false});
+        if (auto bin = std::dynamic_pointer_cast<BinaryExpr>(v)) {
+            CollectAccesses(bin->a, out);
+            CollectAccesses(bin->b, out);
+        }
+    }
+
+    static void CollectAccesses(const StmtPtr& s, std::vector<Access>& out) {
+        if (auto b = As<BlockStmt>(s))
+            for (const auto& c : b->stmts) CollectAccesses(c, out);
+        if (auto g = As<IfNode>(s)) CollectAccesses(g->body, out);
+        if (auto st = As<StoreStmt>(s)) {
+            CollectAccesses(st->value, out);
+            out.push_back({st->buffer, st->index, true});
+        }
+    }
+
+    // 向量化后每条语句先算完全部通道再执行下一条，与逐通道执行的顺序不同。
+    // 同一缓冲区的写与读 / 写，下标完全相同时每个通道只碰自己的元素，仍然等价；
+    // 否则只有两者差一个常数、且各自覆盖的通道区间不相交时才安全（如展开后 C 的不同行），
+    // 其余情况（a[i + 1] = a[i] + ...、偏移依赖外层变量）视为跨通道依赖
+    static bool CheckDependences(const StmtPtr& body, const std::string& var, int lanes, std::string& why) {
+        std::vector<Access> acc;
+        CollectAccesses(body, acc);
+        for (size_t p = 0; p < acc.size(); ++p) {
+            if (!acc[p].write) continue;
+            for (size_t q = 0; q < acc.size(); ++q) {
+                const Access& w = acc[p];
+                const Access& o = acc[q];
+                if (q == p || o.buffer != w.buffer) continue;
+                Affine diff = o.index + w.index * -1;
+                if (diff.coeff.empty() && diff.constant == 0) continue;
+                diff = diff.Substitute(var, Affine::Const(0));
+                bool disjoint = false;
+                if (diff.coeff.empty()) {
+                    int64_t ow = o.index.CoeffOf(var) * (lanes - 1), ww = w.index.CoeffOf(var) * (lanes - 1);
+                    int64_t o_lo = diff.constant + std::min<int64_t>(0, ow), o_hi = diff.constant + std::max<int64_t>(0, ow);
+                    disjoint = o_hi < std::min<int64_t>(0, ww) || o_lo > std::max<int64_t>(0, ww);
+                }
+                if (!disjoint) {
+                    why = std::string(o.write ? "store " : "load ") + o.buffer + "[" + o.index.Str() + "] depends on store " +
+                          w.buffer + "[" + w.index.Str() + "] across lanes";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // 守卫 rest + var < limit：rest 的各项系数与常数、limit 都是宽度的倍数时，一组通道要么全部满足、要么全不满足，
+    // 等价于 rest < limit，与通道无关（split 的整块部分正是这种情况）
+    static StmtPtr HoistLaneGuards(const StmtPtr& s, const std::string& var, int lanes) {
+        if (auto b = As<BlockStmt>(s)) {
+            std::vector<StmtPtr> out;
+            for (const auto& c : b->stmts) out.push_back(HoistLaneGuards(c, var, lanes));
+            return std::make_shared<BlockStmt>(out);
+        }
+        if (auto g = As<IfNode>(s)) {
+            std::vector<Bound> conds;
+            for (Bound c : g->conds) {
+                bool aligned = c.expr.CoeffOf(var) == 1 && c.limit % lanes == 0 && c.expr.constant % lanes == 0;
+                for (const auto& kv : c.expr.coeff)
+                    if (kv.first != var && kv.second % lanes != 0) aligned = false;
+                if (aligned) c.expr = c.expr.Substitute(var, Affine::Const(0));
+                conds.push_back(c);
+            }
+            return std::make_shared<IfNode>(conds, HoistLaneGuards(g->body, var, lanes));
+        }
+        return s;
+    }
+
     std::shared_ptr<Stmt> Vectorize(std::shared_ptr<ForNode> for_node) {
-        std::cout << "Vectorizing loop with variable: " << for_node->loop_var 
+        for_node = std::make_shared<ForNode>(for_node->loop_var, for_node->extent,
+                                             HoistLaneGuards(for_node->body, for_node->loop_var, for_node->extent));
+        std::string why;
+        if (for_node->extent != 4 && for_node->extent != 8 && for_node->extent != 16)
+            why = "extent must be 4, 8 or 16";
+        else if (for_node->extent > MaxLanes())
+            why = "extent exceeds " + attributes + " vector width";
+        else if (CheckBody(for_node->body, for_node->loop_var, why))
+            CheckDependences(for_node->body, for_node->loop_var, for_node->extent, why);
+        if (!why.empty()) {
+            std::cout << "Cannot vectorize loop " << for_node->loop_var << ": " << why << std::endl;
+            return for_node;
+        }
+        std::cout << "Vectorizing loop with variable: " << for_node->loop_var
                   << " and extent: " << for_node->extent << " using attributes: " << attributes << std::endl;
-        return std::make_shared<VectorizedStmt>(for_node->loop_var, for_node->extent);
+        return std::make_shared<VectorizedStmt>(for_node->loop_var, for_node->extent, for_node->body);
     }
 };
 
+// ===================== 打印 =====================
 
-int main() {
-    auto loop_body = std::make_shared<Stmt>();
-    auto for_node = std::make_shared<ForNode>("i",4,loop_body);
+static std::string ValueStr(const ValuePtr& v) {
+    if (auto ld = std::dynamic_pointer_cast<LoadExpr>(v)) return ld->buffer + "[" + ld->index.Str() + "]";
+    if (auto bin = std::dynamic_pointer_cast<BinaryExpr>(v))
+        return "(" + ValueStr(bin->a) + " " + bin->op + " " + ValueStr(bin->b) + ")";
+    return "?";
+}
+
+static std::string CondStr(const std::vector<Bound>& conds) {
+    std::string r;
+    for (size_t i = 0; i < conds.size(); ++i)
+        r += (i ? " && " : "") + conds[i].expr.Str() + " < " + std::to_string(conds[i].limit);
+    return r;
+}
+
+static void Print(const StmtPtr& s, std::ostream& os, int indent = 0) {
+    std::string pad(indent * 2, ' ');
+    if (auto f = As<ForNode>(s)) {
+        os << pad << "for " << f->loop_var << " in [0, " << f->extent << ")\n";
+        Print(f->body, os, indent + 1);
+    } else if (auto v = As<VectorizedStmt>(s)) {
+        os << pad << "vectorized " << v->loop_var << " in [0, " << v->extent << ")\n";
+        Print(v->body, os, indent + 1);
+    } else if (auto b = As<BlockStmt>(s)) {
+        for (const auto& c : b->stmts) Print(c, os, indent);
+    } else if (auto g = As<IfNode>(s)) {
+        os << pad << "if " << CondStr(g->conds) << "\n";
+        Print(g->body, os, indent + 1);
+    } else if (auto st = As<StoreStmt>(s)) {
+        os << pad << st->buffer << "[" << st->index.Str() << "] " << (st->accumulate ? "+=" : "=") << " "
+           << ValueStr(st->value) << "\n";
+    }
+}
+
+// ===================== 解释器 =====================
 
-    // 创建 LoopVectorizer 实例并向量化
-    // LoopVectorizer vectorizer("example_attr");
-    // auto vectorized_stmt = vectorizer(std::move(for_node));  // 模仿调用方式
+class Interpreter {
+public:
+    explicit Interpreter(std::map<std::string, float*> buffers) : buffers_(std::move(buffers)) {}
 
+    void Run(const StmtPtr& s) {
+        Env env;
+        Exec(s, env);
+    }
+
+private:
+    float Eval(const ValuePtr& v, const Env& env) {
+        if (auto ld = std::dynamic_pointer_cast<LoadExpr>(v)) return buffers_.at(ld->buffer)[ld->index.Eval(env)];
+        if (auto bin = std::dynamic_pointer_cast<BinaryExpr>(v)) {
+            float a = Eval(bin->a, env), b = Eval(bin->b, env);
+            return bin->op == '*' ? a * b : a + b;
+        }
+        throw std::invalid_argument("Interpreter: unknown expression");
+    }
+
+    void Exec(const StmtPtr& s, Env& env) {
+        if (auto f = As<ForNode>(s)) {
+            for (int i = 0; i < f->extent; ++i) {
+                env[f->loop_var] = i;
+                Exec(f->body, env);
+            }
+        } else if (auto v = As<VectorizedStmt>(s)) {
+            // 各通道相互独立（向量化的合法条件），逐通道执行即可
+            for (int i = 0; i < v->extent; ++i) {
+                env[v->loop_var] = i;
+                Exec(v->body, env);
+            }
+        } else if (auto b = As<BlockStmt>(s)) {
+            for (const auto& c : b->stmts) Exec(c, env);
+        } else if (auto g = As<IfNode>(s)) {
+            for (const auto& c : g->conds)
+                if (c.expr.Eval(env) >= c.limit) return;
+            Exec(g->body, env);
+        } else if (auto st = As<StoreStmt>(s)) {
+            float val = Eval(st->value, env);
+            float& dst = buffers_.at(st->buffer)[st->index.Eval(env)];
+            dst = st->accumulate ? dst + val : val;
+        }
+    }
+
+    std::map<std::string, float*> buffers_;
+};
+
+// ===================== C++ 代码生成 =====================
+
+class CodeEmitter {
+public:
+    // 生成 void name(const float* A, ..., float* C)：只读的缓冲区加 const，按名字排序
+    std::string Emit(const StmtPtr& s, const std::string& name) {
+        std::set<std::string> read, written;
+        int lanes = 0;
+        Collect(s, read, written, lanes);
+        os_.str("");
+        os_ << "#include <cstdint>\n#include <immintrin.h>\n\n";
+        if (lanes == 16)
+            os_ << "__attribute__((target(\"avx512f\")))\n";
+        else if (lanes == 8)
+            os_ << "__attribute__((target(\"avx2,fma\")))\n";
+        os_ << "void " << name << "(";
+        std::set<std::string> all(read);
+        all.insert(written.begin(), written.end());
+        bool first = true;
+        for (const auto& b : all) {
+            os_ << (first ? "" : ", ") << (written.count(b) ? "float* " : "const float* ") << b;
+            first = false;
+        }
+        os_ << ") {\n";
+        EmitStmt(s, 1);
+        os_ << "}\n";
+        return os_.str();
+    }
+
+private:
+    std::ostringstream os_;
+
+    static void CollectValue(const ValuePtr& v, std::set<std::string>& read) {
+        if (auto ld = std::dynamic_pointer_cast<LoadExpr>(v)) read.insert(ld->buffer);
+        if (auto bin = std::dynamic_pointer_cast<BinaryExpr>(v)) {
+            CollectValue(bin->a, read);
+            CollectValue(bin->b, read);
+        }
+    }
+
+    static void Collect(const StmtPtr& s, std::set<std::string>& read, std::set<std::string>& written, int& lanes) {
+        if (auto f = As<ForNode>(s)) Collect(f->body, read, written, lanes);
+        if (auto v = As<VectorizedStmt>(s)) {
+            lanes = std::max(lanes, v->extent);
+            Collect(v->body, read, written, lanes);
+        }
+        if (auto b = As<BlockStmt>(s))
+            for (const auto& c : b->stmts) Collect(c, read, written, lanes);
+        if (auto g = As<IfNode>(s)) Collect(g->body, read, written, lanes);
+        if (auto st = As<StoreStmt>(s)) {
+            written.insert(st->buffer);
+            CollectValue(st->value, read);
+        }
+    }
+
+    static std::string Index(const Affine& e) {
+        if (e.coeff.empty()) return std::to_string(e.constant);
+        std::string r;
+        for (const auto& kv : e.coeff) {
+            if (!r.empty()) r += " + ";
+            r += kv.second == 1 ? kv.first : std::to_string(kv.second) + " * " + kv.first;
+        }
+        if (e.constant) r += " + " + std::to_string(e.constant);
+        return r;
+    }
+
+    std::string Scalar(const ValuePtr& v) {
+        if (auto ld = std::dynamic_pointer_cast<LoadExpr>(v)) return ld->buffer + "[" + Index(ld->index) + "]";
+        auto bin = std::dynamic_pointer_cast<BinaryExpr>(v);
+        return "(" + Scalar(bin->a) + " " + bin->op + " " + Scalar(bin->b) + ")";
+    }
+
+    // 向量表达式：步长 0 的读取广播，步长 1 的读取从通道 0 的地址连续加载
+    struct Isa {
+        std::string type, prefix;
+        bool fma;
+    };
+    static Isa IsaFor(int lanes) {
+        if (lanes == 16) return {"__m512", "_mm512_", true};
+        if (lanes == 8) return {"__m256", "_mm256_", true};
+        return {"__m128", "_mm_", false};
+    }
+
+    std::string Vector(const ValuePtr& v, const std::string& var, const Isa& isa) {
+        if (auto ld = std::dynamic_pointer_cast<LoadExpr>(v)) {
+            Affine base = ld->index.Substitute(var, Affine::Const(0));
+            if (ld->index.CoeffOf(var) == 0) return isa.prefix + "set1_ps(" + ld->buffer + "[" + Index(base) + "])";
+            return isa.prefix + "loadu_ps(&" + ld->buffer + "[" + Index(base) + "])";
+        }
+        auto bin = std::dynamic_pointer_cast<BinaryExpr>(v);
+        return isa.prefix + (bin->op == '*' ? "mul_ps(" : "add_ps(") + Vector(bin->a, var, isa) + ", " +
+               Vector(bin->b, var, isa) + ")";
+    }
+
+    void EmitVectorBody(const StmtPtr& s, const std::string& var, const Isa& isa, int indent) {
+        std::string pad(indent * 4, ' ');
+        if (auto b = As<BlockStmt>(s)) {
+            for (const auto& c : b->stmts) EmitVectorBody(c, var, isa, indent);
+        } else if (auto g = As<IfNode>(s)) {
+            os_ << pad << "if (" << Cond(g->conds) << ") {\n";
+            EmitVectorBody(g->body, var, isa, indent + 1);
+            os_ << pad << "}\n";
+        } else if (auto st = As<StoreStmt>(s)) {
+            std::string addr = "&" + st->buffer + "[" + Index(st->index.Substitute(var, Affine::Const(0))) + "]";
+            std::string value;
+            auto mul = std::dynamic_pointer_cast<BinaryExpr>(st->value);
+            if (st->accumulate && isa.fma && mul && mul->op == '*')
+                value = isa.prefix + "fmadd_ps(" + Vector(mul->a, var, isa) + ", " + Vector(mul->b, var, isa) + ", " +
+                        isa.prefix + "loadu_ps(" + addr + "))";
+            else if (st->accumulate)
+                value = isa.prefix + "add_ps(" + isa.prefix + "loadu_ps(" + addr + "), " + Vector(st->value, var, isa) + ")";
+            else
+                value = Vector(st->value, var, isa);
+            os_ << pad << isa.prefix << "storeu_ps(" << addr << ", " << value << ");\n";
+        }
+    }
+
+    static std::string Cond(const std::vector<Bound>& conds) {
+        std::string r;
+        for (size_t i = 0; i < conds.size(); ++i)
+            r += (i ? " && " : "") + Index(conds[i].expr) + " < " + std::to_string(conds[i].limit);
+        return r;
+    }
+
+    void EmitStmt(const StmtPtr& s, int indent) {
+        std::string pad(indent * 4, ' ');
+        if (auto f = As<ForNode>(s)) {
+            os_ << pad << "for (int64_t " << f->loop_var << " = 0; " << f->loop_var << " < " << f->extent << "; ++"
+                << f->loop_var << ") {\n";
+            EmitStmt(f->body, indent + 1);
+            os_ << pad << "}\n";
+        } else if (auto v = As<VectorizedStmt>(s)) {
+            os_ << pad << "// vectorized " << v->loop_var << " x" << v->extent << "\n";
+            EmitVectorBody(v->body, v->loop_var, IsaFor(v->extent), indent);
+        } else if (auto b = As<BlockStmt>(s)) {
+            for (const auto& c : b->stmts) EmitStmt(c, indent);
+        } else if (auto g = As<IfNode>(s)) {
+            os_ << pad << "if (" << Cond(g->conds) << ") {\n";
+            EmitStmt(g->body, indent + 1);
+            os_ << pad << "}\n";
+        } else if (auto st = As<StoreStmt>(s)) {
+            os_ << pad << st->buffer << "[" << Index(st->index) << "] " << (st->accumulate ? "+=" : "=") << " "
+                << Scalar(st->value) << ";\n";
+        }
+    }
+};
+
+// ===================== GEMM 示例 =====================
+
+// C[i, j] += A[i, k] * B[k, j]，行优先紧凑存储
+static StmtPtr MakeGemm(int M, int N, int K) {
+    auto a = std::make_shared<LoadExpr>("A", Affine::Var("i", K) + Affine::Var("k"));
+    auto b = std::make_shared<LoadExpr>("B", Affine::Var("k", N) + Affine::Var("j"));
+    auto store = std::make_shared<StoreStmt>("C", Affine::Var("i", N) + Affine::Var("j"),
+                                             std::make_shared<BinaryExpr>('*', a, b), true);
+    return std::make_shared<ForNode>("i", M, std::make_shared<ForNode>("j", N, std::make_shared<ForNode>("k", K, store)));
+}
+
+// 用 IR 变换表达 GemmBlocked.h 的三级分块：
+//   i -> i0 (L3) / im (L2) / it (L1 步进) / ii (寄存器块)，j 同理，k -> k0 / kk
+//   循环顺序 i0 j0 k0 im jm it jt kk ii ji，与 gemm_blocked 的嵌套一致
+// 之后展开 ii、向量化 ji，得到没有 std::min 边界的专用内核
+static StmtPtr ScheduleTileSize(StmtPtr s, const TileSize& ts, const std::string& isa) {
+    const int i_l3 = ts.ti_outer * ts.ti_mid * ts.ti_inner, i_l2 = ts.ti_mid * ts.ti_inner;
+    const int j_l3 = ts.tj_outer * ts.tj_mid * ts.tj_inner, j_l2 = ts.tj_mid * ts.tj_inner;
+    s = Split(s, "i", i_l3, "i0", "i1");
+    s = Split(s, "i1", i_l2, "im", "i2");
+    s = Split(s, "i2", ts.ti_inner, "it", "ii");
+    s = Split(s, "j", j_l3, "j0", "j1");
+    s = Split(s, "j1", j_l2, "jm", "j2");
+    s = Split(s, "j2", ts.tj_inner, "jt", "ji");
+    s = Split(s, "k", ts.tk_mid, "k0", "kk");
+    s = Reorder(s, {"i0", "j0", "k0", "im", "jm", "it", "jt", "kk", "ii", "ji"});
+    s = Simplify(s);
+    // ti_inner / tj_inner == 1 时 ii / ji 已被化简掉
+    if (HasLoop(s, "ii")) s = Unroll(s, "ii");
+    if (HasLoop(s, "ji")) s = LoopVectorizer(isa)(s, "ji");
+    return s;
+}
+
+static void gemm_naive(const float* A, const float* B, float* C, int M, int N, int K) {
+    for (int i = 0; i < M; ++i)
+        for (int j = 0; j < N; ++j)
+            for (int k = 0; k < K; ++k) C[i * N + j] += A[i * K + k] * B[k * N + j];
+}
+
+static bool RunCase(int M, int N, int K, const std::string& out_file) {
+    CacheConfig cache;
+    TileSize ts = TileSizeCalculator(cache).compute(M, N, K);
+    std::cout << "M=" << M << " N=" << N << " K=" << K << "  tiles: i " << ts.ti_outer << "x" << ts.ti_mid << "x"
+              << ts.ti_inner << ", j " << ts.tj_outer << "x" << ts.tj_mid << "x" << ts.tj_inner << ", k " << ts.tk_mid
+              << std::endl;
+
+    StmtPtr gemm = MakeGemm(M, N, K);
+    StmtPtr scheduled = ScheduleTileSize(gemm, ts, "avx2");
+    std::cout << "----- scheduled IR -----\n";
+    Print(scheduled, std::cout);
+
+    std::vector<float> A(M * K), B(K * N), C_ref(M * N, 0.0f), C_ir(M * N, 0.0f);
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (auto& v : A) v = dist(gen);
+    for (auto& v : B) v = dist(gen);
+    gemm_naive(A.data(), B.data(), C_ref.data(), M, N, K);
+    Interpreter({{"A", A.data()}, {"B", B.data()}, {"C", C_ir.data()}}).Run(scheduled);
+    float max_diff = 0;
+    for (int i = 0; i < M * N; ++i) max_diff = std::max(max_diff, std::fabs(C_ref[i] - C_ir[i]));
+    std::cout << "interpreter vs naive: max diff " << max_diff << std::endl;
+
+    std::string code = CodeEmitter().Emit(scheduled, "gemm_" + std::to_string(M) + "x" + std::to_string(N) + "x" +
+                                                         std::to_string(K));
+    if (!out_file.empty()) {
+        std::ofstream(out_file) << code;
+        std::cout << "generated kernel written to " << out_file << std::endl;
+    } else {
+        std::cout << "----- generated C++ -----\n" << code;
+    }
+    return max_diff < 1e-3f;
+}
+
+// 跨通道依赖：Interpreter 逐通道执行，看不出错误，所以直接检查 CodeEmitter 的输出。
+// a[i + 1] = a[i] + b[i] 必须保持标量循环；a[i] = a[i] + b[i] 与 a[i + 8] = a[i] + b[i]（宽度 8 内不重叠）可以向量化
+static bool CheckDependenceCase(const Affine& store_index, bool expect_vector) {
+    auto value = std::make_shared<BinaryExpr>('+', std::make_shared<LoadExpr>("a", Affine::Var("i")),
+                                              std::make_shared<LoadExpr>("b", Affine::Var("i")));
+    StmtPtr loop = std::make_shared<ForNode>("i", 8, std::make_shared<StoreStmt>("a", store_index, value, false));
+    std::string code = CodeEmitter().Emit(LoopVectorizer("avx2")(loop, "i"), "dep");
+    bool vectorized = code.find("_mm256_storeu_ps") != std::string::npos;
+    std::cout << "a[" << store_index.Str() << "] = a[i] + b[i]: " << (vectorized ? "vectorized" : "scalar")
+              << (vectorized == expect_vector ? "" : "  (unexpected)") << std::endl;
+    return vectorized == expect_vector;
+}
+
+int main(int argc, char** argv) {
+    // 原来的用法：直接向量化一个顶层循环（x[i] += y[i]，宽度 4）
+    auto loop_body = std::make_shared<StoreStmt>("x", Affine::Var("i"), std::make_shared<LoadExpr>("y", Affine::Var("i")), true);
+    auto for_node = std::make_shared<ForNode>("i",4,loop_body);
     auto vectorized_stmt = LoopVectorizer("example_attr")(std::move(for_node));
     // 输出结果
     if (auto vec_stmt = std::dynamic_pointer_cast<VectorizedStmt>(vectorized_stmt)) {
-        std::cout << "Successfully vectorized: " << vec_stmt->loop_var 
+        std::cout << "Successfully vectorized: " << vec_stmt->loop_var
                   << " with extent: " << vec_stmt->extent << std::endl;
     }
 
-    return 0;
+    // 二维分块 + 向量化：i, j 按 4x8 分块，k 移到 ji 外层，ji 宽度 8 用 AVX2
+    StmtPtr tiled = Reorder(Tile(MakeGemm(16, 16, 16), "i", "j", 4, 8), {"io", "jo", "ii", "k", "ji"});
+    tiled = LoopVectorizer("avx2")(tiled, "ji");
+    std::cout << "----- Tile(i, j, 4, 8) + vectorize(ji) -----\n";
+    Print(tiled, std::cout);
 
-
-}
\ No newline at end of file
+    std::cout << "----- loop-carried dependences -----\n";
+    bool ok = CheckDependenceCase(Affine::Var("i") + Affine::Const(1), false);
+    ok = CheckDependenceCase(Affine::Var("i"), true) && ok;
+    ok = CheckDependenceCase(Affine::Var("i") + Affine::Const(8), true) && ok;
+    if (argc >= 4) {
+        ok = RunCase(std::atoi(argv[1]), std::atoi(argv[2]), std::atoi(argv[3]), argc >= 5 ? argv[4] : "") && ok;
+    } else {
+        ok = RunCase(64, 64, 64, "") && ok;   // 整除：没有守卫
+        ok = RunCase(50, 36, 40, "") && ok;   // 不整除：叶子语句带守卫
+    }
+    std::cout << (ok ? "All checks passed" : "MISMATCH") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+#ifndef AMX_CONTEXT_H
+#define AMX_CONTEXT_H
+
+#include <immintrin.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+// AMX 运行时上下文：把 arch_prctl 和 LDTILECFG 从热路径上拿掉
+//   - XTILEDATA 权限按进程申请，只在第一次使用时调用一次 syscall
+//   - tile 配置按线程生效（LDTILECFG 只影响当前线程），所以上下文是 thread_local 的
+//   - 每种 tile 形状预先构造好 64 字节配置并缓存，形状与当前已加载的相同时不再执行 LDTILECFG
+//   - tile 状态一直加载着时，线程每次被切换都要经由 XSAVE 保存 / 恢复 8 KB 的 tile 数据，
+//     所以一段 AMX 计算结束后应当 TILERELEASE：用 AmxPhase 标出这一段，最外层的 AmxPhase 结束时释放
+//
+// 用法：
+//   AmxPhase phase;                        // 一次 GEMM，或外面再套一层包住一批 GEMM
+//   AmxContext& ctx = AmxContext::get();
+//   if (!ctx.configure(shape)) { /* 不支持 AMX */ }
+//   ... _tile_loadd / _tile_dp* / _tile_stored ...
+//                                          // phase 析构：没有外层阶段时 release()
+
+// 64 字节 tile 配置（LDTILECFG 的内存格式）
+struct AmxTileConfig {
+    uint8_t palette_id;      // 1：8 个 tile，每个最大 16 行 × 64 字节
+    uint8_t start_row;
+    uint8_t reserved_0[14];
+    uint16_t colsb[16];      // 每个 tile 一行的字节数
+    uint8_t rows[16];        // 每个 tile 的行数
+};
+static_assert(sizeof(AmxTileConfig) == 64, "tile config must be 64 bytes");
+
+constexpr int AMX_NUM_TILES = 8;
+constexpr int AMX_TILE_ROWS = 16;   // tile 最大行数
+constexpr int AMX_TILE_COLSB = 64;  // tile 一行最大字节数
+
+constexpr int AMX_ARCH_REQ_XCOMP_PERM = 0x1023;
+constexpr int AMX_XFEATURE_XTILEDATA = 18;
+
+// tile 形状：TMM0-7 各自的行数与每行字节数，未使用的 tile 为 0
+struct AmxTileShape {
+    uint8_t rows[AMX_NUM_TILES] = {0};
+    uint16_t colsb[AMX_NUM_TILES] = {0};
+
+    AmxTileShape& set(int tile, int r, int cb) {
+        rows[tile] = static_cast<uint8_t>(r);
+        colsb[tile] = static_cast<uint16_t>(cb);
+        return *this;
+    }
+
+    bool operator==(const AmxTileShape& o) const {
+        return std::memcmp(rows, o.rows, sizeof(rows)) == 0 && std::memcmp(colsb, o.colsb, sizeof(colsb)) == 0;
+    }
+
+    // 8 个 tile 全部为 16 行 × 64 字节
+    static AmxTileShape full() {
+        AmxTileShape s;
+        for (int t = 0; t < AMX_NUM_TILES; ++t) s.set(t, AMX_TILE_ROWS, AMX_TILE_COLSB);
+        return s;
+    }
+};
+
+struct AmxTileShapeHash {
+    size_t operator()(const AmxTileShape& s) const {
+        uint64_t h = 1469598103934665603ull;  // FNV-1a
+        for (int t = 0; t < AMX_NUM_TILES; ++t) {
+            h = (h ^ s.rows[t]) * 1099511628211ull;
+            h = (h ^ s.colsb[t]) * 1099511628211ull;
+        }
+        return static_cast<size_t>(h);
+    }
+};
+
+class AmxContext {
+public:
+    // 当前线程的上下文
+    static AmxContext& get() {
+        static thread_local AmxContext ctx;
+        return ctx;
+    }
+
+    // 进程级的 XTILEDATA 权限，syscall 只执行一次（函数内静态变量的初始化是线程安全的）
+    static bool available() {
+        static const bool ok = syscall(SYS_arch_prctl, AMX_ARCH_REQ_XCOMP_PERM, AMX_XFEATURE_XTILEDATA) == 0;
+        return ok;
+    }
+
+    // 切换到 shape 对应的配置；与当前已加载的形状相同时直接返回
+    bool configure(const AmxTileShape& shape) {
+        if (!available()) return false;
+        if (loaded_ && shape == current_) return true;
+        auto it = configs_.find(shape);
+        if (it == configs_.end()) it = configs_.emplace(shape, build_config(shape)).first;
+        _tile_loadconfig(&it->second);
+        current_ = shape;
+        loaded_ = true;
+        ++reloads_;
+        return true;
+    }
+
+    // 释放 tile 状态（TILERELEASE 之后配置失效，下次 configure 会重新加载）
+    void release() {
+        if (loaded_) _tile_release();
+        loaded_ = false;
+    }
+
+    // AMX 阶段的嵌套计数（由 AmxPhase 维护），最外层阶段结束时释放 tile 状态
+    void begin_phase() { ++phase_depth_; }
+    void end_phase() {
+        if (--phase_depth_ == 0) release();
+    }
+
+    int reloads() const { return reloads_; }        // 实际执行 LDTILECFG 的次数
+    size_t cached_shapes() const { return configs_.size(); }
+
+    AmxContext(const AmxContext&) = delete;
+    AmxContext& operator=(const AmxContext&) = delete;
+
+private:
+    AmxContext() = default;
+    ~AmxContext() { release(); }
+
+    // 缓存中的配置按 64 字节对齐存放
+    struct alignas(64) Config : AmxTileConfig {};
+
+    static Config build_config(const AmxTileShape& shape) {
+        Config cfg;
+        std::memset(&cfg, 0, sizeof(cfg));
+        cfg.palette_id = 1;
+        for (int t = 0; t < AMX_NUM_TILES; ++t) {
+            cfg.rows[t] = shape.rows[t];
+            cfg.colsb[t] = shape.colsb[t];
+        }
+        return cfg;
+    }
+
+    std::unordered_map<AmxTileShape, Config, AmxTileShapeHash> configs_;
+    AmxTileShape current_;
+    bool loaded_ = false;
+    int reloads_ = 0;
+    int phase_depth_ = 0;
+};
+
+// 一段连续使用 AMX 的代码：构造时进入阶段，析构时退出，最外层退出时执行 TILERELEASE。
+// 库函数内部各自套一层，单独调用时用完即释放；连续多次调用时调用方在外面再套一层，
+// 中间不释放，tile 配置只加载一次。
+class AmxPhase {
+public:
+    AmxPhase() : ctx_(AmxContext::get()) { ctx_.begin_phase(); }
+    ~AmxPhase() { ctx_.end_phase(); }
+
+    AmxPhase(const AmxPhase&) = delete;
+    AmxPhase& operator=(const AmxPhase&) = delete;
+
+private:
+    AmxContext& ctx_;
+};
+
+#endif // AMX_CONTEXT_H
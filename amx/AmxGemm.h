@@ -0,0 +1,248 @@
+#ifndef AMX_GEMM_H
+#define AMX_GEMM_H
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "AmxContext.h"
+
+// 任意尺寸的 AMX GEMM：C = A * B（覆盖 C）
+//   amx_gemm_s8s8s32: int8 × int8 -> int32（_tile_dpbssd）
+//   amx_gemm_bf16:    bf16 × bf16 -> fp32（_tile_dpbf16ps）
+//   amx_gemm_fp16:    fp16 × fp16 -> fp32（有 AMX-FP16 时用 _tile_dpfp16ps，否则打包时转成 bf16）
+// A: M×K 行优先，B: K×N 行优先，C: M×N 行优先，跨度单位均为元素。
+//
+// 8 个 tile 全部配置成 16 行 × 64 字节：
+//   TMM0-3  C 的 2×2 个 16×16 累加块（32×32 输出块）
+//   TMM4-5  A 的两个 16 行块，每次 64 字节 K（64 个 int8 / 32 个 bf16）
+//   TMM6-7  B 的两个 16 列块（VNNI 布局）
+// 整个 K 循环都在 tile 中累加，输出块只写回一次。
+// 权限申请与 tile 配置由 AmxContext 管理。每次调用是一个 AmxPhase：单独调用结束时释放 tile 状态；
+// 连续多次调用时在外面套一层 AmxPhase，配置在整批调用中保持加载，批结束时才释放。
+//
+// 编译：g++ -O2 -march=native -mamx-tile -mamx-int8 -mamx-bf16
+
+constexpr int AMX_BLOCK_M = 2 * AMX_TILE_ROWS;  // 一次输出块 32 行
+constexpr int AMX_BLOCK_N = 2 * AMX_TILE_ROWS;  // 一次输出块 32 列（C tile 一行 16 个 32 位结果）
+
+using amx_bf16_t = uint16_t;  // bf16 / fp16 都按 16 位原始位模式存放
+
+// fp32 -> bf16，向最近偶数舍入
+inline amx_bf16_t amx_float_to_bf16(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    if ((u & 0x7fffffffu) > 0x7f800000u) return static_cast<amx_bf16_t>((u >> 16) | 0x40);  // NaN 保持为 NaN
+    u += 0x7fffu + ((u >> 16) & 1u);
+    return static_cast<amx_bf16_t>(u >> 16);
+}
+
+inline float amx_bf16_to_float(amx_bf16_t h) {
+    uint32_t u = static_cast<uint32_t>(h) << 16;
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// 打包 A：M×K 拷贝成 Mp×Kp（补 0），行跨度 Kp 个元素，一行 K 正好是整数个 64 字节
+template <typename Src, typename Dst, typename Convert>
+inline void amx_pack_a(const Src* A, int lda, int M, int K, int Mp, int Kp, Dst* dst, Convert cvt) {
+    for (int i = 0; i < Mp; ++i) {
+        Dst* d = dst + static_cast<size_t>(i) * Kp;
+        if (i < M) {
+            const Src* a = A + static_cast<size_t>(i) * lda;
+            for (int k = 0; k < K; ++k) d[k] = cvt(a[k]);
+            std::fill(d + K, d + Kp, Dst(0));
+        } else {
+            std::fill(d, d + Kp, Dst(0));
+        }
+    }
+}
+
+// 打包 B 为 VNNI 布局：每个 32 位元素放 G = 4 / sizeof(Dst) 个相邻 K（int8 为 4 个，bf16 为 2 个）
+//   按 16 列一组面板存放，面板内第 kk 行是 16 列 × G 个 K：
+//   dst[((jb * Kp/G + kk) * 16 + n) * G + g] = B[kk*G + g][jb*16 + n]
+// 这样一个 B tile（16 行 × 64 字节）覆盖 16*G 个 K、16 列，行跨度固定 64 字节
+template <typename Src, typename Dst, typename Convert>
+inline void amx_pack_b_vnni(const Src* B, int ldb, int K, int N, int Kp, int Np, Dst* dst, Convert cvt) {
+    constexpr int G = 4 / sizeof(Dst);
+    const int krows = Kp / G;
+    for (int jb = 0; jb < Np; jb += AMX_TILE_ROWS) {
+        for (int kk = 0; kk < krows; ++kk) {
+            Dst* d = dst + (static_cast<size_t>(jb / AMX_TILE_ROWS) * krows + kk) * AMX_TILE_ROWS * G;
+            for (int n = 0; n < AMX_TILE_ROWS; ++n) {
+                int j = jb + n;
+                for (int g = 0; g < G; ++g) {
+                    int k = kk * G + g;
+                    d[n * G + g] = (j < N && k < K) ? cvt(B[static_cast<size_t>(k) * ldb + j]) : Dst(0);
+                }
+            }
+        }
+    }
+}
+
+// 2×2 tile 的点积：_tile_dp* 的 tile 编号必须是编译期常量，用类型来选择指令
+struct AmxDotS8 {
+    using Elem = int8_t;  // 打包后的元素类型
+    static void run() {
+        _tile_dpbssd(0, 4, 6);
+        _tile_dpbssd(1, 4, 7);
+        _tile_dpbssd(2, 5, 6);
+        _tile_dpbssd(3, 5, 7);
+    }
+};
+
+struct AmxDotBF16 {
+    using Elem = amx_bf16_t;
+    static void run() {
+        _tile_dpbf16ps(0, 4, 6);
+        _tile_dpbf16ps(1, 4, 7);
+        _tile_dpbf16ps(2, 5, 6);
+        _tile_dpbf16ps(3, 5, 7);
+    }
+};
+
+#ifdef __AMX_FP16__
+struct AmxDotFP16 {
+    using Elem = uint16_t;
+    static void run() {
+        _tile_dpfp16ps(0, 4, 6);
+        _tile_dpfp16ps(1, 4, 7);
+        _tile_dpfp16ps(2, 5, 6);
+        _tile_dpfp16ps(3, 5, 7);
+    }
+};
+#endif
+
+// 32×32 输出块：a 指向已打包 A 的 32 行（行跨度 a_stride 字节），b0 / b1 指向两个 16 列面板，
+// ksteps 个 64 字节 K 步全部在 TMM0-3 中累加，最后写回 c（行跨度 c_stride 字节）
+template <typename Dot>
+inline void amx_kernel_2x2(const uint8_t* a, size_t a_stride, const uint8_t* b0, const uint8_t* b1,
+                           int ksteps, uint8_t* c, size_t c_stride) {
+    _tile_zero(0);
+    _tile_zero(1);
+    _tile_zero(2);
+    _tile_zero(3);
+    const size_t b_tile_bytes = AMX_TILE_ROWS * AMX_TILE_COLSB;
+    for (int ks = 0; ks < ksteps; ++ks) {
+        _tile_loadd(4, a + ks * AMX_TILE_COLSB, a_stride);
+        _tile_loadd(5, a + AMX_TILE_ROWS * a_stride + ks * AMX_TILE_COLSB, a_stride);
+        _tile_loadd(6, b0 + ks * b_tile_bytes, AMX_TILE_COLSB);
+        _tile_loadd(7, b1 + ks * b_tile_bytes, AMX_TILE_COLSB);
+        Dot::run();
+    }
+    _tile_stored(0, c, c_stride);
+    _tile_stored(1, c + AMX_TILE_COLSB, c_stride);
+    _tile_stored(2, c + AMX_TILE_ROWS * c_stride, c_stride);
+    _tile_stored(3, c + AMX_TILE_ROWS * c_stride + AMX_TILE_COLSB, c_stride);
+}
+
+// 通用驱动：打包 A / B，按 32 列面板对（外层，B 面板在整个 i 循环中复用）× 32 行遍历输出块。
+// 整块落在 C 内时直接写回 C，边界块先写到 32×32 临时缓冲再拷贝有效部分。
+template <typename Dot, typename Src, typename Out, typename Convert>
+inline bool amx_gemm_impl(const Src* A, int lda, const Src* B, int ldb, Out* C, int ldc,
+                          int M, int N, int K, Convert cvt) {
+    using Dst = typename Dot::Elem;
+    static_assert(sizeof(Out) == 4, "AMX accumulators are 32-bit");
+    if (M <= 0 || N <= 0) return true;
+    // 所有形状共用同一个全尺寸配置：同一个 AmxPhase 内的连续调用既不再 syscall，也不再 LDTILECFG
+    AmxPhase phase;
+    AmxContext& ctx = AmxContext::get();
+    if (!ctx.configure(AmxTileShape::full())) {
+        std::cerr << "Failed to enable AMX tile data\n";
+        return false;
+    }
+
+    constexpr int k_per_step = AMX_TILE_COLSB / sizeof(Dst);
+    auto round_up = [](int v, int r) { return (v + r - 1) / r * r; };
+    const int Mp = round_up(M, AMX_BLOCK_M);
+    const int Np = round_up(N, AMX_BLOCK_N);
+    const int Kp = round_up(std::max(K, 1), k_per_step);
+    const int ksteps = Kp / k_per_step;
+
+    size_t a_bytes = static_cast<size_t>(Mp) * Kp * sizeof(Dst);
+    size_t b_bytes = static_cast<size_t>(Np) * Kp * sizeof(Dst);
+    Dst* a_pack = static_cast<Dst*>(std::aligned_alloc(64, a_bytes));
+    Dst* b_pack = static_cast<Dst*>(std::aligned_alloc(64, b_bytes));
+    if (!a_pack || !b_pack) {
+        std::cerr << "Failed to allocate AMX packing buffers\n";
+        std::free(a_pack);
+        std::free(b_pack);
+        return false;
+    }
+    amx_pack_a(A, lda, M, K, Mp, Kp, a_pack, cvt);
+    amx_pack_b_vnni(B, ldb, K, N, Kp, Np, b_pack, cvt);
+
+    const uint8_t* a_base = reinterpret_cast<const uint8_t*>(a_pack);
+    const uint8_t* b_base = reinterpret_cast<const uint8_t*>(b_pack);
+    const size_t a_stride = static_cast<size_t>(Kp) * sizeof(Dst);
+    const size_t panel_bytes = static_cast<size_t>(Kp) * sizeof(Dst) * AMX_TILE_ROWS;  // 一个 16 列面板
+    alignas(64) Out tmp[AMX_BLOCK_M * AMX_BLOCK_N];
+
+    for (int j = 0; j < N; j += AMX_BLOCK_N) {
+        const uint8_t* b0 = b_base + static_cast<size_t>(j / AMX_TILE_ROWS) * panel_bytes;
+        const uint8_t* b1 = b0 + panel_bytes;
+        int cols = std::min(AMX_BLOCK_N, N - j);
+        for (int i = 0; i < M; i += AMX_BLOCK_M) {
+            int rows = std::min(AMX_BLOCK_M, M - i);
+            const uint8_t* a = a_base + static_cast<size_t>(i) * a_stride;
+            Out* c = C + static_cast<size_t>(i) * ldc + j;
+            if (rows == AMX_BLOCK_M && cols == AMX_BLOCK_N) {
+                amx_kernel_2x2<Dot>(a, a_stride, b0, b1, ksteps, reinterpret_cast<uint8_t*>(c),
+                                    static_cast<size_t>(ldc) * sizeof(Out));
+            } else {
+                amx_kernel_2x2<Dot>(a, a_stride, b0, b1, ksteps, reinterpret_cast<uint8_t*>(tmp),
+                                    AMX_BLOCK_N * sizeof(Out));
+                for (int r = 0; r < rows; ++r) {
+                    std::memcpy(c + static_cast<size_t>(r) * ldc, tmp + r * AMX_BLOCK_N, cols * sizeof(Out));
+                }
+            }
+        }
+    }
+
+    std::free(a_pack);
+    std::free(b_pack);
+    return true;
+}
+
+// int8 × int8 -> int32
+inline bool amx_gemm_s8s8s32(const int8_t* A, int lda, const int8_t* B, int ldb, int32_t* C, int ldc,
+                             int M, int N, int K) {
+    return amx_gemm_impl<AmxDotS8>(A, lda, B, ldb, C, ldc, M, N, K, [](int8_t v) { return v; });
+}
+
+inline bool amx_gemm_s8s8s32(const int8_t* A, const int8_t* B, int32_t* C, int M, int N, int K) {
+    return amx_gemm_s8s8s32(A, K, B, N, C, N, M, N, K);
+}
+
+// bf16 × bf16 -> fp32
+inline bool amx_gemm_bf16(const amx_bf16_t* A, int lda, const amx_bf16_t* B, int ldb, float* C, int ldc,
+                          int M, int N, int K) {
+    return amx_gemm_impl<AmxDotBF16>(A, lda, B, ldb, C, ldc, M, N, K, [](amx_bf16_t v) { return v; });
+}
+
+inline bool amx_gemm_bf16(const amx_bf16_t* A, const amx_bf16_t* B, float* C, int M, int N, int K) {
+    return amx_gemm_bf16(A, K, B, N, C, N, M, N, K);
+}
+
+// fp16 × fp16 -> fp32（A / B 为 IEEE half 位模式）
+// 只有 AMX-BF16 的机器（Sapphire Rapids）上打包时转换为 bf16，尾数从 10 位降到 7 位
+inline bool amx_gemm_fp16(const uint16_t* A, int lda, const uint16_t* B, int ldb, float* C, int ldc,
+                          int M, int N, int K) {
+#ifdef __AMX_FP16__
+    return amx_gemm_impl<AmxDotFP16>(A, lda, B, ldb, C, ldc, M, N, K, [](uint16_t v) { return v; });
+#else
+    return amx_gemm_impl<AmxDotBF16>(A, lda, B, ldb, C, ldc, M, N, K,
+                                     [](uint16_t v) { return amx_float_to_bf16(_cvtsh_ss(v)); });
+#endif
+}
+
+inline bool amx_gemm_fp16(const uint16_t* A, const uint16_t* B, float* C, int M, int N, int K) {
+    return amx_gemm_fp16(A, K, B, N, C, N, M, N, K);
+}
+
+#endif // AMX_GEMM_H
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "AmxGemm.h"
+
+/*
+编译：
+g++ -O2 -march=native -mamx-tile -mamx-int8 -mamx-bf16 amx_gemm.cpp -o amx_gemm
+执行：./amx_gemm
+*/
+
+// 标量参考实现
+void gemm_ref_s8(const std::vector<int8_t>& A, const std::vector<int8_t>& B, std::vector<int32_t>& C,
+                 int M, int N, int K) {
+    for (int i = 0; i < M; ++i)
+        for (int j = 0; j < N; ++j) {
+            int32_t sum = 0;
+            for (int k = 0; k < K; ++k) sum += int32_t(A[i * K + k]) * int32_t(B[k * N + j]);
+            C[i * N + j] = sum;
+        }
+}
+
+void gemm_ref_bf16(const std::vector<amx_bf16_t>& A, const std::vector<amx_bf16_t>& B, std::vector<float>& C,
+                   int M, int N, int K) {
+    for (int i = 0; i < M; ++i)
+        for (int j = 0; j < N; ++j) {
+            double sum = 0.0;
+            for (int k = 0; k < K; ++k) sum += double(amx_bf16_to_float(A[i * K + k])) * amx_bf16_to_float(B[k * N + j]);
+            C[i * N + j] = static_cast<float>(sum);
+        }
+}
+
+bool test_s8(int M, int N, int K) {
+    std::vector<int8_t> A(M * K), B(K * N);
+    std::vector<int32_t> C(M * N, -1), C_ref(M * N);
+    std::mt19937 gen(M * 31 + N * 7 + K);
+    std::uniform_int_distribution<int> dis(-128, 127);
+    for (auto& v : A) v = static_cast<int8_t>(dis(gen));
+    for (auto& v : B) v = static_cast<int8_t>(dis(gen));
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool ran = amx_gemm_s8s8s32(A.data(), B.data(), C.data(), M, N, K);
+    auto end = std::chrono::high_resolution_clock::now();
+    double sec = std::chrono::duration<double>(end - start).count();
+
+    gemm_ref_s8(A, B, C_ref, M, N, K);
+    int bad = 0;
+    for (int i = 0; i < M * N; ++i) bad += C[i] != C_ref[i];
+    bool ok = ran && bad == 0;
+    std::cout << "s8s8s32 " << M << "x" << N << "x" << K << ": " << sec * 1e3 << " ms, "
+              << 2.0 * M * N * K / sec / 1e9 << " GOPS" << (ok ? "" : " (MISMATCH)") << "\n";
+    return ok;
+}
+
+bool test_bf16(int M, int N, int K) {
+    std::vector<amx_bf16_t> A(M * K), B(K * N);
+    std::vector<float> C(M * N, -1.0f), C_ref(M * N);
+    std::mt19937 gen(M * 31 + N * 7 + K);
+    std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+    for (auto& v : A) v = amx_float_to_bf16(dis(gen));
+    for (auto& v : B) v = amx_float_to_bf16(dis(gen));
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool ran = amx_gemm_bf16(A.data(), B.data(), C.data(), M, N, K);
+    auto end = std::chrono::high_resolution_clock::now();
+    double sec = std::chrono::duration<double>(end - start).count();
+
+    // bf16 乘积在 fp32 中累加，与 double 参考的误差随 K 增长
+    gemm_ref_bf16(A, B, C_ref, M, N, K);
+    float max_err = 0.0f;
+    for (int i = 0; i < M * N; ++i) max_err = std::max(max_err, std::fabs(C[i] - C_ref[i]));
+    bool ok = ran && max_err <= 1e-5f * K + 1e-6f;
+    std::cout << "bf16    " << M << "x" << N << "x" << K << ": " << sec * 1e3 << " ms, "
+              << 2.0 * M * N * K / sec / 1e9 << " GFLOPS, max abs err " << max_err
+              << (ok ? "" : " (MISMATCH)") << "\n";
+    return ok;
+}
+
+// fp16 输入：没有 AMX-FP16 时打包成 bf16，误差按 bf16 精度估计
+bool test_fp16(int M, int N, int K) {
+    std::vector<uint16_t> A(M * K), B(K * N);
+    std::vector<float> C(M * N);
+    std::mt19937 gen(M + N + K);
+    std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+    for (auto& v : A) v = _cvtss_sh(dis(gen), 0);
+    for (auto& v : B) v = _cvtss_sh(dis(gen), 0);
+
+    bool ran = amx_gemm_fp16(A.data(), B.data(), C.data(), M, N, K);
+    float max_err = 0.0f;
+    for (int i = 0; i < M; ++i)
+        for (int j = 0; j < N; ++j) {
+            double sum = 0.0;
+            for (int k = 0; k < K; ++k) sum += double(_cvtsh_ss(A[i * K + k])) * _cvtsh_ss(B[k * N + j]);
+            max_err = std::max(max_err, std::fabs(C[i * N + j] - static_cast<float>(sum)));
+        }
+    bool ok = ran && max_err <= 1e-2f * std::sqrt(float(K));
+    std::cout << "fp16    " << M << "x" << N << "x" << K << ": max abs err " << max_err
+              << (ok ? "" : " (MISMATCH)") << "\n";
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    AmxPhase batch;  // 整批测试共用一个 AMX 阶段，中间不释放 tile，结束时释放
+    // 边界：不足一个 tile、非 16 / 64 倍数、K 不是 VNNI 分组的整数倍
+    const int shapes[][3] = {{1, 1, 1}, {17, 33, 65}, {100, 70, 130}, {32, 32, 64}, {256, 256, 256}, {1024, 1024, 1024}};
+    for (const auto& s : shapes) ok &= test_s8(s[0], s[1], s[2]);
+    for (const auto& s : shapes) ok &= test_bf16(s[0], s[1], s[2]);
+    ok &= test_fp16(100, 70, 130);
+    // 所有调用在同一个 AmxPhase 内，共用同一个 tile 配置，只加载一次
+    std::cout << "tile config loads: " << AmxContext::get().reloads() << "\n";
+    return ok ? 0 : 1;
+}
@@ -6,6 +6,8 @@
 #include <sys/syscall.h>
 #include <unistd.h>
 
+#include "AmxContext.h"
+
 /*
 编译：
 clang++ -O0 -g -march=native -mamx-tile -mamx-int8 -fno-strict-aliasing int8mmamx.cpp  -o int8mmamx
@@ -24,65 +26,26 @@ drives the execution of tile and accelerator instructions
 size_t MAX = 1024;
 int MAX_ROWS = 8; // 最大为16， 8x8 矩阵的行数设置为8
 int MAX_COLS = 32; // 最大为64，由于_tile_dpbssd 最低计算 4个int_8 ,所以这里设置为32字节
-int ARCH_GET_XCOMP_PERM = 0x1022;
-int ARCH_REQ_XCOMP_PERM = 0x1023;
-int XFEATURE_XTILECFG = 17;
-int XFEATURE_XTILEDATA = 18;
-
-// TIlE配置结构体
-// AMX（Advanced Matrix Extensions）在硬件上支持 8 个 tile 寄存器，编号从 tmm0 到 tmm7。
-struct __tile_config {
-  uint8_t palette_id; // 配置模式:0 1
-  uint8_t start_row;
-  uint8_t reserved_0[14];
-  uint16_t colsb[16]; // 每个 tile 的列字节数
-  
-  // rows[i] 每个 tile 的行数:
-  // rows[i] 的确是第 i 个 tile 的行数，范围是 0 到
-  // 255（uint8_t 的取值范围） AMX 当前支持 8 个 tile（tmm0 到
-  // tmm7），所以只用前 8 个元素，后 8 个预留。 如，rows[0] = 8 表示 tile 0 有 8 行。
-  uint8_t rows[16]; // 每个 tile 的行数
-};
-
-bool set_tiledata_use() {
-  if (syscall(SYS_arch_prctl, ARCH_REQ_XCOMP_PERM, XFEATURE_XTILEDATA)) {
-    std::cerr << "Failed to enable AMX tile data\n";
-    return false;
-  } else {
-    printf("\n TILE DATA USE SET - OK \n\n");
-    return true;
-  }
-  return true;
-}
-
-void init_tile_config(__tile_config *tileinfo) {
 
-  int i;
-  tileinfo->palette_id = 1;
-  tileinfo->start_row = 0;
-
-  /*
-  void _tile_loadconfig (const void * mem_addr)
-  Load tile configuration from a 64-byte memory location specified by mem_addr. 
-  The tile configuration format is specified below, and includes the tile type pallette, 
-  the number of bytes per row, and the number of rows.
-  */
-  for (i = 1; i < 4; ++i) {
-    tileinfo->colsb[i] = MAX_COLS; // 由于_tile_dpbssd 最低计算 4个int_8 ,所以这里设置为32字节
-    tileinfo->rows[i] = MAX_ROWS;
+// 本例用到的 tile 形状：tile 1 为 C（8 行 × 8 个 int32），tile 2 / 3 为 A / B（8 行 × 32 字节）
+// 权限申请（arch_prctl）与 _tile_loadconfig 都交给 AmxContext：
+// 进程内只 syscall 一次，同一个 AmxPhase 内形状不变时不再重新加载配置，见 AmxContext.h
+AmxTileShape int8_tile_shape() {
+  AmxTileShape shape;
+  for (int i = 1; i < 4; ++i) {
+    shape.set(i, MAX_ROWS, MAX_COLS); // 由于_tile_dpbssd 最低计算 4个int_8 ,所以这里设置为32字节
   }
-
-  _tile_loadconfig(tileinfo);
+  return shape;
 }
 
 void matrix_multiply_8x8_amx(int8_t *A, int8_t *B, int32_t *C) {
 
-  __tile_config tile_data = {0};
-  if (!set_tiledata_use()) {
+  static const AmxTileShape shape = int8_tile_shape();
+  AmxPhase phase;  // 单独调用时结束即释放 tile；调用方外层有 AmxPhase 时保持加载
+  if (!AmxContext::get().configure(shape)) {
+    std::cerr << "Failed to enable AMX tile data\n";
     exit(-1);
   }
-
-  init_tile_config(&tile_data);
   // 加载矩阵 A B C 到 tile 
   _tile_loadd(2, A, 32);
   _tile_loadd(3, B, 32);
@@ -106,8 +69,7 @@ void matrix_multiply_8x8_amx(int8_t *A, int8_t *B, int32_t *C) {
   _tile_dpbssd(1, 2, 3);
   // 将结果从 tile 中存储到 C 矩阵
   _tile_stored(1, C, 32);
-
-  _tile_release();
+  // 不直接 _tile_release：由最外层的 AmxPhase 结束时释放
 }
 
 
@@ -181,6 +143,16 @@ int main() {
   matrix_multiply_8x8_amx(A, B, C);
 
   print_buffer32(C, rows, 32 / 4);
+
+  // 重复调用：整批放在一个 AmxPhase 里，形状不变，不再执行 syscall 和 LDTILECFG，批结束时释放 tile
+  {
+    AmxPhase batch;
+    for (int i = 0; i < 1000; ++i) {
+      init_buffer32(C, 0);
+      matrix_multiply_8x8_amx(A, B, C);
+    }
+  }
+  printf("tile config loads after 1001 calls: %d\n", AmxContext::get().reloads());
   
   return 0;
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include <cstring>
 #include <cpuid.h>
 
+#include "AmxContext.h"
+
 
 // 对齐的要求
 // 定义矩阵大小
@@ -22,81 +24,35 @@ size_t STRIDE_FP32 = COLS * sizeof(float); // FP32步幅 8*4 = 32 字节
 using float16_t = __fp16;
 
 
-// TIlE配置结构体
-// AMX（Advanced Matrix Extensions）在硬件上支持 8 个 tile 寄存器，编号从 tmm0 到 tmm7。
-struct __tile_config {
-    uint8_t palette_id;    // 配置模式
-    uint8_t start_row;     // 起始行（用于分块计算）
-    uint8_t reserved[14];  // 保留字节，用于对齐
-    // 每个 tile 的行数:rows[i] 的确是第 i 个 tile 的行数，范围是 0 到 255（uint8_t 的取值范围）
-    // AMX 当前支持 8 个 tile（tmm0 到 tmm7），所以只用前 8 个元素，后 8 个预留。
-    // 如，rows[0] = 8 表示 tile 0 有 8 行。
-    uint8_t rows[16];     
-    uint16_t colsb[16];    // 每个 tile 的列字节数 
-};
-
-// Set_tiledata_use() - Invoke syscall to set ARCH_SET_STATE_USE 
-bool set_tiledata_use() {
-    if (syscall(SYS_arch_prctl, 0x1023, 18)) {
-        std::cerr << "Failed to enable AMX tile data \n";
-        return false;
-    }
-    return true;
-}
-
-// void init_tile_config (__tile_config* tileinfo) {
-//     tileinfo->palette_id = 1;
-//     tileinfo->start_row = 0;
-//     for (int i = 0; i < 3; ++i) { // 配置 3 个 tile
-//         tileinfo->rows[i] = ROWS;        // 8 行
-//         tileinfo->colsb[i] = COLS * 2;   // 列字节数：8 列 * 2字节（FP16) 16 字节
-//     }
-
-//     std::cout << "tileinfo rows: ";
-//     for (int i = 0; i < 16; ++i) {
-//         std::cout << (int)tileinfo->rows[i] << " ";
-//     }
-//     std::cout << "\n";
-
-//      _tile_loadconfig(tileinfo); // 加载 tile 配置
-// }
-
-void init_tile_config(__tile_config* tileinfo) {
-    std::memset(tileinfo, 0, sizeof(__tile_config));  // 清零
-
-    tileinfo->palette_id = 0;  // 先尝试 0，看是否默认支持
-    for (int i = 0; i < 3; ++i) {
-        tileinfo->rows[i] = 8;
-        tileinfo->colsb[i] = 16;  // FP16 需要 16 字节
-    }
-
-    std::cout << "tileinfo rows: ";
-    for (int i = 0; i < 16; ++i) {
-        std::cout << tileinfo->rows[i] << " ";
-    }
-    std::cout << "\ntileinfo colsb: ";
-    for (int i = 0; i < 16; ++i) {
-        std::cout << tileinfo->colsb[i] << " ";
-    }
-    std::cout << std::endl;
-
-    _tile_loadconfig(tileinfo);
+// tile 形状：tile 1 为 C（8 行 × 8 个 fp32 = 32 字节），tile 2 为 A（8 行 × 8 个 fp16 = 16 字节），
+// tile 3 为 VNNI 布局的 B（K/2 = 4 行 × 8 列 × 2 个 fp16 = 32 字节）。
+// 权限申请与 _tile_loadconfig 交给 AmxContext（palette 1，colsb 在 rows 之前），
+// 进程内只 syscall 一次，形状不变时不再重新加载配置
+AmxTileShape fp16_tile_shape() {
+    AmxTileShape shape;
+    shape.set(1, ROWS, COLS * sizeof(float));
+    shape.set(2, ROWS, COLS * sizeof(float16_t));
+    shape.set(3, COLS / 2, COLS * 2 * sizeof(float16_t));
+    return shape;
 }
 
 // 
 void matrix_multiply_8x8_fp16_amx(const float16_t* A, const float16_t* B, float* C) {
-     // 初始化 tile 配置
-     alignas(64) __tile_config tile_data = {0};
-      
-     // Request permission to linux kernel to run AMX
-    if (!set_tiledata_use())
+    static const AmxTileShape shape = fp16_tile_shape();
+    if (!AmxContext::get().configure(shape)) {
+        std::cerr << "Failed to enable AMX tile data \n";
         exit(-1);
+    }
 
-     init_tile_config(&tile_data);
+    // B 重排为 VNNI 布局：相邻两行的同一列拼成一个 32 位元素
+    alignas(64) float16_t B_vnni[ROWS * COLS];
+    for (int k = 0; k < COLS; ++k)
+        for (int j = 0; j < COLS; ++j)
+            B_vnni[(k / 2) * COLS * 2 + j * 2 + k % 2] = B[k * COLS + j];
 
      // 加载矩阵 A 和 B 到 tile
      _tile_loadd(2, A, STRIDE_FP16);
-     _tile_loadd(3, B, STRIDE_FP16);
+     _tile_loadd(3, B_vnni, STRIDE_FP16 * 2);
      _tile_loadd(1, C, STRIDE_FP32);
 
     // 执行矩阵乘法 : 执行FP16点积，结果累加到f32
@@ -153,8 +109,8 @@ int main() {
     std::cout << "Result Matrix C (FP32):\n";
     print_matrix_fp32(C);
 
-    // 释放 tile（可选，通常程序结束时自动释放）
-    _tile_release();
+    // 释放 tile（可选，线程退出时 AmxContext 也会释放）
+    AmxContext::get().release();
 }
 
 
@@ -0,0 +1,291 @@
+#ifndef HUGE_PAGE_BUFFER_H
+#define HUGE_PAGE_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// 大页内存缓冲区：多 GB 的矩阵按 4 KB 页映射时，顺序扫描 A 每 4 KB 就换一个页表项，
+// DTLB（一级通常只有 64 ~ 96 项）很快被打满，页表遍历占到访存时间的可观比例。
+// 2 MB 页让同样的 TLB 覆盖 512 倍的地址范围，1 GB 页则几乎消除 TLB 缺失。
+//
+// 申请顺序（HugePagePolicy::Auto）：
+//   1. mmap + MAP_HUGETLB | MAP_HUGE_1GB     需要预留 1 GB 大页（hugepagesz=1G），只用于 >= 1 GB 的缓冲区
+//   2. mmap + MAP_HUGETLB（2 MB）            需要 /proc/sys/vm/nr_hugepages 预留
+//   3. mmap 普通页 + madvise(MADV_HUGEPAGE)  透明大页（THP），transparent_hugepage 为 always / madvise 时生效
+//   4. aligned_alloc                       非 Linux 平台
+// hugetlb 映射保证全部是大页；THP 只是建议，内核在缺页时才决定，实际大页数由 huge_pages() 从
+// /proc/self/smaps 的 AnonHugePages 读出。THP 只在首次写入时分配大页，所以构造后应先 touch()，
+// 或交给 gemv_first_touch 之类的按线程首次访问函数。
+// 无论落在哪种内存上，构造后的内容都是 0（匿名映射本来就清零，aligned_alloc 回退时显式清零）。
+//
+// 用法：
+//   HugePageBuffer buf(bytes);
+//   float* A = buf.as<float>();
+//   buf.touch();
+//   std::cout << buf.describe() << "\n";
+
+constexpr size_t HUGE_PAGE_2M = size_t(2) << 20;
+constexpr size_t HUGE_PAGE_1G = size_t(1) << 30;
+
+enum class HugePagePolicy {
+    Auto,         // 依次尝试 1 GB / 2 MB hugetlb、THP，最后回退普通页
+    HugeTLB,      // 只用 hugetlb（先 1 GB 后 2 MB），失败时回退 THP
+    Transparent,  // 只用 THP
+    None          // 普通 4 KB 页（对照组）
+};
+
+enum class HugePageBacking {
+    HugeTLB1G,
+    HugeTLB2M,
+    Transparent,
+    Small,
+    Heap
+};
+
+inline const char* huge_page_backing_name(HugePageBacking b) {
+    switch (b) {
+        case HugePageBacking::HugeTLB1G: return "hugetlb 1GB";
+        case HugePageBacking::HugeTLB2M: return "hugetlb 2MB";
+        case HugePageBacking::Transparent: return "THP (madvise)";
+        case HugePageBacking::Small: return "4KB pages";
+        case HugePageBacking::Heap: return "heap";
+    }
+    return "unknown";
+}
+
+class HugePageBuffer {
+public:
+    HugePageBuffer() = default;
+
+    explicit HugePageBuffer(size_t bytes, HugePagePolicy policy = HugePagePolicy::Auto) : size_(bytes) {
+        if (bytes == 0) return;
+#ifdef __linux__
+        bool want_tlb = policy == HugePagePolicy::Auto || policy == HugePagePolicy::HugeTLB;
+        if (want_tlb && bytes >= HUGE_PAGE_1G && map_hugetlb(bytes, HUGE_PAGE_1G)) return;
+        // 不足一个 2 MB 页的缓冲区用大页只会浪费内存
+        if (want_tlb && bytes >= HUGE_PAGE_2M && map_hugetlb(bytes, HUGE_PAGE_2M)) return;
+        if (policy != HugePagePolicy::None && bytes >= HUGE_PAGE_2M && map_transparent(bytes)) return;
+        if (map_small(bytes, policy == HugePagePolicy::None)) return;
+#else
+        (void)policy;
+#endif
+        mapped_ = (bytes + 63) / 64 * 64;
+        base_ = std::aligned_alloc(64, mapped_);
+        if (!base_) throw std::bad_alloc();
+        std::memset(base_, 0, mapped_);  // 与匿名映射一致：内容为 0
+        data_ = base_;
+        page_size_ = 4096;
+        backing_ = HugePageBacking::Heap;
+    }
+
+    ~HugePageBuffer() { reset(); }
+
+    HugePageBuffer(const HugePageBuffer&) = delete;
+    HugePageBuffer& operator=(const HugePageBuffer&) = delete;
+
+    HugePageBuffer(HugePageBuffer&& o) noexcept { swap(o); }
+    HugePageBuffer& operator=(HugePageBuffer&& o) noexcept {
+        if (this != &o) {
+            reset();
+            swap(o);
+        }
+        return *this;
+    }
+
+    void* data() { return data_; }
+    const void* data() const { return data_; }
+    template <typename T>
+    T* as() { return static_cast<T*>(data_); }
+    template <typename T>
+    const T* as() const { return static_cast<const T*>(data_); }
+
+    size_t size() const { return size_; }
+    size_t page_size() const { return page_size_; }  // 映射使用的页大小（THP 按 2 MB 计）
+    HugePageBacking backing() const { return backing_; }
+
+    // 覆盖整个缓冲区所需的页数（按 page_size() 计）
+    size_t total_pages() const { return page_size_ ? (size_ + page_size_ - 1) / page_size_ : 0; }
+
+    // 实际落在大页上的页数：hugetlb 映射全部是大页；THP 从 /proc/self/smaps 读取 AnonHugePages
+    size_t huge_pages() const {
+        switch (backing_) {
+            case HugePageBacking::HugeTLB1G:
+            case HugePageBacking::HugeTLB2M: return total_pages();
+            case HugePageBacking::Transparent: return smaps_anon_huge_kb() * 1024 / HUGE_PAGE_2M;
+            default: return 0;
+        }
+    }
+
+    // 每页写一次 0，让内核在这里完成缺页（THP 在此时才分配大页）
+    void touch() {
+        const size_t step = backing_ == HugePageBacking::Heap ? 4096 : page_size_;
+        char* p = static_cast<char*>(data_);
+        for (size_t off = 0; off < size_; off += step) p[off] = 0;
+    }
+
+    std::string describe() const {
+        std::ostringstream ss;
+        ss << size_ / (1024 * 1024) << " MB, " << huge_page_backing_name(backing_) << ", huge pages " << huge_pages()
+           << " / " << (backing_ == HugePageBacking::Small || backing_ == HugePageBacking::Heap
+                            ? (size_ + HUGE_PAGE_2M - 1) / HUGE_PAGE_2M
+                            : total_pages());
+        return ss.str();
+    }
+
+private:
+#ifdef __linux__
+    bool map_hugetlb(size_t bytes, size_t page) {
+        size_t len = (bytes + page - 1) / page * page;
+        int log2_page = 0;
+        while ((size_t(1) << log2_page) < page) ++log2_page;
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+        flags |= log2_page << MAP_HUGE_SHIFT;
+#endif
+        void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (p == MAP_FAILED) return false;
+        base_ = data_ = p;
+        mapped_ = len;
+        page_size_ = page;
+        backing_ = page == HUGE_PAGE_1G ? HugePageBacking::HugeTLB1G : HugePageBacking::HugeTLB2M;
+        return true;
+    }
+
+    // 多映射 2 MB 再裁掉首尾，使起始地址按 2 MB 对齐，整段都有资格使用 THP
+    bool map_transparent(size_t bytes) {
+        size_t len = (bytes + HUGE_PAGE_2M - 1) / HUGE_PAGE_2M * HUGE_PAGE_2M;
+        void* raw = mmap(nullptr, len + HUGE_PAGE_2M, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return false;
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (start + HUGE_PAGE_2M - 1) & ~(uintptr_t(HUGE_PAGE_2M) - 1);
+        if (aligned > start) munmap(raw, aligned - start);
+        size_t tail = (start + len + HUGE_PAGE_2M) - (aligned + len);
+        if (tail > 0) munmap(reinterpret_cast<void*>(aligned + len), tail);
+        base_ = data_ = reinterpret_cast<void*>(aligned);
+        mapped_ = len;
+        page_size_ = HUGE_PAGE_2M;
+#ifdef MADV_HUGEPAGE
+        if (madvise(base_, len, MADV_HUGEPAGE) == 0) {
+            backing_ = HugePageBacking::Transparent;
+            return true;
+        }
+#endif
+        // 内核不支持 THP：保留映射，按普通页使用
+        page_size_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        backing_ = HugePageBacking::Small;
+        return true;
+    }
+
+    // no_thp：HugePagePolicy::None 的对照组，即使 THP 为 always 也保持 4 KB 页；
+    // Auto 下回退到这里的普通小缓冲区不做限制，仍按系统的 THP 设置处理
+    bool map_small(size_t bytes, bool no_thp) {
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t len = (bytes + page - 1) / page * page;
+        void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return false;
+#ifdef MADV_NOHUGEPAGE
+        if (no_thp) madvise(p, len, MADV_NOHUGEPAGE);
+#else
+        (void)no_thp;
+#endif
+        base_ = data_ = p;
+        mapped_ = len;
+        page_size_ = page;
+        backing_ = HugePageBacking::Small;
+        return true;
+    }
+#endif
+
+    // 累加 /proc/self/smaps 中与本缓冲区重叠的映射的 AnonHugePages（kB）
+    size_t smaps_anon_huge_kb() const {
+        std::ifstream smaps("/proc/self/smaps");
+        if (!smaps) return 0;
+        const uintptr_t lo = reinterpret_cast<uintptr_t>(base_), hi = lo + mapped_;
+        bool inside = false;
+        size_t kb = 0;
+        std::string line;
+        while (std::getline(smaps, line)) {
+            uintptr_t start = 0, end = 0;
+            char dash = 0;
+            std::istringstream head(line);
+            // 映射头部形如 "7f1c00000000-7f1c40000000 rw-p ..."
+            if (head >> std::hex >> start >> dash >> end && dash == '-') {
+                inside = start < hi && end > lo;
+                continue;
+            }
+            if (inside && line.compare(0, 14, "AnonHugePages:") == 0) kb += std::stoull(line.substr(14));
+        }
+        return kb;
+    }
+
+    void reset() {
+        if (!base_) return;
+#ifdef __linux__
+        if (backing_ != HugePageBacking::Heap) {
+            munmap(base_, mapped_);
+        } else
+#endif
+        {
+            std::free(base_);
+        }
+        base_ = data_ = nullptr;
+        size_ = mapped_ = 0;
+    }
+
+    void swap(HugePageBuffer& o) noexcept {
+        std::swap(base_, o.base_);
+        std::swap(data_, o.data_);
+        std::swap(size_, o.size_);
+        std::swap(mapped_, o.mapped_);
+        std::swap(page_size_, o.page_size_);
+        std::swap(backing_, o.backing_);
+    }
+
+    void* base_ = nullptr;   // munmap / free 的起点
+    void* data_ = nullptr;
+    size_t size_ = 0;        // 请求的字节数
+    size_t mapped_ = 0;      // 实际映射的字节数
+    size_t page_size_ = 0;
+    HugePageBacking backing_ = HugePageBacking::Heap;
+};
+
+// 定长数组视图：把 HugePageBuffer 当成 T[n] 使用，data() 可直接交给 gemm/ 与 tilesize/ 中的内核
+template <typename T>
+class HugePageArray {
+    static_assert(std::is_trivially_copyable<T>::value, "HugePageArray does not run constructors");
+
+public:
+    HugePageArray() = default;
+    explicit HugePageArray(size_t n, HugePagePolicy policy = HugePagePolicy::Auto)
+        : buf_(n * sizeof(T), policy), n_(n) {}
+
+    T* data() { return buf_.as<T>(); }
+    const T* data() const { return buf_.as<T>(); }
+    size_t size() const { return n_; }
+    T& operator[](size_t i) { return data()[i]; }
+    const T& operator[](size_t i) const { return data()[i]; }
+    T* begin() { return data(); }
+    T* end() { return data() + n_; }
+
+    HugePageBuffer& buffer() { return buf_; }
+    const HugePageBuffer& buffer() const { return buf_; }
+
+private:
+    HugePageBuffer buf_;
+    size_t n_ = 0;
+};
+
+#endif // HUGE_PAGE_BUFFER_H
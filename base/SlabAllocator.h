@@ -0,0 +1,300 @@
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// 按大小分级的对齐 slab 分配器，带线程本地缓存（thread-caching）。
+//
+// 分块 / 打包缓冲区在每次 GEMM 调用时申请、释放，直接走 aligned_alloc 时：
+//   - 大块内存每次都经过 mmap / munmap，页面要重新缺页清零
+//   - 多线程同时调用时在 malloc 的锁上排队
+// 这里把请求向上取到 2 的幂的大小级（64 B ~ 4 MB），同级的空闲块用侵入式单链表串起来：
+//   - 每个线程有自己的空闲链表，分配 / 释放在本线程内完成，不加锁
+//   - 线程缓存为空时从全局链表批量取一批，超过上限时批量还回，全局链表由互斥锁保护
+//   - 全局链表也为空时向系统申请一整块 slab 切成若干块
+// 对齐：slab 按 4096 字节对齐，块按自身大小切分，所以每块至少对齐到 min(块大小, 4096)，且不小于 64。
+// 超过最大级或对齐要求超过 4096 的请求直接走 aligned_alloc / free，不进缓存：
+// 大块若也取整到 2 的幂并一直留在链表里，33 MB 的请求会占住 64 MB 直到进程退出。
+// 释放时需要给出申请时的大小（pmr::memory_resource 与 std::allocator 的接口本来就会给），块内没有头部。
+// slab 只在进程退出时由系统回收：这是缓存型分配器的常见取舍，换来热路径上没有系统调用；
+// 最大级限制在 4 MB，缓存住的内存量因此有界。
+
+constexpr size_t SLAB_MIN_BLOCK = 64;                 // 最小块，也是最小对齐
+constexpr size_t SLAB_MAX_BLOCK = size_t(4) << 20;    // 最大块 4 MB，更大的请求直接向系统申请
+constexpr size_t SLAB_PAGE = 4096;                    // slab 对齐
+constexpr size_t SLAB_CHUNK = size_t(256) << 10;      // 小块一次向系统申请 256 KB
+constexpr int SLAB_NUM_CLASSES = 17;                  // 64 B, 128 B, ..., 4 MB
+static_assert((SLAB_MIN_BLOCK << (SLAB_NUM_CLASSES - 1)) == SLAB_MAX_BLOCK, "size class table mismatch");
+
+// 分配统计（全部线程累计）
+struct SlabStats {
+    size_t system_allocs;   // 向系统申请 slab / 大块的次数
+    size_t system_bytes;    // 向系统申请的总字节数
+    size_t central_fetches; // 线程缓存从全局链表批量取块的次数
+    size_t central_returns; // 线程缓存批量还回全局链表的次数
+};
+
+class SlabHeap {
+public:
+    // 进程级实例，故意不析构：线程缓存可能在静态对象析构之后才归还内存
+    static SlabHeap& instance() {
+        static SlabHeap* heap = new SlabHeap();
+        return *heap;
+    }
+
+    // 大小级：能放下 bytes 且对齐不低于 alignment 的最小级，放不下返回 -1
+    static int size_class(size_t bytes, size_t alignment) {
+        size_t need = bytes < alignment ? alignment : bytes;
+        if (need > SLAB_MAX_BLOCK || alignment > SLAB_PAGE) return -1;
+        int c = 0;
+        while ((SLAB_MIN_BLOCK << c) < need) ++c;
+        return c;
+    }
+
+    static size_t class_size(int c) { return SLAB_MIN_BLOCK << c; }
+
+    // 线程缓存与全局链表之间一次搬运的块数：小块多搬，大块一次一块
+    static int batch_size(int c) {
+        size_t n = SLAB_CHUNK / class_size(c);
+        return n >= 32 ? 32 : (n < 1 ? 1 : static_cast<int>(n));
+    }
+
+    void* allocate(size_t bytes, size_t alignment = SLAB_MIN_BLOCK);
+    void deallocate(void* p, size_t bytes, size_t alignment = SLAB_MIN_BLOCK);
+
+    SlabStats stats() const {
+        return {system_allocs_.load(std::memory_order_relaxed), system_bytes_.load(std::memory_order_relaxed),
+                central_fetches_.load(std::memory_order_relaxed), central_returns_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    friend class SlabThreadCache;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Central {
+        std::mutex mutex;
+        FreeBlock* head = nullptr;
+    };
+
+    SlabHeap() = default;
+
+    void* system_alloc(size_t bytes, size_t alignment) {
+        alignment = alignment < SLAB_MIN_BLOCK ? SLAB_MIN_BLOCK : alignment;
+        bytes = (bytes + alignment - 1) / alignment * alignment;
+        void* p = std::aligned_alloc(alignment, bytes);
+        if (!p) throw std::bad_alloc();
+        system_allocs_.fetch_add(1, std::memory_order_relaxed);
+        system_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        return p;
+    }
+
+    // 从全局链表取至多 n 块串成链表返回（头、实际块数），全局链表不够时切一个新 slab
+    FreeBlock* fetch(int c, int n, int& got) {
+        central_fetches_.fetch_add(1, std::memory_order_relaxed);
+        Central& central = centrals_[c];
+        {
+            std::lock_guard<std::mutex> lock(central.mutex);
+            FreeBlock* head = central.head;
+            FreeBlock* tail = nullptr;
+            got = 0;
+            for (FreeBlock* b = head; b && got < n; b = b->next) {
+                tail = b;
+                ++got;
+            }
+            if (got > 0) {
+                central.head = tail->next;
+                tail->next = nullptr;
+                return head;
+            }
+        }
+        // 在锁外向系统申请，再把多出来的块放回全局链表
+        const size_t block = class_size(c);
+        const size_t chunk = block >= SLAB_CHUNK ? block : SLAB_CHUNK;
+        char* base = static_cast<char*>(system_alloc(chunk, SLAB_PAGE));
+        const int blocks = static_cast<int>(chunk / block);
+        for (int i = 0; i < blocks; ++i) {
+            FreeBlock* b = reinterpret_cast<FreeBlock*>(base + i * block);
+            b->next = i + 1 < blocks ? reinterpret_cast<FreeBlock*>(base + (i + 1) * block) : nullptr;
+        }
+        got = blocks < n ? blocks : n;
+        FreeBlock* head = reinterpret_cast<FreeBlock*>(base);
+        FreeBlock* tail = reinterpret_cast<FreeBlock*>(base + (got - 1) * block);
+        if (got < blocks) give_back(c, tail->next, reinterpret_cast<FreeBlock*>(base + (blocks - 1) * block), false);
+        tail->next = nullptr;
+        return head;
+    }
+
+    // 把 [head, tail] 这段链表挂回全局链表
+    void give_back(int c, FreeBlock* head, FreeBlock* tail, bool count = true) {
+        if (count) central_returns_.fetch_add(1, std::memory_order_relaxed);
+        Central& central = centrals_[c];
+        std::lock_guard<std::mutex> lock(central.mutex);
+        tail->next = central.head;
+        central.head = head;
+    }
+
+    Central centrals_[SLAB_NUM_CLASSES];
+    std::atomic<size_t> system_allocs_{0};
+    std::atomic<size_t> system_bytes_{0};
+    std::atomic<size_t> central_fetches_{0};
+    std::atomic<size_t> central_returns_{0};
+};
+
+// 线程本地缓存：每级一个空闲链表，线程退出时全部还回全局链表
+class SlabThreadCache {
+public:
+    static SlabThreadCache& get() {
+        static thread_local SlabThreadCache cache;
+        return cache;
+    }
+
+    // 线程缓存是否已析构：线程退出（或 main 返回）后仍可能有容器释放内存，此时直接走全局链表
+    static bool destroyed() { return destroyed_flag(); }
+
+    void* allocate(int c) {
+        List& list = lists_[c];
+        if (!list.head) {
+            int got = 0;
+            list.head = SlabHeap::instance().fetch(c, SlabHeap::batch_size(c), got);
+            list.count = got;
+        }
+        SlabHeap::FreeBlock* b = list.head;
+        list.head = b->next;
+        --list.count;
+        return b;
+    }
+
+    void deallocate(void* p, int c) {
+        List& list = lists_[c];
+        SlabHeap::FreeBlock* b = static_cast<SlabHeap::FreeBlock*>(p);
+        b->next = list.head;
+        list.head = b;
+        // 超过两批时还回一批，避免一个线程释放、另一个线程申请时内存全部滞留在释放线程
+        const int batch = SlabHeap::batch_size(c);
+        if (++list.count > 2 * batch) release(c, batch);
+    }
+
+    SlabThreadCache(const SlabThreadCache&) = delete;
+    SlabThreadCache& operator=(const SlabThreadCache&) = delete;
+
+private:
+    struct List {
+        SlabHeap::FreeBlock* head = nullptr;
+        int count = 0;
+    };
+
+    SlabThreadCache() = default;
+
+    ~SlabThreadCache() {
+        for (int c = 0; c < SLAB_NUM_CLASSES; ++c)
+            if (lists_[c].count > 0) release(c, lists_[c].count);
+        destroyed_flag() = true;
+    }
+
+    // 平凡类型的 thread_local 没有析构，线程缓存析构之后仍可读
+    static bool& destroyed_flag() {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+    // 把链表头部的 n 块还回全局链表
+    void release(int c, int n) {
+        List& list = lists_[c];
+        SlabHeap::FreeBlock* head = list.head;
+        SlabHeap::FreeBlock* tail = head;
+        for (int i = 1; i < n; ++i) tail = tail->next;
+        list.head = tail->next;
+        list.count -= n;
+        SlabHeap::instance().give_back(c, head, tail);
+    }
+
+    List lists_[SLAB_NUM_CLASSES];
+};
+
+inline void* SlabHeap::allocate(size_t bytes, size_t alignment) {
+    if (bytes == 0) bytes = 1;
+    int c = size_class(bytes, alignment);
+    if (c < 0) return system_alloc(bytes, alignment);
+    if (SlabThreadCache::destroyed()) {
+        int got = 0;
+        return fetch(c, 1, got);
+    }
+    return SlabThreadCache::get().allocate(c);
+}
+
+inline void SlabHeap::deallocate(void* p, size_t bytes, size_t alignment) {
+    if (!p) return;
+    if (bytes == 0) bytes = 1;
+    int c = size_class(bytes, alignment);
+    if (c < 0) {
+        std::free(p);
+        return;
+    }
+    if (SlabThreadCache::destroyed()) {
+        FreeBlock* b = static_cast<FreeBlock*>(p);
+        give_back(c, b, b);
+        return;
+    }
+    SlabThreadCache::get().deallocate(p, c);
+}
+
+// 便捷入口：至少 64 字节对齐
+inline void* slab_alloc(size_t bytes, size_t alignment = SLAB_MIN_BLOCK) {
+    return SlabHeap::instance().allocate(bytes, alignment);
+}
+
+inline void slab_free(void* p, size_t bytes, size_t alignment = SLAB_MIN_BLOCK) {
+    SlabHeap::instance().deallocate(p, bytes, alignment);
+}
+
+// std::pmr 接口：可用于 std::pmr::vector 等容器，或作为 monotonic_buffer_resource 的上游
+class SlabMemoryResource : public std::pmr::memory_resource {
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override { return slab_alloc(bytes, alignment); }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override { slab_free(p, bytes, alignment); }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return dynamic_cast<const SlabMemoryResource*>(&other) != nullptr;  // 所有实例共用同一个堆
+    }
+};
+
+inline SlabMemoryResource* slab_resource() {
+    static SlabMemoryResource resource;
+    return &resource;
+}
+
+// 标准分配器：std::vector<float, SlabAllocator<float>> 的数据至少 64 字节对齐
+template <typename T>
+struct SlabAllocator {
+    using value_type = T;
+
+    SlabAllocator() noexcept = default;
+    template <typename U>
+    SlabAllocator(const SlabAllocator<U>&) noexcept {}
+
+    static constexpr size_t alignment() { return alignof(T) > SLAB_MIN_BLOCK ? alignof(T) : SLAB_MIN_BLOCK; }
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) throw std::bad_array_new_length();
+        return static_cast<T*>(slab_alloc(n * sizeof(T), alignment()));
+    }
+    void deallocate(T* p, size_t n) noexcept { slab_free(p, n * sizeof(T), alignment()); }
+
+    template <typename U>
+    bool operator==(const SlabAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const SlabAllocator<U>&) const noexcept { return false; }
+};
+
+using AlignedFloatVector = std::vector<float, SlabAllocator<float>>;
+
+#endif // SLAB_ALLOCATOR_H
@@ -1,54 +1,81 @@
+#include <chrono>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <thread>
+#include <vector>
 
+#include "SlabAllocator.h"
 
+/*
+编译：g++ -O2 -std=c++17 -pthread aligned_auto.cpp -o aligned_auto
+执行：./aligned_auto
+*/
 
+// 按请求大小选择对齐（不超过 2048），内存来自 slab 分配器：
+// 同一大小级的块在本线程内复用，不再每次调用 aligned_alloc，也不在每次分配时打印
 void* auto_aligned_alloc(size_t len) {
-    size_t alignment = 32;
-    if (len <= 8) {
-        alignment = 8;
-    } else if (len <= 16) {
-        alignment = 16;
-    } else if (len <= 32) {
-        alignment = 32;
-    } else if (len <= 64) {
-        alignment = 64;
-    } else if (len <= 128) {
-        alignment = 128;
-    } else if (len <= 256) {
-        alignment = 256;
-    } else if (len <= 512) {
-        alignment = 512;
-    } else if (len <= 1024) {
-        alignment = 1024;
-    } else {
-        alignment = 2048;
-    }
-    size_t adjusted_size = (len + alignment - 1) & ~(alignment - 1);
-    void* ptr = std::aligned_alloc(alignment, adjusted_size);
-    if (ptr == nullptr) {
-        std::cerr << "Memory allocation failed" << std::endl;
-        return nullptr;
+    size_t alignment = SLAB_MIN_BLOCK;
+    while (alignment < len && alignment < 2048) alignment <<= 1;
+    return slab_alloc(len, alignment);
+}
+
+// 释放时需要给出申请时的长度，用来找回大小级
+void auto_aligned_free(void* ptr, size_t len) {
+    size_t alignment = SLAB_MIN_BLOCK;
+    while (alignment < len && alignment < 2048) alignment <<= 1;
+    slab_free(ptr, len, alignment);
+}
+
+// 多线程反复申请、释放打包缓冲区大小的内存，对比 aligned_alloc / free
+template <typename Alloc, typename Free>
+double bench(int threads, int iters, size_t bytes, Alloc alloc, Free free_fn) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&] {
+            for (int i = 0; i < iters; ++i) {
+                void* p = alloc(bytes);
+                static_cast<char*>(p)[0] = 1;  // 触碰首页
+                static_cast<char*>(p)[bytes - 1] = 1;
+                free_fn(p, bytes);
+            }
+        });
     }
-    std::cout << "Memory allocated at: " << ptr << std::endl;
-    return ptr;
+    for (auto& th : pool) th.join();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / (double(threads) * iters);
 }
 
 int main() {
     size_t len = 1000; // 需要分配的内存大小
     void* ptr = auto_aligned_alloc(len);
     if (ptr != nullptr) {
-        // 使用分配的内存
-        std::cout << "Memory allocated successfully." << std::endl;
-        // 释放内存
-        std::free(ptr);
+        std::cout << "Memory allocated at: " << ptr << " (alignment "
+                  << (reinterpret_cast<uintptr_t>(ptr) & -reinterpret_cast<uintptr_t>(ptr)) << ")" << std::endl;
+        std::memset(ptr, 0, len);
+        auto_aligned_free(ptr, len);
     }
+
+    // pmr 容器与 std::vector 分配器
+    std::pmr::vector<float> pv(1000, 1.0f, slab_resource());
+    AlignedFloatVector av(1000, 2.0f);
+    std::cout << "pmr::vector data: " << pv.data() << ", AlignedFloatVector data: " << av.data()
+              << (reinterpret_cast<uintptr_t>(av.data()) % 64 == 0 ? " (64B aligned)" : " (MISALIGNED)") << "\n";
+
+    const int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (size_t bytes : {size_t(4096), size_t(256) << 10, size_t(4) << 20}) {
+        double sys = bench(threads, 2000, bytes, [](size_t n) { return std::aligned_alloc(64, (n + 63) / 64 * 64); },
+                           [](void* p, size_t) { std::free(p); });
+        double slab = bench(threads, 2000, bytes, [](size_t n) { return slab_alloc(n); },
+                            [](void* p, size_t n) { slab_free(p, n); });
+        std::cout << threads << " threads, " << bytes / 1024 << " KB: aligned_alloc " << sys << " us, slab " << slab
+                  << " us per alloc/free\n";
+    }
+
+    SlabStats st = SlabHeap::instance().stats();
+    std::cout << "slab: " << st.system_allocs << " system allocations (" << st.system_bytes / (1024 * 1024)
+              << " MB), " << st.central_fetches << " central fetches, " << st.central_returns << " central returns\n";
     return 0;
 }
-// This code demonstrates how to use aligned memory allocation in C++.
-// It defines a function `auto_aligned_alloc` that automatically determines the alignment
-// based on the requested size. The main function allocates memory of a specified size
-// and then frees it after use. The code also includes error handling for memory allocation failures.
-// The `auto_aligned_alloc` function uses the `std::aligned_alloc` function to allocate memory
-// with the specified alignment. The alignment is determined based on the requested size,
\ No newline at end of file
@@ -0,0 +1,255 @@
+import argparse
+import csv
+import json
+import math
+import random
+import statistics
+import sys
+
+# 比较两次 Google Benchmark 运行（--benchmark_format=json --benchmark_out=xxx.json）。
+# 每个基准需要多次重复（--benchmark_repetitions=10）才能做统计检验：
+#   - 加速比：基线中位数 / 新版本中位数（时间类指标），或 新 / 基线（FLOP/s 等吞吐类 counter）
+#   - 置信区间：对两组样本分别有放回重采样，取中位数比值的分位数（bootstrap 百分位区间）
+#   - 显著性：Mann-Whitney U 双侧检验，样本少时用精确分布，否则用带结校正的正态近似
+# 只用标准库，不依赖 numpy / scipy。
+#
+# 用法：
+#   ./kernel_bench --benchmark_repetitions=10 --benchmark_format=json --benchmark_out=base.json
+#   （修改内核后）
+#   ./kernel_bench --benchmark_repetitions=10 --benchmark_format=json --benchmark_out=new.json
+#   python3 compare_benchmarks.py base.json new.json
+#   python3 compare_benchmarks.py base.json new.json --metric FLOP/s --csv compare.csv --fail-on-regression
+
+TIME_UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+# 读取一次运行：只取 run_type == "iteration" 的原始样本（跳过 mean / median / stddev 聚合行），
+# 按 run_name 分组。时间统一换算成 ns；其它指标取 user counter
+def load_samples(json_file, metric):
+    with open(json_file, "r") as f:
+        data = json.load(f)
+    samples = {}
+    order = []
+    for bm in data.get("benchmarks", []):
+        if bm.get("run_type", "iteration") != "iteration":
+            continue
+        if bm.get("error_occurred"):
+            continue
+        name = bm.get("run_name", bm["name"])
+        if metric in ("real_time", "cpu_time"):
+            value = float(bm[metric]) * TIME_UNITS.get(bm.get("time_unit", "ns"), 1.0)
+        elif metric in bm:
+            value = float(bm[metric])
+        else:
+            continue
+        if name not in samples:
+            samples[name] = []
+            order.append(name)
+        samples[name].append(value)
+    return samples, order
+
+
+# ---------------- Mann-Whitney U ----------------
+
+# 合并排序后的秩（相同值取平均秩），同时返回每组结的大小
+def rank_with_ties(values):
+    indexed = sorted(range(len(values)), key=lambda i: values[i])
+    ranks = [0.0] * len(values)
+    ties = []
+    i = 0
+    while i < len(indexed):
+        j = i
+        while j + 1 < len(indexed) and values[indexed[j + 1]] == values[indexed[i]]:
+            j += 1
+        avg = (i + j) / 2.0 + 1.0
+        for k in range(i, j + 1):
+            ranks[indexed[k]] = avg
+        if j > i:
+            ties.append(j - i + 1)
+        i = j + 1
+    return ranks, ties
+
+
+# 无结时 U 的精确分布：count[n1][n2][u] = 满足 U = u 的排列数，
+# 递推 f(n1, n2, u) = f(n1 - 1, n2, u - n2) + f(n1, n2 - 1, u)
+def exact_u_distribution(n1, n2):
+    table = {}
+
+    def f(a, b):
+        key = (a, b)
+        if key in table:
+            return table[key]
+        if a == 0 or b == 0:
+            dist = [1]
+        else:
+            left = f(a - 1, b)
+            right = f(a, b - 1)
+            dist = [0] * (a * b + 1)
+            for u, c in enumerate(left):
+                dist[u + b] += c
+            for u, c in enumerate(right):
+                dist[u] += c
+        table[key] = dist
+        return dist
+
+    return f(n1, n2)
+
+
+# 标准正态分布的上尾概率
+def normal_sf(z):
+    return 0.5 * math.erfc(z / math.sqrt(2.0))
+
+
+# 双侧 Mann-Whitney U 检验，返回 (U, p)
+def mann_whitney_u(x, y):
+    n1, n2 = len(x), len(y)
+    ranks, ties = rank_with_ties(list(x) + list(y))
+    r1 = sum(ranks[:n1])
+    u1 = r1 - n1 * (n1 + 1) / 2.0
+    u = min(u1, n1 * n2 - u1)
+
+    if not ties and n1 + n2 <= 30:
+        dist = exact_u_distribution(n1, n2)
+        total = float(sum(dist))
+        tail = sum(dist[: int(math.floor(u)) + 1]) / total
+        return u1, min(1.0, 2.0 * tail)
+
+    n = n1 + n2
+    mean = n1 * n2 / 2.0
+    tie_term = sum(t ** 3 - t for t in ties) / (n * (n - 1)) if n > 1 else 0.0
+    var = n1 * n2 / 12.0 * ((n + 1) - tie_term)
+    if var <= 0:
+        return u1, 1.0
+    z = (abs(u1 - mean) - 0.5) / math.sqrt(var)  # 连续性校正
+    return u1, min(1.0, 2.0 * normal_sf(max(z, 0.0)))
+
+
+# ---------------- bootstrap ----------------
+
+def percentile(sorted_values, q):
+    if not sorted_values:
+        return float("nan")
+    pos = q * (len(sorted_values) - 1)
+    lo = int(math.floor(pos))
+    hi = min(lo + 1, len(sorted_values) - 1)
+    return sorted_values[lo] + (sorted_values[hi] - sorted_values[lo]) * (pos - lo)
+
+
+# 中位数比值 num / den 的 bootstrap 百分位置信区间
+def bootstrap_ratio_ci(num, den, confidence, resamples, rng):
+    ratios = []
+    for _ in range(resamples):
+        a = statistics.median(rng.choice(num) for _ in range(len(num)))
+        b = statistics.median(rng.choice(den) for _ in range(len(den)))
+        if b > 0:
+            ratios.append(a / b)
+    ratios.sort()
+    alpha = (1.0 - confidence) / 2.0
+    return percentile(ratios, alpha), percentile(ratios, 1.0 - alpha)
+
+
+# ---------------- 比较 ----------------
+
+# 一个基准的比较结果。speedup > 1 表示新版本更快（时间更短或吞吐更高）
+def compare_one(name, base, new, higher_is_better, args, rng):
+    row = {"benchmark": name, "n_base": len(base), "n_new": len(new),
+           "base_median": statistics.median(base), "new_median": statistics.median(new)}
+    num, den = (new, base) if higher_is_better else (base, new)
+    row["speedup"] = statistics.median(num) / statistics.median(den) if statistics.median(den) > 0 else float("nan")
+
+    if len(base) < 2 or len(new) < 2:
+        row.update(ci_low=float("nan"), ci_high=float("nan"), p_value=float("nan"), verdict="need repetitions")
+        return row
+
+    row["ci_low"], row["ci_high"] = bootstrap_ratio_ci(num, den, args.confidence, args.resamples, rng)
+    _, row["p_value"] = mann_whitney_u(base, new)
+
+    # 同时满足：U 检验显著、置信区间不跨过 1、变化幅度超过阈值（排除统计显著但无实际意义的差异）
+    significant = row["p_value"] < args.alpha
+    if significant and row["ci_high"] < 1.0 and row["speedup"] < 1.0 - args.threshold:
+        row["verdict"] = "REGRESSION"
+    elif significant and row["ci_low"] > 1.0 and row["speedup"] > 1.0 + args.threshold:
+        row["verdict"] = "improvement"
+    else:
+        row["verdict"] = "no change"
+    return row
+
+
+def format_value(v):
+    if isinstance(v, float):
+        if math.isnan(v):
+            return "-"
+        if v != 0 and (abs(v) >= 1e6 or abs(v) < 1e-3):
+            return "%.3e" % v
+        return "%.4f" % v
+    return str(v)
+
+
+def print_table(rows, metric):
+    headers = ["benchmark", "n_base", "n_new", "base_median", "new_median", "speedup", "ci_low", "ci_high",
+               "p_value", "verdict"]
+    cells = [[format_value(r[h]) for h in headers] for r in rows]
+    widths = [max(len(h), *(len(c[i]) for c in cells)) if cells else len(h) for i, h in enumerate(headers)]
+    print("metric: %s" % metric)
+    print("  ".join(h.ljust(widths[i]) for i, h in enumerate(headers)))
+    print("  ".join("-" * w for w in widths))
+    for c in cells:
+        print("  ".join(c[i].ljust(widths[i]) if i in (0, 9) else c[i].rjust(widths[i]) for i in range(len(c))))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two Google Benchmark JSON runs with statistical tests")
+    parser.add_argument("baseline", help="基线运行的 JSON")
+    parser.add_argument("contender", help="新版本运行的 JSON")
+    parser.add_argument("--metric", default="real_time",
+                        help="real_time / cpu_time（越小越好），或 user counter 名如 FLOP/s、bytes/s（越大越好）")
+    parser.add_argument("--alpha", type=float, default=0.05, help="显著性水平")
+    parser.add_argument("--confidence", type=float, default=0.95, help="置信区间水平")
+    parser.add_argument("--threshold", type=float, default=0.02, help="判定回退 / 提升所需的最小相对变化")
+    parser.add_argument("--resamples", type=int, default=2000, help="bootstrap 重采样次数")
+    parser.add_argument("--seed", type=int, default=12345, help="bootstrap 随机种子（结果可复现）")
+    parser.add_argument("--filter", default="", help="只比较名字包含该子串的基准")
+    parser.add_argument("--csv", help="另存一份 CSV 汇总")
+    parser.add_argument("--fail-on-regression", action="store_true", help="存在显著回退时以退出码 1 结束")
+    args = parser.parse_args()
+
+    base, order = load_samples(args.baseline, args.metric)
+    new, _ = load_samples(args.contender, args.metric)
+    higher_is_better = args.metric not in ("real_time", "cpu_time")
+    rng = random.Random(args.seed)
+
+    rows = []
+    for name in order:
+        if name not in new or (args.filter and args.filter not in name):
+            continue
+        rows.append(compare_one(name, base[name], new[name], higher_is_better, args, rng))
+
+    missing = [n for n in order if n not in new] + [n for n in new if n not in base]
+    if not rows:
+        print("No common benchmarks with metric '%s'." % args.metric)
+        return 1
+
+    print_table(rows, args.metric)
+    regressions = [r for r in rows if r["verdict"] == "REGRESSION"]
+    improvements = [r for r in rows if r["verdict"] == "improvement"]
+    speedups = [r["speedup"] for r in rows if r["speedup"] > 0 and not math.isnan(r["speedup"])]
+    geomean = math.exp(sum(math.log(s) for s in speedups) / len(speedups)) if speedups else float("nan")
+    print("\n%d benchmarks compared: %d regressions, %d improvements, geometric-mean speedup %.4f"
+          % (len(rows), len(regressions), len(improvements), geomean))
+    if missing:
+        print("%d benchmarks present in only one run (skipped)" % len(missing))
+    if any(r["verdict"] == "need repetitions" for r in rows):
+        print("Some benchmarks have a single sample; rerun with --benchmark_repetitions=N for significance tests.")
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=list(rows[0].keys()))
+            writer.writeheader()
+            writer.writerows(rows)
+        print("Summary saved as '%s'" % args.csv)
+
+    return 1 if args.fail_on_regression and regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,402 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "../Head/PerfCounters.h"
+#include "../base/SlabAllocator.h"
+#include "../gemm/CpuFeatures.h"
+#include "../gemm/GemvBatch.h"
+#include "../gemm/GemvDispatch.h"
+#include "../gemm/GemvParallel.h"
+#include "../tilesize/GemmBlocked.h"
+#include "../tilesize/GemmParallel.h"
+#if defined(__AMX_INT8__) && defined(__AMX_BF16__)
+#include "../amx/AmxGemm.h"
+#endif
+
+/*
+kernel_bench：用 Google Benchmark 统一测量 gemm/、tilesize/、amx/ 中的 GEMV / GEMM 内核。
+每个内核在一组形状上注册，计时前先和朴素实现对比一次结果，不一致时该项报错跳过。
+counters：
+  FLOP/s   每次迭代 2*m*n（GEMV）或 2*M*N*K（GEMM）次浮点运算
+  bytes/s  每次迭代必须搬运的字节数（各操作数读一次、输出读写各一次），GEMV 应接近内存带宽
+  cycles / instructions / IPC / l1d_misses / llc_misses / dtlb_misses / fp_ops / page_faults
+           Head/PerfCounters.h 读出的每次迭代平均值（只统计调用线程）；perf 不可用时不输出
+
+编译：
+g++ -O3 -march=native -std=c++17 -pthread kernel_bench.cpp -o kernel_bench -lbenchmark -lpthread
+（不支持 AMX 的机器上 -march=native 不会定义 __AMX_INT8__，AMX 内核自动不注册）
+执行：
+./kernel_bench
+./kernel_bench --benchmark_filter=gemv --benchmark_repetitions=5 --benchmark_report_aggregates_only=true
+./kernel_bench --benchmark_format=json --benchmark_out=kernel_bench.json
+*/
+
+namespace {
+
+// ---------------- 参考实现 ----------------
+
+// 与 main_gemv_parallel.cpp 相同的朴素 GEMV
+void gemv_naive(float alpha, const float* A, const float* x, float beta, float* y, int m, int n) {
+    for (int i = 0; i < m; ++i) {
+        float sum = 0.0f;
+        for (int j = 0; j < n; ++j) sum += A[static_cast<size_t>(i) * n + j] * x[j];
+        y[i] = alpha * sum + beta * y[i];
+    }
+}
+
+// 朴素 GEMM：C += A * B（i-k-j 顺序，只为在大尺寸上也能较快得到参考结果）
+void gemm_naive(const float* A, const float* B, float* C, int M, int N, int K) {
+    for (int i = 0; i < M; ++i)
+        for (int k = 0; k < K; ++k) {
+            float a = A[static_cast<size_t>(i) * K + k];
+            for (int j = 0; j < N; ++j) C[static_cast<size_t>(i) * N + j] += a * B[static_cast<size_t>(k) * N + j];
+        }
+}
+
+template <typename T>
+bool close_enough(const T* got, const T* ref, size_t n, double rel_tol) {
+    for (size_t i = 0; i < n; ++i) {
+        double r = static_cast<double>(ref[i]), g = static_cast<double>(got[i]);
+        if (std::fabs(g - r) > rel_tol * std::max(1.0, std::fabs(r))) return false;
+    }
+    return true;
+}
+
+void fill(AlignedFloatVector& v, uint32_t seed) {
+    // 线性同余，取值在 [-1, 1)，不依赖 <random> 的实现保证跨平台结果一致
+    for (float& f : v) {
+        seed = seed * 1664525u + 1013904223u;
+        f = static_cast<float>(seed >> 8) / static_cast<float>(1u << 23) - 1.0f;
+    }
+}
+
+ThreadPool& bench_pool() {
+    static ThreadPool pool(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+    return pool;
+}
+
+void set_counters(benchmark::State& state, double flops, double bytes) {
+    state.counters["FLOP/s"] = benchmark::Counter(flops, benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["bytes/s"] = benchmark::Counter(bytes, benchmark::Counter::kIsIterationInvariantRate,
+                                                   benchmark::Counter::OneK::kIs1024);
+}
+
+// 硬件计数器：计时循环期间的总数按迭代平均；perf 不可用时什么也不加
+void add_perf_counters(benchmark::State& state, const PerfSample& s) {
+    for (int e = 0; e < PERF_NUM_EVENTS; ++e)
+        if (s.valid[e])
+            state.counters[perf_event_name(e)] = benchmark::Counter(s.value[e], benchmark::Counter::kAvgIterations);
+    if (s.valid[PERF_CYCLES] && s.valid[PERF_INSTRUCTIONS]) state.counters["IPC"] = s.ipc();
+    if (s.valid[PERF_FP_SCALAR]) state.counters["fp_ops"] = benchmark::Counter(s.flops(), benchmark::Counter::kAvgIterations);
+}
+
+// ---------------- GEMV ----------------
+
+// 一个形状的输入与参考结果，按形状缓存，所有内核共用
+struct GemvCase {
+    int m, n;
+    AlignedFloatVector A, x, y_ref;
+
+    GemvCase(int m_, int n_) : m(m_), n(n_), A(static_cast<size_t>(m_) * n_), x(n_), y_ref(m_, 0.0f) {
+        fill(A, 1u + m_ * 31u + n_);
+        fill(x, 7u + n_);
+        gemv_naive(1.0f, A.data(), x.data(), 0.0f, y_ref.data(), m, n);
+    }
+
+    static const GemvCase& get(int m, int n) {
+        static std::map<std::pair<int, int>, GemvCase> cache;
+        auto it = cache.find({m, n});
+        if (it == cache.end()) it = cache.emplace(std::piecewise_construct, std::forward_as_tuple(m, n),
+                                                  std::forward_as_tuple(m, n)).first;
+        return it->second;
+    }
+};
+
+// 每个内核统一成 y = A * x（alpha = 1，beta = 0）
+using GemvRunner = std::function<void(const GemvCase&, float* y)>;
+
+void BM_gemv(benchmark::State& state, GemvRunner run) {
+    const int m = static_cast<int>(state.range(0)), n = static_cast<int>(state.range(1));
+    const GemvCase& c = GemvCase::get(m, n);
+    AlignedFloatVector y(m, 0.0f);
+
+    run(c, y.data());
+    if (!close_enough(y.data(), c.y_ref.data(), y.size(), 1e-4)) {
+        state.SkipWithError("result mismatch vs gemv_naive");
+        return;
+    }
+    PerfCounters& perf = PerfCounters::get();
+    PerfSnapshot perf_begin = perf.start();
+    for (auto _ : state) {
+        run(c, y.data());
+        benchmark::DoNotOptimize(y.data());
+        benchmark::ClobberMemory();
+    }
+    add_perf_counters(state, perf.stop(perf_begin));
+    set_counters(state, 2.0 * m * n, (static_cast<double>(m) * n + n + 2.0 * m) * sizeof(float));
+}
+
+GemvRunner gemv_fn(GemvFn fn) {
+    return [fn](const GemvCase& c, float* y) { fn(c.A.data(), c.x.data(), y, c.m, c.n, c.n, 1.0f, 0.0f); };
+}
+
+// 批量 GEMV：b 个右端向量都取 x，每一列都应等于 y_ref
+void BM_gemv_batch(benchmark::State& state, bool parallel) {
+    const int m = static_cast<int>(state.range(0)), n = static_cast<int>(state.range(1));
+    const int b = static_cast<int>(state.range(2));
+    const GemvCase& c = GemvCase::get(m, n);
+    AlignedFloatVector X(static_cast<size_t>(n) * b), Y(static_cast<size_t>(m) * b, 0.0f);
+    for (int j = 0; j < n; ++j)
+        for (int k = 0; k < b; ++k) X[static_cast<size_t>(j) * b + k] = c.x[j];
+
+    auto run = [&] {
+        if (parallel) gemv_batch_parallel(bench_pool(), c.A.data(), X.data(), Y.data(), m, n, b);
+        else gemv_batch(c.A.data(), X.data(), Y.data(), m, n, b);
+    };
+    run();
+    for (int i = 0; i < m; ++i)
+        for (int k = 0; k < b; ++k)
+            if (!close_enough(&Y[static_cast<size_t>(i) * b + k], &c.y_ref[i], 1, 1e-4)) {
+                state.SkipWithError("result mismatch vs gemv_naive");
+                return;
+            }
+    PerfCounters& perf = PerfCounters::get();
+    PerfSnapshot perf_begin = perf.start();
+    for (auto _ : state) {
+        run();
+        benchmark::DoNotOptimize(Y.data());
+        benchmark::ClobberMemory();
+    }
+    add_perf_counters(state, perf.stop(perf_begin));
+    set_counters(state, 2.0 * m * n * b, (static_cast<double>(m) * n + static_cast<double>(n) * b + 2.0 * m * b) *
+                                             sizeof(float));
+}
+
+// ---------------- GEMM ----------------
+
+struct GemmCase {
+    int M, N, K;
+    AlignedFloatVector A, B, C_ref;
+
+    GemmCase(int M_, int N_, int K_)
+        : M(M_), N(N_), K(K_), A(static_cast<size_t>(M_) * K_), B(static_cast<size_t>(K_) * N_),
+          C_ref(static_cast<size_t>(M_) * N_, 0.0f) {
+        fill(A, 3u + M_ * 17u + K_);
+        fill(B, 5u + K_ * 13u + N_);
+        gemm_naive(A.data(), B.data(), C_ref.data(), M, N, K);
+    }
+
+    static const GemmCase& get(int M, int N, int K) {
+        static std::map<std::tuple<int, int, int>, GemmCase> cache;
+        auto key = std::make_tuple(M, N, K);
+        auto it = cache.find(key);
+        if (it == cache.end()) it = cache.emplace(std::piecewise_construct, std::forward_as_tuple(key),
+                                                  std::forward_as_tuple(M, N, K)).first;
+        return it->second;
+    }
+};
+
+// C += A * B，C 由调用方清零（计时循环内不清零，只累加）
+using GemmRunner = std::function<void(const GemmCase&, float* C, const TileSize& ts)>;
+
+void BM_gemm(benchmark::State& state, GemmRunner run) {
+    const int M = static_cast<int>(state.range(0)), N = static_cast<int>(state.range(1));
+    const int K = static_cast<int>(state.range(2));
+    const GemmCase& c = GemmCase::get(M, N, K);
+    static const CacheConfig cache;
+    const TileSize ts = TileSizeCalculator(cache).compute(M, N, K);
+    AlignedFloatVector C(static_cast<size_t>(M) * N, 0.0f);
+
+    run(c, C.data(), ts);
+    // 各内核的累加顺序不同（FMA、分块），误差随 K 增长
+    if (!close_enough(C.data(), c.C_ref.data(), C.size(), 1e-5 * std::sqrt(double(K)) + 1e-5)) {
+        state.SkipWithError("result mismatch vs gemm_naive");
+        return;
+    }
+    PerfCounters& perf = PerfCounters::get();
+    PerfSnapshot perf_begin = perf.start();
+    for (auto _ : state) {
+        run(c, C.data(), ts);
+        benchmark::DoNotOptimize(C.data());
+        benchmark::ClobberMemory();
+    }
+    add_perf_counters(state, perf.stop(perf_begin));
+    set_counters(state, 2.0 * M * N * K,
+                 (static_cast<double>(M) * K + static_cast<double>(K) * N + 2.0 * M * N) * sizeof(float));
+}
+
+#if defined(__AMX_INT8__) && defined(__AMX_BF16__)
+// AMX int8：C(int32) = A(int8) * B(int8)，与整数参考逐个比较
+void BM_amx_s8(benchmark::State& state) {
+    const int M = static_cast<int>(state.range(0)), N = static_cast<int>(state.range(1));
+    const int K = static_cast<int>(state.range(2));
+    std::vector<int8_t> A(static_cast<size_t>(M) * K), B(static_cast<size_t>(K) * N);
+    std::vector<int32_t> C(static_cast<size_t>(M) * N), C_ref(static_cast<size_t>(M) * N, 0);
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<int8_t>((i * 37 + 11) % 255 - 127);
+    for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<int8_t>((i * 53 + 7) % 255 - 127);
+    for (int i = 0; i < M; ++i)
+        for (int k = 0; k < K; ++k)
+            for (int j = 0; j < N; ++j)
+                C_ref[static_cast<size_t>(i) * N + j] +=
+                    int32_t(A[static_cast<size_t>(i) * K + k]) * int32_t(B[static_cast<size_t>(k) * N + j]);
+
+    if (!amx_gemm_s8s8s32(A.data(), B.data(), C.data(), M, N, K)) {
+        state.SkipWithError("AMX not available");
+        return;
+    }
+    if (C != C_ref) {
+        state.SkipWithError("result mismatch vs scalar int8 reference");
+        return;
+    }
+    PerfCounters& perf = PerfCounters::get();
+    PerfSnapshot perf_begin = perf.start();
+    AmxPhase phase;  // 计时循环内保持 tile 配置，不在每次迭代重新 LDTILECFG
+    for (auto _ : state) {
+        amx_gemm_s8s8s32(A.data(), B.data(), C.data(), M, N, K);
+        benchmark::DoNotOptimize(C.data());
+        benchmark::ClobberMemory();
+    }
+    add_perf_counters(state, perf.stop(perf_begin));
+    set_counters(state, 2.0 * M * N * K,
+                 static_cast<double>(M) * K + static_cast<double>(K) * N + 2.0 * M * N * sizeof(int32_t));
+}
+
+// AMX bf16：输入取 GemmCase 的 fp32 数据舍入到 bf16，参考结果按舍入后的值重新计算
+void BM_amx_bf16(benchmark::State& state) {
+    const int M = static_cast<int>(state.range(0)), N = static_cast<int>(state.range(1));
+    const int K = static_cast<int>(state.range(2));
+    const GemmCase& c = GemmCase::get(M, N, K);
+    std::vector<amx_bf16_t> A(c.A.size()), B(c.B.size());
+    AlignedFloatVector Af(c.A.size()), Bf(c.B.size()), C(static_cast<size_t>(M) * N), C_ref(C.size(), 0.0f);
+    for (size_t i = 0; i < A.size(); ++i) Af[i] = amx_bf16_to_float(A[i] = amx_float_to_bf16(c.A[i]));
+    for (size_t i = 0; i < B.size(); ++i) Bf[i] = amx_bf16_to_float(B[i] = amx_float_to_bf16(c.B[i]));
+    gemm_naive(Af.data(), Bf.data(), C_ref.data(), M, N, K);
+
+    if (!amx_gemm_bf16(A.data(), B.data(), C.data(), M, N, K)) {
+        state.SkipWithError("AMX not available");
+        return;
+    }
+    if (!close_enough(C.data(), C_ref.data(), C.size(), 1e-5 * std::sqrt(double(K)) + 1e-5)) {
+        state.SkipWithError("result mismatch vs gemm_naive");
+        return;
+    }
+    PerfCounters& perf = PerfCounters::get();
+    PerfSnapshot perf_begin = perf.start();
+    AmxPhase phase;  // 计时循环内保持 tile 配置，不在每次迭代重新 LDTILECFG
+    for (auto _ : state) {
+        amx_gemm_bf16(A.data(), B.data(), C.data(), M, N, K);
+        benchmark::DoNotOptimize(C.data());
+        benchmark::ClobberMemory();
+    }
+    add_perf_counters(state, perf.stop(perf_begin));
+    set_counters(state, 2.0 * M * N * K,
+                 (static_cast<double>(M) * K + static_cast<double>(K) * N) * sizeof(amx_bf16_t) +
+                     2.0 * M * N * sizeof(float));
+}
+#endif
+
+// ---------------- 注册 ----------------
+
+// GEMV 形状：方阵（含非 8 倍数）、瘦高、矮宽，最大的 A 为 64 MB，超出 L3 之外的部分测的是内存带宽
+const std::vector<std::vector<int64_t>> kGemvShapes = {
+    {256, 256}, {1000, 1000}, {1024, 1024}, {4096, 4096}, {16384, 256}, {256, 16384}};
+const std::vector<int64_t> kGemmSizes = {64, 128, 256, 512, 1024};
+
+void apply_gemv_shapes(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"m", "n"});
+    for (const auto& s : kGemvShapes) b->Args(s);
+}
+
+void apply_gemm_shapes(benchmark::internal::Benchmark* b, int64_t max_size) {
+    b->ArgNames({"M", "N", "K"});
+    for (int64_t s : kGemmSizes)
+        if (s <= max_size) b->Args({s, s, s});
+    b->Args({std::min<int64_t>(max_size, 1000), 37, 4099});  // 非对齐的瘦长形状
+    b->Unit(benchmark::kMillisecond);
+}
+
+void register_kernels() {
+    const CpuFeatures& cpu = CpuFeatures::get();
+
+    // GEMV：各 ISA 的单线程内核、运行时分派入口、线程池并行版本
+    benchmark::RegisterBenchmark("gemv/scalar_unrolled", BM_gemv, gemv_fn(gemv_scalar_unrolled))
+        ->Apply(apply_gemv_shapes);
+    if (cpu.sse4_1)
+        benchmark::RegisterBenchmark("gemv/sse4", BM_gemv, gemv_fn(gemv_masked_sse4))->Apply(apply_gemv_shapes);
+    if (cpu.avx2 && cpu.fma)
+        benchmark::RegisterBenchmark("gemv/avx2", BM_gemv, gemv_fn(gemv_masked_avx2))->Apply(apply_gemv_shapes);
+    if (cpu.avx512f)
+        benchmark::RegisterBenchmark("gemv/avx512", BM_gemv, gemv_fn(gemv_masked_avx512))->Apply(apply_gemv_shapes);
+    benchmark::RegisterBenchmark("gemv/dispatch", BM_gemv, GemvRunner([](const GemvCase& c, float* y) {
+                                     gemv(c.A.data(), c.x.data(), y, c.m, c.n, c.n, 1.0f, 0.0f);
+                                 }))
+        ->Apply(apply_gemv_shapes);
+    benchmark::RegisterBenchmark("gemv/parallel", BM_gemv, GemvRunner([](const GemvCase& c, float* y) {
+                                     // 分片只依赖形状，按形状缓存一个引擎
+                                     static std::map<std::pair<int, int>, GemvParallel> engines;
+                                     auto it = engines.find({c.m, c.n});
+                                     if (it == engines.end())
+                                         it = engines.emplace(std::piecewise_construct,
+                                                              std::forward_as_tuple(c.m, c.n),
+                                                              std::forward_as_tuple(bench_pool(), c.m, c.n, c.n))
+                                                  .first;
+                                     it->second(c.A.data(), c.x.data(), y, 1.0f, 0.0f);
+                                 }))
+        ->Apply(apply_gemv_shapes)
+        ->UseRealTime();
+
+    // 批量 GEMV：16 个右端向量
+    for (bool parallel : {false, true}) {
+        auto* b = benchmark::RegisterBenchmark(parallel ? "gemv_batch/parallel" : "gemv_batch/single",
+                                               BM_gemv_batch, parallel);
+        b->ArgNames({"m", "n", "b"});
+        for (const auto& s : kGemvShapes) b->Args({s[0], s[1], 16});
+        if (parallel) b->UseRealTime();
+    }
+
+    // GEMM：标量分块版本较慢，只测到 512
+    benchmark::RegisterBenchmark("gemm/blocked", BM_gemm, GemmRunner([](const GemmCase& c, float* C, const TileSize& ts) {
+                                     gemm_blocked(c.A.data(), c.B.data(), C, c.M, c.N, c.K, ts);
+                                 }))
+        ->Apply([](benchmark::internal::Benchmark* b) { apply_gemm_shapes(b, 512); });
+    benchmark::RegisterBenchmark("gemm/packed", BM_gemm, GemmRunner([](const GemmCase& c, float* C, const TileSize& ts) {
+                                     static const CacheConfig cache;
+                                     gemm_packed(c.A.data(), c.B.data(), C, c.M, c.N, c.K, ts, cache);
+                                 }))
+        ->Apply([](benchmark::internal::Benchmark* b) { apply_gemm_shapes(b, 1024); });
+    benchmark::RegisterBenchmark("gemm/parallel", BM_gemm, GemmRunner([](const GemmCase& c, float* C, const TileSize& ts) {
+                                     static GemmParallel gemm(bench_pool());
+                                     gemm(c.A.data(), c.B.data(), C, c.M, c.N, c.K, ts);
+                                 }))
+        ->Apply([](benchmark::internal::Benchmark* b) { apply_gemm_shapes(b, 1024); })
+        ->UseRealTime();
+
+#if defined(__AMX_INT8__) && defined(__AMX_BF16__)
+    if (cpu.amx_int8 && cpu.amx_bf16) {
+        for (auto* b : {benchmark::RegisterBenchmark("amx/s8s8s32", BM_amx_s8),
+                        benchmark::RegisterBenchmark("amx/bf16", BM_amx_bf16)}) {
+            b->Apply([](benchmark::internal::Benchmark* bb) { apply_gemm_shapes(bb, 1024); });
+        }
+    }
+#endif
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    register_kernels();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -2,85 +2,264 @@
 #include <memory>
 #include <array>
 #include <vector>
+#include <stdexcept>
 #include <Eigen/Dense>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+// 编译：g++ -O2 -std=c++17 -I/usr/include/eigen3 tensorTile.cpp -o tensorTile
+//
+// Tile 返回与父张量共享缓冲区的视图，只改形状 / 步长 / 偏移，不分配也不拷贝：
+//   8x8 行优先，步长 (8, 1)
+//   Tile(4, 1)  -> 形状 (2, 8, 4, 1)        步长 (32, 1, 8, 1)       前半是块网格，后半是块内坐标
+//   Tile(2, 1)  -> 形状 (2, 8, 2, 1, 2, 1)  步长 (32, 1, 16, 1, 8, 1) 只切分最内层的块维，多级切分合并成一条步长向量
+// 形状、步长等都放在最大秩固定的 Eigen 向量里（存储在栈上），每级切分都没有堆分配。
+// At(i, j) 固定前面的块网格坐标得到单个块；Map<R>() 把当前视图表示成根缓冲区 TensorMap 上的 slice 表达式，
+// 可以直接参与 Eigen 的张量运算。视图与根张量共享同一个 shared_ptr，根张量先析构时视图仍然有效。
+
+constexpr int kMaxRank = 16;
 
 class TensorType {
 public:
-    using VectorXi64 = Eigen::Matrix<int64_t, -1, 1>;
+    using VectorXi64 = Eigen::Matrix<int64_t, Eigen::Dynamic, 1, 0, kMaxRank, 1>;
+
+    TensorType() = default;
+
+    // 根类型：行优先连续存储
+    explicit TensorType(const VectorXi64& shape) : shape_(shape), strides_(shape.size()), root_dim_(shape.size()) {
+        if (shape.size() > kMaxRank) throw std::invalid_argument("TensorType: rank exceeds kMaxRank");
+        int64_t s = 1;
+        for (int i = static_cast<int>(shape.size()) - 1; i >= 0; --i) {
+            strides_(i) = s;
+            root_dim_(i) = i;
+            s *= shape(i);
+        }
+        root_shape_ = shape;
+        root_strides_ = strides_;
+        origin_ = VectorXi64::Zero(shape.size());
+    }
+
+    // 把 base 的最后 tile.size() 维按 tile 切分：每维 d 拆成 (d / t, 步长 s * t) 的块网格维和 (t, 步长 s) 的块内维，
+    // 块网格维放在前面、块内维放在最后，所以对结果再次 Tile 时切分的仍然是最内层的块
+    static TensorType Create(const TensorType& base, const VectorXi64& tile) {
+        const int rank = static_cast<int>(base.shape_.size());
+        const int k = static_cast<int>(tile.size());
+        if (k == 0 || k > rank) throw std::invalid_argument("Tile: number of tile dims must be in [1, rank]");
+        if (rank + k > kMaxRank) throw std::invalid_argument("Tile: resulting rank exceeds kMaxRank");
 
-    TensorType(const VectorXi64& shape) : shape_(shape) {}
+        TensorType t;
+        t.root_shape_ = base.root_shape_;
+        t.root_strides_ = base.root_strides_;
+        t.origin_ = base.origin_;
+        t.shape_.resize(rank + k);
+        t.strides_.resize(rank + k);
+        t.root_dim_.resize(rank + k);
+        const int lead = rank - k;
+        for (int i = 0; i < lead; ++i) {
+            t.shape_(i) = base.shape_(i);
+            t.strides_(i) = base.strides_(i);
+            t.root_dim_(i) = base.root_dim_(i);
+        }
+        for (int j = 0; j < k; ++j) {
+            const int64_t d = base.shape_(lead + j), ts = tile(j);
+            if (ts <= 0 || d % ts != 0) throw std::invalid_argument("Tile: tile size must divide the dimension");
+            t.shape_(lead + j) = d / ts;
+            t.strides_(lead + j) = base.strides_(lead + j) * ts;
+            t.root_dim_(lead + j) = base.root_dim_(lead + j);
+            t.shape_(rank + j) = ts;
+            t.strides_(rank + j) = base.strides_(lead + j);
+            t.root_dim_(rank + j) = base.root_dim_(lead + j);
+        }
+        return t;
+    }
 
-    static std::shared_ptr<TensorType> Create(std::shared_ptr<TensorType> base, const VectorXi64& shape) {
-        return std::make_shared<TensorType>(shape);
+    // 固定前 idx.size() 维的坐标，返回剩余维度的类型；偏移记录在根坐标 origin_ 中
+    TensorType Fix(const VectorXi64& idx) const {
+        const int rank = static_cast<int>(shape_.size());
+        const int n = static_cast<int>(idx.size());
+        if (n > rank) throw std::invalid_argument("At: too many indices");
+        TensorType t = *this;
+        for (int i = 0; i < n; ++i) {
+            if (idx(i) < 0 || idx(i) >= shape_(i)) throw std::out_of_range("At: index out of range");
+            const int r = static_cast<int>(root_dim_(i));
+            t.origin_(r) += idx(i) * (strides_(i) / root_strides_(r));
+        }
+        t.shape_ = shape_.tail(rank - n);
+        t.strides_ = strides_.tail(rank - n);
+        t.root_dim_ = root_dim_.tail(rank - n);
+        return t;
     }
 
+    int64_t Offset() const { return origin_.dot(root_strides_); }
+
     void PrintShape() const {
         std::cout << "Tensor Shape: [ ";
         for (int i = 0; i < shape_.size(); ++i) {
             std::cout << shape_(i) << " ";
         }
-        std::cout << "]" << std::endl;
+        std::cout << "] Strides: [ ";
+        for (int i = 0; i < strides_.size(); ++i) {
+            std::cout << strides_(i) << " ";
+        }
+        std::cout << "] Offset: " << Offset() << std::endl;
     }
 
     const VectorXi64& GetShape() const { return shape_; }
+    const VectorXi64& GetStrides() const { return strides_; }
+    const VectorXi64& GetRootShape() const { return root_shape_; }
+    const VectorXi64& GetOrigin() const { return origin_; }
+    const VectorXi64& GetRootDims() const { return root_dim_; }
+    const VectorXi64& GetRootStrides() const { return root_strides_; }
 
 private:
     VectorXi64 shape_;
+    VectorXi64 strides_;      // 以元素计，相对根缓冲区
+    VectorXi64 root_dim_;     // 每一维对应根张量的哪一维
+    VectorXi64 root_shape_;
+    VectorXi64 root_strides_;
+    VectorXi64 origin_;       // 视图起点在根张量中的坐标
 };
 
 class Tensor {
 public:
-    using VectorXi64 = Eigen::Matrix<int64_t, -1, 1>;
+    using VectorXi64 = TensorType::VectorXi64;
 
-    Tensor(std::shared_ptr<TensorType> type) : type_(type) {}
+    // 根张量：分配并持有 float 缓冲区（初始化为 0）
+    explicit Tensor(const VectorXi64& shape) : type_(shape) {
+        int64_t n = 1;
+        for (int i = 0; i < shape.size(); ++i) n *= shape(i);
+        storage_.reset(new float[n](), std::default_delete<float[]>());
+        data_ = storage_.get();
+    }
 
     template <typename... Dims>
-    std::shared_ptr<Tensor> Tile(Dims... dims) {
-        std::array<int64_t, sizeof...(Dims)> shape_array = {dims...};
-        std::cout << "shape_array.size():" << shape_array.size() << "\n";
-        VectorXi64 shape(shape_array.size());
+    Tensor Tile(Dims... dims) const {
+        std::array<int64_t, sizeof...(Dims)> shape_array = {static_cast<int64_t>(dims)...};
+        VectorXi64 tile(shape_array.size());
         for (size_t i = 0; i < shape_array.size(); ++i) {
-            shape(i) = shape_array[i];
+            tile(i) = shape_array[i];
         }
-        return std::make_shared<Tensor>(TensorType::Create(this->type_, shape));
+        return Tensor(storage_, TensorType::Create(type_, tile));
     }
 
-    void PrintShape() const {
-        if (type_) {
-            type_->PrintShape();
+    // 固定前几维（通常是块网格坐标），得到单个块的视图
+    template <typename... Idx>
+    Tensor At(Idx... idx) const {
+        std::array<int64_t, sizeof...(Idx)> idx_array = {static_cast<int64_t>(idx)...};
+        VectorXi64 fixed(idx_array.size());
+        for (size_t i = 0; i < idx_array.size(); ++i) {
+            fixed(i) = idx_array[i];
+        }
+        return Tensor(storage_, type_.Fix(fixed));
+    }
+
+    // 按当前视图的全部坐标访问元素：偏移 = 起点 + sum(idx * stride)
+    template <typename... Idx>
+    float& operator()(Idx... idx) const {
+        std::array<int64_t, sizeof...(Idx)> idx_array = {static_cast<int64_t>(idx)...};
+        if (static_cast<int>(idx_array.size()) != type_.GetShape().size())
+            throw std::invalid_argument("Tensor: index count must match rank");
+        int64_t off = type_.Offset();
+        for (size_t i = 0; i < idx_array.size(); ++i) off += idx_array[i] * type_.GetStrides()(i);
+        return data_[off];
+    }
+
+    // 根缓冲区上的 TensorMap（R 为根张量的秩）
+    template <int R>
+    Eigen::TensorMap<Eigen::Tensor<float, R, Eigen::RowMajor>> RootMap() const {
+        const VectorXi64& rs = type_.GetRootShape();
+        if (rs.size() != R) throw std::invalid_argument("RootMap: rank mismatch");
+        std::array<Eigen::Index, R> dims;
+        for (int i = 0; i < R; ++i) dims[i] = rs(i);
+        return Eigen::TensorMap<Eigen::Tensor<float, R, Eigen::RowMajor>>(data_, dims);
+    }
+
+    // 当前视图在根 TensorMap 上的 slice 表达式：要求视图是根张量中的一个矩形块，
+    // 即长度大于 1 的每一维各对应根张量的不同一维且步长等于根步长（At 固定了全部块网格坐标之后就是这种情况）
+    template <int R>
+    auto Map() const {
+        const VectorXi64& shape = type_.GetShape();
+        const VectorXi64& dims = type_.GetRootDims();
+        std::array<Eigen::Index, R> offsets, extents;
+        extents.fill(1);
+        for (int i = 0; i < R; ++i) offsets[i] = type_.GetOrigin()(i);
+        std::array<bool, R> used{};
+        for (int i = 0; i < shape.size(); ++i) {
+            if (shape(i) == 1) continue;  // 长度为 1 的维不影响块的范围
+            const int r = static_cast<int>(dims(i));
+            if (used[r] || type_.GetStrides()(i) != type_.GetRootStrides()(r))
+                throw std::invalid_argument("Map: view is not a box in the root tensor");
+            used[r] = true;
+            extents[r] = shape(i);
         }
+        return RootMap<R>().slice(offsets, extents);
+    }
+
+    void PrintShape() const {
+        type_.PrintShape();
     }
 
+    float* data() const { return data_ + type_.Offset(); }
+    const TensorType& type() const { return type_; }
+
 private:
-    std::shared_ptr<TensorType> type_;
+    // 视图：复制根缓冲区的 shared_ptr，只增加引用计数，不分配
+    Tensor(const std::shared_ptr<float>& storage, const TensorType& type)
+        : storage_(storage), data_(storage.get()), type_(type) {}
+
+    std::shared_ptr<float> storage_;  // 根张量与它的全部视图共享
+    float* data_ = nullptr;           // 始终指向根缓冲区起点，视图的偏移由 type_ 记录
+    TensorType type_;
 };
 
 int main() {
-    // 创建初始 TensorType (假设原始 shape 是 8x8)
-    Eigen::Matrix<int64_t, -1, 1> init_shape(2);
+    // 创建初始 Tensor（原始 shape 是 8x8），元素值等于行优先下标
+    Tensor::VectorXi64 init_shape(2);
     init_shape << 8, 8;
-    auto tensor_type = std::make_shared<TensorType>(init_shape);
-
-    // 创建 Tensor
-    auto tensor = std::make_shared<Tensor>(tensor_type);
+    Tensor tensor(init_shape);
+    for (int i = 0; i < 8; ++i)
+        for (int j = 0; j < 8; ++j) tensor(i, j) = static_cast<float>(i * 8 + j);
 
     // 执行 Tile 操作
-    auto tiled_tensor1 = tensor->Tile(4, 1);
-    auto tiled_tensor2 = tiled_tensor1->Tile(2, 1);
+    auto tiled_tensor1 = tensor.Tile(4, 1);
+    auto tiled_tensor2 = tiled_tensor1.Tile(2, 1);
 
     // 打印结果
     std::cout << "Original ";
-    tensor->PrintShape();
+    tensor.PrintShape();
 
     std::cout << "After Tile(4,1) ";
-    tiled_tensor1->PrintShape();
+    tiled_tensor1.PrintShape();
 
     std::cout << "After Tile(2,1) ";
-    tiled_tensor2->PrintShape();
+    tiled_tensor2.PrintShape();
 
+    // 多级视图访问的是同一块缓冲区：(1, 3, 1, 0, 1, 0) -> 行 1*4 + 1*2 + 1 = 7，列 3
+    std::cout << "tiled_tensor2(1, 3, 1, 0, 1, 0) = " << tiled_tensor2(1, 3, 1, 0, 1, 0)
+              << " (expect " << 7 * 8 + 3 << ")" << std::endl;
 
+    // 取一个块并通过 TensorMap 写回：块 (1, 2) 是行 4..7、列 2 的 4x1 子块
+    auto block = tiled_tensor1.At(1, 2);
+    std::cout << "Block (1, 2) ";
+    block.PrintShape();
+    block.Map<2>() = block.Map<2>() * 10.0f;
+    std::cout << "after scaling block (1, 2) by 10, column 2: ";
+    for (int i = 0; i < 8; ++i) std::cout << tensor(i, 2) << " ";
+    std::cout << std::endl;
 
+    // 块上的归约同样不产生拷贝
+    Eigen::Tensor<float, 0, Eigen::RowMajor> sum = tiled_tensor2.At(0, 5, 1).Map<2>().sum();
+    std::cout << "sum of tile rows 2..3, column 5: " << sum() << " (expect " << (2 * 8 + 5) + (3 * 8 + 5) << ")"
+              << std::endl;
 
+    // 视图共享根缓冲区的所有权：根张量离开作用域后视图仍可访问
+    Tensor orphan = [] {
+        Tensor::VectorXi64 shape(2);
+        shape << 4, 4;
+        Tensor root(shape);
+        root(3, 2) = 42.0f;
+        return root.Tile(2, 2).At(1, 1);
+    }();
+    std::cout << "view after root destroyed: " << orphan(1, 0) << " (expect 42)" << std::endl;
 
     return 0;
 }
@@ -0,0 +1,82 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include <cpuid.h>
+#include <cstdint>
+#include <iostream>
+
+// CPU 特性检测：CPUID 只说明硬件支持，还要用 XGETBV 确认操作系统保存了对应的寄存器状态，
+// 否则在未开启 AVX-512 / AMX 状态的系统上执行这些指令会直接 #UD
+struct CpuFeatures {
+    bool sse4_1 = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool f16c = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512_vnni = false;
+    bool avx512_bf16 = false;
+    bool avx_vnni = false;
+    bool amx_tile = false;
+    bool amx_int8 = false;
+    bool amx_bf16 = false;
+
+    // 进程内只检测一次
+    static const CpuFeatures& get() {
+        static const CpuFeatures features = detect();
+        return features;
+    }
+
+    void print(std::ostream& os = std::cout) const {
+        os << "CPU features:"
+           << (sse4_1 ? " sse4.1" : "") << (avx2 ? " avx2" : "") << (fma ? " fma" : "")
+           << (f16c ? " f16c" : "") << (avx512f ? " avx512f" : "") << (avx512bw ? " avx512bw" : "")
+           << (avx512_vnni ? " avx512_vnni" : "") << (avx512_bf16 ? " avx512_bf16" : "")
+           << (avx_vnni ? " avx_vnni" : "") << (amx_tile ? " amx_tile" : "")
+           << (amx_int8 ? " amx_int8" : "") << (amx_bf16 ? " amx_bf16" : "") << "\n";
+    }
+
+private:
+    static uint64_t xgetbv0() {
+        uint32_t eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<uint64_t>(edx) << 32) | eax;
+    }
+
+    static CpuFeatures detect() {
+        CpuFeatures f;
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return f;
+
+        f.sse4_1 = ecx & bit_SSE4_1;
+        bool osxsave = ecx & bit_OSXSAVE;
+        bool avx = ecx & bit_AVX;
+        f.fma = ecx & bit_FMA;
+        f.f16c = ecx & bit_F16C;
+
+        // XCR0：bit 1/2 = SSE/AVX 状态，bit 5-7 = AVX-512 状态，bit 17/18 = AMX TILECFG/TILEDATA
+        uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+        bool os_avx = (xcr0 & 0x6) == 0x6;
+        bool os_avx512 = os_avx && (xcr0 & 0xe0) == 0xe0;
+        bool os_amx = (xcr0 & 0x60000) == 0x60000;
+
+        if (__get_cpuid_max(0, nullptr) < 7) return f;
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        f.avx2 = avx && os_avx && (ebx & bit_AVX2);
+        f.fma = f.fma && os_avx;
+        f.f16c = f.f16c && os_avx;
+        f.avx512f = os_avx512 && (ebx & bit_AVX512F);
+        f.avx512bw = os_avx512 && (ebx & bit_AVX512BW);
+        f.avx512_vnni = os_avx512 && (ecx & (1u << 11));
+        f.amx_bf16 = os_amx && (edx & (1u << 22));
+        f.amx_tile = os_amx && (edx & (1u << 24));
+        f.amx_int8 = os_amx && (edx & (1u << 25));
+
+        __cpuid_count(7, 1, eax, ebx, ecx, edx);
+        f.avx_vnni = os_avx && (eax & (1u << 4));
+        f.avx512_bf16 = os_avx512 && (eax & (1u << 5));
+        return f;
+    }
+};
+
+#endif // CPU_FEATURES_H
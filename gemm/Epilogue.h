@@ -0,0 +1,217 @@
+#ifndef GEMM_EPILOGUE_H
+#define GEMM_EPILOGUE_H
+
+#include <immintrin.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+// 融合写回（epilogue）：GEMV / GEMM 的输出块还在寄存器里时依次套用偏置、激活、残差等后处理，
+// 省掉每个后处理各自对 C 的一次完整读写。
+//
+// 写回的整体语义：C = ep(alpha * A * B + beta * C)
+//   alpha / beta 由内核在写回前直接合并到累加器上，ep 是编译期的算子链，按模板参数顺序执行：
+//     auto ep = make_epilogue(epilogue::Bias{b}, epilogue::Gelu{}, epilogue::Residual{R, ldr});
+//     gemm_packed_fused(A, B, C, M, N, K, ts, 1.0f, 0.0f, ep);
+//   算子链在编译期展开，全部内联进微内核，不同的链生成不同的内核，没有虚调用。
+//
+// 每个算子对一个"向量"（float / __m256 / __m512）的连续输出起作用，向量的各通道沿列方向排列，
+// 位置由 EpilogueAt{row, col} 给出（第一个通道的坐标）。GEMV 的输出 y 视为 1 × m 的行向量：row = 0，col = i。
+// SIMD 版本由编译选项决定（-mavx2 -mfma / -mavx512f），与 GemmPacked.h 相同；不满一个向量的边界走标量版本。
+
+// __m256 / __m512 作为模板实参时 GCC 会提示丢弃了类型上的 vector / may_alias 属性（-Wignored-attributes），
+// 对按类型选择实现没有影响，只在本文件内关闭这条提示（push / pop，不影响包含者）
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+
+// 输出向量第一个通道的坐标
+struct EpilogueAt {
+    int row;
+    int col;
+};
+
+// 向量操作的统一接口：算子只写一次，对 float / __m256 / __m512 都能实例化
+template <class V>
+struct EpVec;
+
+template <>
+struct EpVec<float> {
+    static constexpr int width = 1;
+    static float load(const float* p) { return *p; }
+    static void store(float* p, float v) { *p = v; }
+    static float set1(float s) { return s; }
+    static float add(float a, float b) { return a + b; }
+    static float sub(float a, float b) { return a - b; }
+    static float mul(float a, float b) { return a * b; }
+    static float div(float a, float b) { return a / b; }
+    static float fmadd(float a, float b, float c) { return a * b + c; }
+    static float max(float a, float b) { return a > b ? a : b; }
+    static float min(float a, float b) { return a < b ? a : b; }
+    static float round(float a) { return std::nearbyint(a); }
+    // 2^n，n 为取整后的浮点数且在 [-126, 127] 内
+    static float pow2n(float n) {
+        uint32_t u = static_cast<uint32_t>(static_cast<int32_t>(n) + 127) << 23;
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        return f;
+    }
+};
+
+#ifdef __AVX2__
+template <>
+struct EpVec<__m256> {
+    static constexpr int width = 8;
+    static __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, __m256 v) { _mm256_storeu_ps(p, v); }
+    static __m256 set1(float s) { return _mm256_set1_ps(s); }
+    static __m256 add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+    static __m256 sub(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+    static __m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+    static __m256 div(__m256 a, __m256 b) { return _mm256_div_ps(a, b); }
+    static __m256 fmadd(__m256 a, __m256 b, __m256 c) { return _mm256_fmadd_ps(a, b, c); }
+    static __m256 max(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+    static __m256 min(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+    static __m256 round(__m256 a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static __m256 pow2n(__m256 n) {
+        __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+        return _mm256_castsi256_ps(e);
+    }
+};
+#endif
+
+#ifdef __AVX512F__
+template <>
+struct EpVec<__m512> {
+    static constexpr int width = 16;
+    static __m512 load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, __m512 v) { _mm512_storeu_ps(p, v); }
+    static __m512 set1(float s) { return _mm512_set1_ps(s); }
+    static __m512 add(__m512 a, __m512 b) { return _mm512_add_ps(a, b); }
+    static __m512 sub(__m512 a, __m512 b) { return _mm512_sub_ps(a, b); }
+    static __m512 mul(__m512 a, __m512 b) { return _mm512_mul_ps(a, b); }
+    static __m512 div(__m512 a, __m512 b) { return _mm512_div_ps(a, b); }
+    static __m512 fmadd(__m512 a, __m512 b, __m512 c) { return _mm512_fmadd_ps(a, b, c); }
+    static __m512 max(__m512 a, __m512 b) { return _mm512_max_ps(a, b); }
+    static __m512 min(__m512 a, __m512 b) { return _mm512_min_ps(a, b); }
+    static __m512 round(__m512 a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static __m512 pow2n(__m512 n) {
+        __m512i e = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127)), 23);
+        return _mm512_castsi512_ps(e);
+    }
+};
+#endif
+
+// 编译目标上最宽的向量类型
+#if defined(__AVX512F__)
+using EpWideVec = __m512;
+#elif defined(__AVX2__)
+using EpWideVec = __m256;
+#else
+using EpWideVec = float;
+#endif
+
+// exp(x)：x = n * ln2 + r，|r| <= ln2 / 2，e^r 用 6 阶多项式（Cephes expf 的系数），再乘 2^n；相对误差约 1e-7
+template <class V>
+inline V ep_exp(V x) {
+    using T = EpVec<V>;
+    x = T::min(T::max(x, T::set1(-87.3f)), T::set1(88.3f));
+    V n = T::round(T::mul(x, T::set1(1.44269504088896341f)));
+    V r = T::fmadd(n, T::set1(-0.693359375f), x);  // ln2 拆成高低两部分，减小舍入误差
+    r = T::fmadd(n, T::set1(2.12194440e-4f), r);
+    V p = T::set1(1.9875691500e-4f);
+    p = T::fmadd(p, r, T::set1(1.3981999507e-3f));
+    p = T::fmadd(p, r, T::set1(8.3334519073e-3f));
+    p = T::fmadd(p, r, T::set1(4.1665795894e-2f));
+    p = T::fmadd(p, r, T::set1(1.6666665459e-1f));
+    p = T::fmadd(p, r, T::set1(5.0000001201e-1f));
+    p = T::fmadd(T::mul(p, r), r, T::add(r, T::set1(1.0f)));
+    return T::mul(p, T::pow2n(n));
+}
+
+namespace epilogue {
+
+// 乘常数
+struct Scale {
+    float s;
+    template <class V>
+    V operator()(V v, EpilogueAt) const {
+        return EpVec<V>::mul(v, EpVec<V>::set1(s));
+    }
+};
+
+// 按列加偏置：C[i][j] += b[j]（GEMV 为 y[i] += b[i]）
+struct Bias {
+    const float* b;
+    template <class V>
+    V operator()(V v, EpilogueAt at) const {
+        return EpVec<V>::add(v, EpVec<V>::load(b + at.col));
+    }
+};
+
+struct Relu {
+    template <class V>
+    V operator()(V v, EpilogueAt) const {
+        return EpVec<V>::max(v, EpVec<V>::set1(0.0f));
+    }
+};
+
+// GELU（tanh 近似）：0.5 x (1 + tanh(u)) = x / (1 + exp(-2u))，u = sqrt(2 / pi) * (x + 0.044715 x^3)
+struct Gelu {
+    template <class V>
+    V operator()(V v, EpilogueAt) const {
+        using T = EpVec<V>;
+        V x2 = T::mul(v, v);
+        V u2 = T::mul(T::mul(v, T::set1(-1.5957691216f)), T::fmadd(x2, T::set1(0.044715f), T::set1(1.0f)));
+        return T::div(v, T::add(T::set1(1.0f), ep_exp(u2)));
+    }
+};
+
+// 残差：C[i][j] += R[i * ld + j]
+struct Residual {
+    const float* r;
+    int ld;
+    template <class V>
+    V operator()(V v, EpilogueAt at) const {
+        return EpVec<V>::add(v, EpVec<V>::load(r + static_cast<size_t>(at.row) * ld + at.col));
+    }
+};
+
+}  // namespace epilogue
+
+// 算子链：按模板参数顺序依次作用；空链即恒等写回
+template <class... Ops>
+struct Epilogue {
+    std::tuple<Ops...> ops;
+
+    template <class V>
+    V operator()(V v, EpilogueAt at) const {
+        return apply(v, at, std::index_sequence_for<Ops...>{});
+    }
+
+private:
+    template <class V, size_t... I>
+    V apply(V v, [[maybe_unused]] EpilogueAt at, std::index_sequence<I...>) const {  // 空链不用 at
+        ((v = std::get<I>(ops)(v, at)), ...);
+        return v;
+    }
+};
+
+template <class... Ops>
+inline Epilogue<Ops...> make_epilogue(Ops... ops) {
+    return Epilogue<Ops...>{std::make_tuple(ops...)};
+}
+
+// 合并 alpha / beta 后套用算子链：v = ep(alpha * acc + beta * old)；beta == 0 时不读 old
+template <class V, class Ep>
+inline V ep_finish(V acc, const float* old, float alpha, float beta, const Ep& ep, EpilogueAt at) {
+    using T = EpVec<V>;
+    V v = alpha == 1.0f ? acc : T::mul(acc, T::set1(alpha));
+    if (beta != 0.0f) v = T::fmadd(T::load(old), T::set1(beta), v);
+    return ep(v, at);
+}
+
+#pragma GCC diagnostic pop
+
+#endif // GEMM_EPILOGUE_H
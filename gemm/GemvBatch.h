@@ -0,0 +1,138 @@
+#ifndef GEMV_BATCH_H
+#define GEMV_BATCH_H
+
+#include <immintrin.h>
+#include <algorithm>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "GemvDispatch.h"
+#include "GemvKernel.h"
+#include "ThreadPool.h"
+
+// 批量 GEMV：Y = alpha * A * X + beta * Y
+//   A: m×n 行优先，行跨度 lda
+//   X: n×b 行优先，第 k 行是 b 个右端向量的第 k 个分量（行跨度 ldx）
+//   Y: m×b 行优先（行跨度 ldy）
+// 一次扫描 A 同时服务 b 个向量：每个 A 元素广播后与 X 的一行做 FMA，
+// 4 行 × 16 列的结果常驻寄存器，A 的每个元素加载一次就参与 16 次乘加，
+// 带宽受限的 GEMV 变成计算受限的瘦 GEMM。
+// 寄存器块内核需要 AVX2 + FMA，由 CpuFeatures 在运行时判断；不支持时逐个向量回退到 gemv() 的运行时分派。
+
+constexpr int GEMV_BATCH_MR = 4;   // 寄存器块行数
+constexpr int GEMV_BATCH_NR = 16;  // 寄存器块列数（2 个 256 位向量）
+
+// 寄存器块微内核：rows (<= 4) 行 × cols (<= 16) 列，列尾部用掩码
+GEMV_TARGET_AVX2 inline void gemv_batch_micro_avx2(const float* A, int lda, const float* X, int ldx,
+                                                   float* Y, int ldy, int rows, int cols, int n,
+                                                   float alpha, float beta) {
+    // 两个 8 列分块的掩码；cols <= 8 时第二块整块关闭
+    __m256i mask0 = cols >= 8 ? _mm256_set1_epi32(-1) : gemv_tail_mask_avx2(cols);
+    int cols1 = cols - 8;
+    __m256i mask1 = cols1 >= 8 ? _mm256_set1_epi32(-1) : gemv_tail_mask_avx2(std::max(cols1, 0));
+
+    __m256 c[GEMV_BATCH_MR][2];
+    for (int r = 0; r < GEMV_BATCH_MR; ++r) {
+        c[r][0] = _mm256_setzero_ps();
+        c[r][1] = _mm256_setzero_ps();
+    }
+
+    const float* a0 = A;
+    const float* a1 = A + (rows > 1 ? lda : 0);  // 不足 4 行时重复指向有效行，结果不写回
+    const float* a2 = A + (rows > 2 ? 2 * lda : 0);
+    const float* a3 = A + (rows > 3 ? 3 * lda : 0);
+
+    for (int k = 0; k < n; ++k) {
+        const float* xk = X + static_cast<size_t>(k) * ldx;
+        __m256 x0 = _mm256_maskload_ps(xk, mask0);
+        __m256 x1 = _mm256_maskload_ps(xk + 8, mask1);
+
+        __m256 a = _mm256_broadcast_ss(a0 + k);
+        c[0][0] = _mm256_fmadd_ps(a, x0, c[0][0]);
+        c[0][1] = _mm256_fmadd_ps(a, x1, c[0][1]);
+        a = _mm256_broadcast_ss(a1 + k);
+        c[1][0] = _mm256_fmadd_ps(a, x0, c[1][0]);
+        c[1][1] = _mm256_fmadd_ps(a, x1, c[1][1]);
+        a = _mm256_broadcast_ss(a2 + k);
+        c[2][0] = _mm256_fmadd_ps(a, x0, c[2][0]);
+        c[2][1] = _mm256_fmadd_ps(a, x1, c[2][1]);
+        a = _mm256_broadcast_ss(a3 + k);
+        c[3][0] = _mm256_fmadd_ps(a, x0, c[3][0]);
+        c[3][1] = _mm256_fmadd_ps(a, x1, c[3][1]);
+    }
+
+    // 写回：Y = alpha * AX + beta * Y，beta == 0 时不读 Y
+    __m256 alpha_vec = _mm256_set1_ps(alpha);
+    __m256 beta_vec = _mm256_set1_ps(beta);
+    for (int r = 0; r < rows; ++r) {
+        float* yr = Y + static_cast<size_t>(r) * ldy;
+        __m256 y0 = _mm256_mul_ps(alpha_vec, c[r][0]);
+        __m256 y1 = _mm256_mul_ps(alpha_vec, c[r][1]);
+        if (beta != 0.0f) {
+            y0 = _mm256_fmadd_ps(beta_vec, _mm256_maskload_ps(yr, mask0), y0);
+            y1 = _mm256_fmadd_ps(beta_vec, _mm256_maskload_ps(yr + 8, mask1), y1);
+        }
+        _mm256_maskstore_ps(yr, mask0, y0);
+        _mm256_maskstore_ps(yr + 8, mask1, y1);
+    }
+}
+
+// 处理 [row_begin, row_end) 行
+GEMV_TARGET_AVX2 inline void gemv_batch_rows(const float* A, int lda, const float* X, int ldx,
+                                             float* Y, int ldy, int row_begin, int row_end, int n, int b,
+                                             float alpha, float beta) {
+    for (int i = row_begin; i < row_end; i += GEMV_BATCH_MR) {
+        int rows = std::min(GEMV_BATCH_MR, row_end - i);
+        // 4 行 A（4 * n 个元素）在列分块之间保持在 L1/L2 中
+        for (int j = 0; j < b; j += GEMV_BATCH_NR) {
+            int cols = std::min(GEMV_BATCH_NR, b - j);
+            gemv_batch_micro_avx2(A + static_cast<size_t>(i) * lda, lda, X + j, ldx,
+                                  Y + static_cast<size_t>(i) * ldy + j, ldy, rows, cols, n, alpha, beta);
+        }
+    }
+}
+
+// 回退路径：X / Y 的第 j 列收集成连续向量，对 [row_begin, row_end) 行调用一次 gemv()，再把结果写回 Y 的第 j 列
+inline void gemv_batch_rows_fallback(const float* A, int lda, const float* X, int ldx, float* Y, int ldy,
+                                     int row_begin, int row_end, int n, int b, float alpha, float beta) {
+    const int rows = row_end - row_begin;
+    if (rows <= 0) return;
+    std::vector<float> x(n), y(rows);
+    const float* a = A + static_cast<size_t>(row_begin) * lda;
+    for (int j = 0; j < b; ++j) {
+        for (int k = 0; k < n; ++k) x[k] = X[static_cast<size_t>(k) * ldx + j];
+        for (int i = 0; i < rows; ++i) y[i] = Y[static_cast<size_t>(row_begin + i) * ldy + j];
+        gemv(a, x.data(), y.data(), rows, n, lda, alpha, beta);
+        for (int i = 0; i < rows; ++i) Y[static_cast<size_t>(row_begin + i) * ldy + j] = y[i];
+    }
+}
+
+// 按 CPU 能力选择寄存器块内核或回退路径
+inline void gemv_batch_rows_dispatch(const float* A, int lda, const float* X, int ldx, float* Y, int ldy,
+                                     int row_begin, int row_end, int n, int b, float alpha, float beta) {
+    const CpuFeatures& cpu = CpuFeatures::get();
+    if (cpu.avx2 && cpu.fma)
+        gemv_batch_rows(A, lda, X, ldx, Y, ldy, row_begin, row_end, n, b, alpha, beta);
+    else
+        gemv_batch_rows_fallback(A, lda, X, ldx, Y, ldy, row_begin, row_end, n, b, alpha, beta);
+}
+
+// 单线程批量 GEMV（紧凑布局：lda = n，ldx = ldy = b）
+inline void gemv_batch(const float* A, const float* X, float* Y, int m, int n, int b,
+                       float alpha = 1.0f, float beta = 0.0f) {
+    gemv_batch_rows_dispatch(A, n, X, b, Y, b, 0, m, n, b, alpha, beta);
+}
+
+// 多线程批量 GEMV：按 4 行对齐切分给线程池
+inline void gemv_batch_parallel(ThreadPool& pool, const float* A, const float* X, float* Y,
+                                int m, int n, int b, float alpha = 1.0f, float beta = 0.0f) {
+    int blocks = (m + GEMV_BATCH_MR - 1) / GEMV_BATCH_MR;
+    int nt = pool.size();
+    pool.run([&](int tid) {
+        int r0 = std::min(m, blocks * tid / nt * GEMV_BATCH_MR);
+        int r1 = std::min(m, blocks * (tid + 1) / nt * GEMV_BATCH_MR);
+        if (r1 > r0) gemv_batch_rows_dispatch(A, n, X, b, Y, b, r0, r1, n, b, alpha, beta);
+    });
+}
+
+#endif // GEMV_BATCH_H
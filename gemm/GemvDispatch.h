@@ -0,0 +1,127 @@
+#ifndef GEMV_DISPATCH_H
+#define GEMV_DISPATCH_H
+
+#include <cstdint>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "GemvKernel.h"
+
+// 运行时分派的 GEMV 入口：y = alpha * A * x + beta * y
+// 首次调用时检测一次 CPU 特性，为每种形状绑定最快的内核函数指针，之后只剩一次间接调用。
+// 本头文件所在的翻译单元不需要 -mavx2 / -mavx512f，同一个二进制可以在整个集群上运行。
+
+// 统一的内核签名（lda 为行跨度，单位为元素）
+using GemvFn = void (*)(const float* A, const float* x, float* y, int m, int n, int lda,
+                        float alpha, float beta);
+
+// 形状分类
+enum class GemvShape {
+    TallSkinny = 0,  // m >= 8n：行很短，行内向量循环几乎跑不满
+    Square = 1,
+    ShortWide = 2,   // n >= 8m：行很长，纯带宽受限
+};
+
+inline GemvShape gemv_classify(int m, int n) {
+    if (static_cast<int64_t>(m) >= 8LL * n) return GemvShape::TallSkinny;
+    if (static_cast<int64_t>(n) >= 8LL * m) return GemvShape::ShortWide;
+    return GemvShape::Square;
+}
+
+inline const char* gemv_shape_name(GemvShape s) {
+    switch (s) {
+        case GemvShape::TallSkinny: return "tall-skinny";
+        case GemvShape::Square: return "square";
+        default: return "short-wide";
+    }
+}
+
+// 标量回退：循环展开 4 次（对应 main_gemv_kernel_opt0.cpp 的 gemv_unrolled）
+inline void gemv_scalar_unrolled(const float* A, const float* x, float* y, int m, int n, int lda,
+                                 float alpha, float beta) {
+    for (int i = 0; i < m; ++i) {
+        const float* a = A + static_cast<size_t>(i) * lda;
+        float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+        int j = 0;
+        for (; j + 4 <= n; j += 4) {
+            s0 += a[j] * x[j];
+            s1 += a[j + 1] * x[j + 1];
+            s2 += a[j + 2] * x[j + 2];
+            s3 += a[j + 3] * x[j + 3];
+        }
+        for (; j < n; ++j) s0 += a[j] * x[j];
+        y[i] = gemv_scale((s0 + s1) + (s2 + s3), alpha, beta, y[i]);
+    }
+}
+
+#ifdef GEMV_HAVE_ASM
+// 汇编内核（gemv_kernel_opt2.asm）：要求 32 字节对齐、lda == n 且 n 为 8 的倍数
+extern "C" void gemv_kernel(float* A, float* x, float* y, int m, int n, float alpha, float beta);
+
+inline bool gemv_asm_applicable(const float* A, const float* x, const float* y, int n, int lda) {
+    auto aligned = [](const void* p) { return (reinterpret_cast<uintptr_t>(p) & 31) == 0; };
+    return lda == n && n % 8 == 0 && aligned(A) && aligned(x) && aligned(y);
+}
+#endif
+
+// 分派表：每种形状一个内核
+struct GemvDispatchTable {
+    GemvFn kernel[3];
+    const char* name[3];
+};
+
+inline GemvDispatchTable gemv_build_dispatch_table(const CpuFeatures& cpu) {
+    GemvDispatchTable t;
+    auto bind = [&](GemvShape s, GemvFn fn, const char* name) {
+        t.kernel[static_cast<int>(s)] = fn;
+        t.name[static_cast<int>(s)] = name;
+    };
+
+    if (cpu.avx512f && cpu.avx2 && cpu.fma) {
+        // 行太短时 512 位主循环跑不满，瘦高矩阵仍用 AVX2
+        bind(GemvShape::TallSkinny, gemv_masked_avx2, "avx2");
+        bind(GemvShape::Square, gemv_masked_avx512, "avx512");
+        bind(GemvShape::ShortWide, gemv_masked_avx512, "avx512");
+    } else if (cpu.avx2 && cpu.fma) {
+        bind(GemvShape::TallSkinny, gemv_masked_avx2, "avx2");
+        bind(GemvShape::Square, gemv_masked_avx2, "avx2");
+        bind(GemvShape::ShortWide, gemv_masked_avx2, "avx2");
+    } else if (cpu.sse4_1) {
+        bind(GemvShape::TallSkinny, gemv_masked_sse4, "sse4");
+        bind(GemvShape::Square, gemv_masked_sse4, "sse4");
+        bind(GemvShape::ShortWide, gemv_masked_sse4, "sse4");
+    } else {
+        bind(GemvShape::TallSkinny, gemv_scalar_unrolled, "scalar");
+        bind(GemvShape::Square, gemv_scalar_unrolled, "scalar");
+        bind(GemvShape::ShortWide, gemv_scalar_unrolled, "scalar");
+    }
+    // 注意：AMX 只提供 bf16 / int8 的 tile 点积，fp32 GEMV 没有 AMX 路径，
+    // 这里只检测并报告，低精度内核由各自的入口使用
+    return t;
+}
+
+inline const GemvDispatchTable& gemv_dispatch_table() {
+    static const GemvDispatchTable table = gemv_build_dispatch_table(CpuFeatures::get());
+    return table;
+}
+
+// 指针版本入口
+inline void gemv(const float* A, const float* x, float* y, int m, int n, int lda, float alpha, float beta) {
+    const GemvDispatchTable& t = gemv_dispatch_table();
+    GemvShape shape = gemv_classify(m, n);
+#ifdef GEMV_HAVE_ASM
+    if (shape != GemvShape::TallSkinny && gemv_asm_applicable(A, x, y, n, lda)) {
+        gemv_kernel(const_cast<float*>(A), const_cast<float*>(x), y, m, n, alpha, beta);
+        return;
+    }
+#endif
+    t.kernel[static_cast<int>(shape)](A, x, y, m, n, lda, alpha, beta);
+}
+
+// 与 main_gemv_kernel_opt0.cpp 中声明一致的 std::vector 版本入口
+inline void gemv(float alpha, const std::vector<float>& A, const std::vector<float>& x,
+                 float beta, std::vector<float>& y, int m, int n) {
+    gemv(A.data(), x.data(), y.data(), m, n, n, alpha, beta);
+}
+
+#endif // GEMV_DISPATCH_H
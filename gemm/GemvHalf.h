@@ -0,0 +1,314 @@
+#ifndef GEMV_HALF_H
+#define GEMV_HALF_H
+
+#include <immintrin.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "GemvKernel.h"
+
+// 16 位存储的 GEMV：y = alpha * A * x + beta * y，A 以 fp16 或 bf16 存储，x / y 仍是 fp32
+// GEMV 受内存带宽限制，A 的字节数减半，吞吐接近翻倍；加载后在寄存器里扩成 fp32 再做 FMA，累加全程 fp32：
+//   - fp16：vcvtph2ps（F16C / AVX-512F）
+//   - bf16：bf16 就是 fp32 的高 16 位，零扩展到 32 位再左移 16 位即可，不需要额外指令集
+// 精度损失只来自 A 的量化（fp16 相对误差 2^-11，bf16 为 2^-8），与 n 无关。
+//
+// 用法：
+//   std::vector<uint16_t> A16 = quantize_f16(A);          // 或 quantize_bf16
+//   gemv_f16(A16.data(), x, y, m, n, n, 1.0f, 0.0f);      // 或 gemv_bf16
+
+#define GEMV_TARGET_F16C __attribute__((target("avx2,fma,f16c")))
+
+// ---------------- 标量转换（就近舍入到偶数） ----------------
+
+inline uint32_t gemv_float_bits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float gemv_bits_float(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+inline uint16_t float_to_f16(float f) {
+    const uint32_t u = gemv_float_bits(f);
+    const uint16_t sign = static_cast<uint16_t>((u >> 16) & 0x8000);
+    const uint32_t abs = u & 0x7FFFFFFF;
+    if (abs >= 0x7F800000) return sign | (abs > 0x7F800000 ? 0x7E00 : 0x7C00);  // NaN / Inf
+    if (abs >= 0x477FF000) return sign | 0x7C00;                                 // 舍入后超过 65504，溢出为 Inf
+    if (abs < 0x38800000) {
+        // fp16 非规格化数：按 2^-24 为单位取整（利用 fp32 加法完成就近偶数舍入）
+        const float v = gemv_bits_float(abs) + 0.5f;
+        return sign | static_cast<uint16_t>(gemv_float_bits(v) - gemv_float_bits(0.5f));
+    }
+    const uint32_t mant_odd = (abs >> 13) & 1;
+    const uint32_t r = abs + 0xC8000FFF + mant_odd;  // 指数偏置 127 -> 15，再加上舍入量
+    return sign | static_cast<uint16_t>(r >> 13);
+}
+
+inline float f16_to_float(uint16_t h) {
+    const uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    const uint32_t exp = (h >> 10) & 0x1F;
+    const uint32_t mant = h & 0x3FF;
+    if (exp == 0) {
+        // 零与非规格化数：mant * 2^-24
+        return gemv_bits_float(sign | gemv_float_bits(static_cast<float>(mant) * (1.0f / 16777216.0f)));
+    }
+    if (exp == 0x1F) return gemv_bits_float(sign | 0x7F800000 | (mant << 13));
+    return gemv_bits_float(sign | ((exp + 112) << 23) | (mant << 13));
+}
+
+inline uint16_t float_to_bf16(float f) {
+    const uint32_t u = gemv_float_bits(f);
+    if ((u & 0x7FFFFFFF) > 0x7F800000) return static_cast<uint16_t>((u >> 16) | 0x40);  // 保持 NaN 为静默 NaN
+    return static_cast<uint16_t>((u + 0x7FFF + ((u >> 16) & 1)) >> 16);
+}
+
+inline float bf16_to_float(uint16_t h) {
+    return gemv_bits_float(static_cast<uint32_t>(h) << 16);
+}
+
+// ---------------- 量化 / 打包 ----------------
+
+// fp32 -> fp16，F16C 可用时 8 个一组用 vcvtps2ph
+GEMV_TARGET_F16C inline void pack_f16_f16c(const float* src, uint16_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+    }
+    for (; i < count; ++i) dst[i] = float_to_f16(src[i]);
+}
+
+inline void pack_f16(const float* src, uint16_t* dst, size_t count) {
+    if (CpuFeatures::get().f16c) {
+        pack_f16_f16c(src, dst, count);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) dst[i] = float_to_f16(src[i]);
+}
+
+inline void pack_bf16(const float* src, uint16_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) dst[i] = float_to_bf16(src[i]);
+}
+
+// m × n 矩阵（行跨度 lda）打包成行跨度 ldo 的 16 位矩阵
+inline void pack_f16(const float* A, int m, int n, int lda, uint16_t* out, int ldo) {
+    for (int i = 0; i < m; ++i)
+        pack_f16(A + static_cast<size_t>(i) * lda, out + static_cast<size_t>(i) * ldo, n);
+}
+
+inline void pack_bf16(const float* A, int m, int n, int lda, uint16_t* out, int ldo) {
+    for (int i = 0; i < m; ++i)
+        pack_bf16(A + static_cast<size_t>(i) * lda, out + static_cast<size_t>(i) * ldo, n);
+}
+
+inline std::vector<uint16_t> quantize_f16(const std::vector<float>& v) {
+    std::vector<uint16_t> out(v.size());
+    pack_f16(v.data(), out.data(), v.size());
+    return out;
+}
+
+inline std::vector<uint16_t> quantize_bf16(const std::vector<float>& v) {
+    std::vector<uint16_t> out(v.size());
+    pack_bf16(v.data(), out.data(), v.size());
+    return out;
+}
+
+inline std::vector<float> dequantize_f16(const std::vector<uint16_t>& v) {
+    std::vector<float> out(v.size());
+    for (size_t i = 0; i < v.size(); ++i) out[i] = f16_to_float(v[i]);
+    return out;
+}
+
+inline std::vector<float> dequantize_bf16(const std::vector<uint16_t>& v) {
+    std::vector<float> out(v.size());
+    for (size_t i = 0; i < v.size(); ++i) out[i] = bf16_to_float(v[i]);
+    return out;
+}
+
+// ---------------- 扩展为 fp32 的加载 ----------------
+
+GEMV_TARGET_F16C inline __m256 gemv_load_f16_avx2(const uint16_t* p) {
+    return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+GEMV_TARGET_AVX2 inline __m256 gemv_load_bf16_avx2(const uint16_t* p) {
+    __m256i w = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(w, 16));
+}
+
+GEMV_TARGET_AVX512 inline __m512 gemv_load_f16_avx512(const uint16_t* p) {
+    return _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+}
+
+GEMV_TARGET_AVX512 inline __m512 gemv_load_bf16_avx512(const uint16_t* p) {
+    __m512i w = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    return _mm512_castsi512_ps(_mm512_slli_epi32(w, 16));
+}
+
+template <bool BF16>
+GEMV_TARGET_F16C inline __m256 gemv_load_half_avx2(const uint16_t* p) {
+    return BF16 ? gemv_load_bf16_avx2(p) : gemv_load_f16_avx2(p);
+}
+
+template <bool BF16>
+GEMV_TARGET_AVX512 inline __m512 gemv_load_half_avx512(const uint16_t* p) {
+    return BF16 ? gemv_load_bf16_avx512(p) : gemv_load_f16_avx512(p);
+}
+
+// 16 位元素没有 AVX2 掩码加载（AVX-512 也要 BW），尾部先拷到清零的栈缓冲区再走整向量加载；
+// 每行只发生一次，x 的尾部照常用 32 位掩码加载
+template <int W>
+struct GemvHalfTail {
+    alignas(64) uint16_t buf[W];
+    const uint16_t* load(const uint16_t* p, int r) {
+        std::memset(buf, 0, sizeof(buf));
+        std::memcpy(buf, p, static_cast<size_t>(r) * sizeof(uint16_t));
+        return buf;
+    }
+};
+
+// ---------------- 单行点积 ----------------
+// 与 gemv_dot_avx2 / gemv_dot_avx512 相同的 4 累加器展开，只是 A 的加载换成扩展加载
+
+template <bool BF16>
+GEMV_TARGET_F16C inline float gemv_dot_half_avx2(const uint16_t* a, const float* x, int n) {
+    const auto load = gemv_load_half_avx2<BF16>;
+    __m256 sum1 = _mm256_setzero_ps();
+    __m256 sum2 = _mm256_setzero_ps();
+    __m256 sum3 = _mm256_setzero_ps();
+    __m256 sum4 = _mm256_setzero_ps();
+
+    int j = 0;
+    for (; j + 32 <= n; j += 32) {
+        sum1 = _mm256_fmadd_ps(load(a + j), _mm256_loadu_ps(x + j), sum1);
+        sum2 = _mm256_fmadd_ps(load(a + j + 8), _mm256_loadu_ps(x + j + 8), sum2);
+        sum3 = _mm256_fmadd_ps(load(a + j + 16), _mm256_loadu_ps(x + j + 16), sum3);
+        sum4 = _mm256_fmadd_ps(load(a + j + 24), _mm256_loadu_ps(x + j + 24), sum4);
+    }
+    for (; j + 8 <= n; j += 8) {
+        sum1 = _mm256_fmadd_ps(load(a + j), _mm256_loadu_ps(x + j), sum1);
+    }
+    if (j < n) {
+        GemvHalfTail<8> tail;
+        __m256 x_vec = _mm256_maskload_ps(x + j, gemv_tail_mask_avx2(n - j));
+        sum2 = _mm256_fmadd_ps(load(tail.load(a + j, n - j)), x_vec, sum2);
+    }
+
+    sum1 = _mm256_add_ps(_mm256_add_ps(sum1, sum2), _mm256_add_ps(sum3, sum4));
+    return gemv_hsum_avx2(sum1);
+}
+
+template <bool BF16>
+GEMV_TARGET_AVX512 inline float gemv_dot_half_avx512(const uint16_t* a, const float* x, int n) {
+    const auto load = gemv_load_half_avx512<BF16>;
+    __m512 sum1 = _mm512_setzero_ps();
+    __m512 sum2 = _mm512_setzero_ps();
+    __m512 sum3 = _mm512_setzero_ps();
+    __m512 sum4 = _mm512_setzero_ps();
+
+    int j = 0;
+    for (; j + 64 <= n; j += 64) {
+        sum1 = _mm512_fmadd_ps(load(a + j), _mm512_loadu_ps(x + j), sum1);
+        sum2 = _mm512_fmadd_ps(load(a + j + 16), _mm512_loadu_ps(x + j + 16), sum2);
+        sum3 = _mm512_fmadd_ps(load(a + j + 32), _mm512_loadu_ps(x + j + 32), sum3);
+        sum4 = _mm512_fmadd_ps(load(a + j + 48), _mm512_loadu_ps(x + j + 48), sum4);
+    }
+    for (; j + 16 <= n; j += 16) {
+        sum1 = _mm512_fmadd_ps(load(a + j), _mm512_loadu_ps(x + j), sum1);
+    }
+    if (j < n) {
+        GemvHalfTail<16> tail;
+        __mmask16 k = static_cast<__mmask16>((1u << (n - j)) - 1);
+        sum2 = _mm512_fmadd_ps(load(tail.load(a + j, n - j)), _mm512_maskz_loadu_ps(k, x + j), sum2);
+    }
+
+    sum1 = _mm512_add_ps(_mm512_add_ps(sum1, sum2), _mm512_add_ps(sum3, sum4));
+    return _mm512_reduce_add_ps(sum1);
+}
+
+template <bool BF16>
+inline float gemv_dot_half_scalar(const uint16_t* a, const float* x, int n) {
+    float s0 = 0.0f, s1 = 0.0f;
+    int j = 0;
+    for (; j + 2 <= n; j += 2) {
+        s0 += (BF16 ? bf16_to_float(a[j]) : f16_to_float(a[j])) * x[j];
+        s1 += (BF16 ? bf16_to_float(a[j + 1]) : f16_to_float(a[j + 1])) * x[j + 1];
+    }
+    if (j < n) s0 += (BF16 ? bf16_to_float(a[j]) : f16_to_float(a[j])) * x[j];
+    return s0 + s1;
+}
+
+// ---------------- 完整 GEMV 与运行时分派 ----------------
+
+using GemvHalfFn = void (*)(const uint16_t* A, const float* x, float* y, int m, int n, int lda,
+                            float alpha, float beta);
+
+template <bool BF16>
+GEMV_TARGET_F16C inline void gemv_half_avx2(const uint16_t* A, const float* x, float* y, int m, int n, int lda,
+                                            float alpha, float beta) {
+    for (int i = 0; i < m; ++i) {
+        float dot = gemv_dot_half_avx2<BF16>(A + static_cast<size_t>(i) * lda, x, n);
+        y[i] = gemv_scale(dot, alpha, beta, y[i]);
+    }
+}
+
+template <bool BF16>
+GEMV_TARGET_AVX512 inline void gemv_half_avx512(const uint16_t* A, const float* x, float* y, int m, int n,
+                                                int lda, float alpha, float beta) {
+    for (int i = 0; i < m; ++i) {
+        float dot = gemv_dot_half_avx512<BF16>(A + static_cast<size_t>(i) * lda, x, n);
+        y[i] = gemv_scale(dot, alpha, beta, y[i]);
+    }
+}
+
+template <bool BF16>
+inline void gemv_half_scalar(const uint16_t* A, const float* x, float* y, int m, int n, int lda, float alpha,
+                             float beta) {
+    for (int i = 0; i < m; ++i) {
+        float dot = gemv_dot_half_scalar<BF16>(A + static_cast<size_t>(i) * lda, x, n);
+        y[i] = gemv_scale(dot, alpha, beta, y[i]);
+    }
+}
+
+// 按 CPU 特性选择内核；fp16 的 AVX2 版本还需要 F16C，bf16 只需要 AVX2
+template <bool BF16>
+inline GemvHalfFn gemv_half_select(const CpuFeatures& cpu, const char** name = nullptr) {
+    auto pick = [&](GemvHalfFn fn, const char* n) {
+        if (name) *name = n;
+        return fn;
+    };
+    if (cpu.avx512f && cpu.avx2 && cpu.fma) return pick(gemv_half_avx512<BF16>, "avx512");
+    if (cpu.avx2 && cpu.fma && (BF16 || cpu.f16c)) return pick(gemv_half_avx2<BF16>, "avx2");
+    return pick(gemv_half_scalar<BF16>, "scalar");
+}
+
+// A 为 fp16，lda 以元素计
+inline void gemv_f16(const uint16_t* A, const float* x, float* y, int m, int n, int lda, float alpha, float beta) {
+    static const GemvHalfFn fn = gemv_half_select<false>(CpuFeatures::get());
+    fn(A, x, y, m, n, lda, alpha, beta);
+}
+
+// A 为 bf16，lda 以元素计
+inline void gemv_bf16(const uint16_t* A, const float* x, float* y, int m, int n, int lda, float alpha, float beta) {
+    static const GemvHalfFn fn = gemv_half_select<true>(CpuFeatures::get());
+    fn(A, x, y, m, n, lda, alpha, beta);
+}
+
+inline void gemv_f16(float alpha, const std::vector<uint16_t>& A, const std::vector<float>& x, float beta,
+                     std::vector<float>& y, int m, int n) {
+    gemv_f16(A.data(), x.data(), y.data(), m, n, n, alpha, beta);
+}
+
+inline void gemv_bf16(float alpha, const std::vector<uint16_t>& A, const std::vector<float>& x, float beta,
+                      std::vector<float>& y, int m, int n) {
+    gemv_bf16(A.data(), x.data(), y.data(), m, n, n, alpha, beta);
+}
+
+#endif // GEMV_HALF_H
@@ -0,0 +1,354 @@
+#ifndef GEMV_INT8_H
+#define GEMV_INT8_H
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "GemvKernel.h"
+
+// int8 量化 GEMV / GEMM：y = alpha * A * x + beta * y，Y = alpha * A * X + beta * Y
+// A（权重）按行量化为 int8，X（激活）在调用时按列动态量化为 uint8，整数点积累加到 int32，
+// 最后在同一趟写回里反量化为 fp32 并合并 alpha / beta，不产生中间的 int32 矩阵。
+// A 的字节数是 fp32 的 1/4，在没有 AMX 的机器上带宽受限的 GEMV 也能得到接近 4 倍的收益。
+//
+// 量化方式：
+//   A 第 i 行：a = s_i * (q - z_i)，q ∈ [-128, 127]；对称量化 z_i = 0，非对称量化用 [min, max] 映射到 [-128, 127]
+//   X 第 c 列：x = t_c * p，p ∈ [-P, P]；存储为 u = p + zx（uint8）
+// 点积恢复：sum_j x_j a_ij = t_c * s_i * (sum_j u_j q_ij - zx * R_i - z_i * S_c)
+//   R_i = sum_j q_ij 在量化 A 时算好，S_c = sum_j p_j 在量化 X 时算好
+//
+// 内核（运行时按 CPU 选择）：
+//   Avx512Vnni：vpdpbusd zmm，一条指令完成 64 对 u8 × s8 乘加
+//   AvxVnni：   vpdpbusd ymm（VEX 编码，Alder Lake 等没有 AVX-512 的机器）
+//   Avx2：      vpmaddubsw + vpmaddwd；vpmaddubsw 的 16 位中间和会饱和，
+//               所以这条路径把 X 量化到 7 位（P = 63，zx = 64，u ≤ 127），此时两对乘积之和不超过 2 * 127 * 128
+//   Scalar：    标量回退
+// int32 累加在最坏情况下（|q| = 128，u = 255）n 不超过约 65000 时不会溢出，实际数据远小于这个上界。
+//
+// 用法：
+//   Int8Matrix A8 = quantize_int8_rows(A, m, n, lda, Int8Scheme::Symmetric);  // 一次性量化权重
+//   gemv_int8(A8, x, y, 1.0f, 0.0f);                                         // x 每次调用时动态量化
+//   gemm_int8(A8, X, b, ldx, Y, ldy, 1.0f, 0.0f);                            // X 为 n × b 行优先
+
+#define GEMV_TARGET_AVX512VNNI __attribute__((target("avx512f,avx512bw,avx512vnni,avx2,fma")))
+#define GEMV_TARGET_AVXVNNI __attribute__((target("avx2,fma,avxvnni")))
+
+enum class Int8Scheme { Symmetric, Asymmetric };
+enum class Int8Isa { Scalar, Avx2, AvxVnni, Avx512Vnni };
+
+inline const char* int8_isa_name(Int8Isa isa) {
+    switch (isa) {
+        case Int8Isa::Avx512Vnni: return "avx512-vnni";
+        case Int8Isa::AvxVnni: return "avx-vnni";
+        case Int8Isa::Avx2: return "avx2-maddubs";
+        default: return "scalar";
+    }
+}
+
+inline Int8Isa int8_best_isa(const CpuFeatures& cpu = CpuFeatures::get()) {
+    if (cpu.avx512_vnni && cpu.avx512bw && cpu.avx2) return Int8Isa::Avx512Vnni;
+    if (cpu.avx_vnni && cpu.avx2) return Int8Isa::AvxVnni;
+    if (cpu.avx2) return Int8Isa::Avx2;
+    return Int8Isa::Scalar;
+}
+
+// 行跨度按 64 字节对齐，内核主循环不需要尾部处理（填充部分 A 为 0，不影响点积）
+constexpr int kInt8RowAlign = 64;
+
+inline int int8_padded(int n) {
+    return (n + kInt8RowAlign - 1) / kInt8RowAlign * kInt8RowAlign;
+}
+
+// 量化后的权重矩阵
+struct Int8Matrix {
+    int m = 0, n = 0, ld = 0;
+    std::vector<int8_t> q;            // m × ld
+    std::vector<float> scale;         // s_i
+    std::vector<int32_t> zero_point;  // z_i（对称量化全为 0）
+    std::vector<int32_t> row_sum;     // R_i
+
+    const int8_t* row(int i) const { return q.data() + static_cast<size_t>(i) * ld; }
+};
+
+// 量化后的激活：count 个长度为 n 的向量，每个向量连续存储（跨度 ld）
+struct Int8Vectors {
+    int n = 0, ld = 0, count = 0;
+    int32_t zero_point = 0;       // zx
+    std::vector<uint8_t> q;       // count × ld
+    std::vector<float> scale;     // t_c
+    std::vector<int32_t> sum;     // S_c
+
+    const uint8_t* vec(int c) const { return q.data() + static_cast<size_t>(c) * ld; }
+};
+
+inline int32_t int8_round(float v, int32_t lo, int32_t hi) {
+    return std::min(hi, std::max(lo, static_cast<int32_t>(std::nearbyint(v))));
+}
+
+inline Int8Matrix quantize_int8_rows(const float* A, int m, int n, int lda, Int8Scheme scheme) {
+    Int8Matrix r;
+    r.m = m;
+    r.n = n;
+    r.ld = int8_padded(n);
+    r.q.assign(static_cast<size_t>(m) * r.ld, 0);
+    r.scale.resize(m);
+    r.zero_point.assign(m, 0);
+    r.row_sum.resize(m);
+    for (int i = 0; i < m; ++i) {
+        const float* a = A + static_cast<size_t>(i) * lda;
+        int8_t* q = r.q.data() + static_cast<size_t>(i) * r.ld;
+        float lo = 0.0f, hi = 0.0f;  // 范围包含 0，保证 0 能被精确表示
+        for (int j = 0; j < n; ++j) {
+            lo = std::min(lo, a[j]);
+            hi = std::max(hi, a[j]);
+        }
+        float s;
+        int32_t z = 0;
+        if (scheme == Int8Scheme::Symmetric) {
+            s = std::max(hi, -lo) / 127.0f;
+        } else {
+            s = (hi - lo) / 255.0f;
+            if (s > 0.0f) z = -128 - static_cast<int32_t>(std::nearbyint(lo / s));
+        }
+        if (s == 0.0f) s = 1.0f;  // 全零行
+        const float inv = 1.0f / s;
+        int32_t sum = 0;
+        for (int j = 0; j < n; ++j) {
+            int32_t v = int8_round(a[j] * inv + static_cast<float>(z), -128, 127);
+            q[j] = static_cast<int8_t>(v);
+            sum += v;
+        }
+        r.scale[i] = s;
+        r.zero_point[i] = z;
+        r.row_sum[i] = sum;
+    }
+    return r;
+}
+
+inline Int8Matrix quantize_int8_rows(const std::vector<float>& A, int m, int n, Int8Scheme scheme) {
+    return quantize_int8_rows(A.data(), m, n, n, scheme);
+}
+
+// 量化 X（n × b 行优先，行跨度 ldx）的 b 个列向量；isa 决定量化位数与零点
+inline void quantize_int8_vectors(const float* X, int n, int b, int ldx, Int8Isa isa, Int8Vectors& out) {
+    const int32_t pmax = isa == Int8Isa::Avx2 ? 63 : 127;
+    out.n = n;
+    out.ld = int8_padded(n);
+    out.count = b;
+    out.zero_point = isa == Int8Isa::Avx2 ? 64 : 128;
+    out.q.assign(static_cast<size_t>(b) * out.ld, 0);
+    out.scale.resize(b);
+    out.sum.resize(b);
+    for (int c = 0; c < b; ++c) {
+        float amax = 0.0f;
+        for (int j = 0; j < n; ++j) amax = std::max(amax, std::fabs(X[static_cast<size_t>(j) * ldx + c]));
+        const float t = amax > 0.0f ? amax / static_cast<float>(pmax) : 1.0f;
+        const float inv = 1.0f / t;
+        uint8_t* u = out.q.data() + static_cast<size_t>(c) * out.ld;
+        int32_t sum = 0;
+        for (int j = 0; j < n; ++j) {
+            int32_t p = int8_round(X[static_cast<size_t>(j) * ldx + c] * inv, -pmax, pmax);
+            u[j] = static_cast<uint8_t>(p + out.zero_point);
+            sum += p;
+        }
+        out.scale[c] = t;
+        out.sum[c] = sum;
+    }
+}
+
+// ---------------- 整数块内核：acc[r][c] = sum_j u_c[j] * q_r[j] ----------------
+// MR 行 A 与 NR 个向量一起扫描，A 的每次加载服务 NR 个向量、X 的每次加载服务 MR 行；k 为 64 的倍数
+
+template <int MR, int NR>
+GEMV_TARGET_AVX512VNNI inline void int8_block_avx512vnni(const int8_t* A, int lda, const uint8_t* X, int ldx,
+                                                         int k, int32_t* acc) {
+    __m512i c[MR][NR];
+    for (int r = 0; r < MR; ++r)
+        for (int v = 0; v < NR; ++v) c[r][v] = _mm512_setzero_si512();
+    for (int p = 0; p < k; p += 64) {
+        __m512i x[NR];
+        for (int v = 0; v < NR; ++v) x[v] = _mm512_loadu_si512(X + static_cast<size_t>(v) * ldx + p);
+        for (int r = 0; r < MR; ++r) {
+            __m512i a = _mm512_loadu_si512(A + static_cast<size_t>(r) * lda + p);
+            for (int v = 0; v < NR; ++v) c[r][v] = _mm512_dpbusd_epi32(c[r][v], x[v], a);
+        }
+    }
+    for (int r = 0; r < MR; ++r)
+        for (int v = 0; v < NR; ++v) acc[r * NR + v] = _mm512_reduce_add_epi32(c[r][v]);
+}
+
+GEMV_TARGET_AVX2 inline int32_t int8_hsum_avx2(__m256i v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_hadd_epi32(s, s);
+    s = _mm_hadd_epi32(s, s);
+    return _mm_cvtsi128_si32(s);
+}
+
+template <int MR, int NR>
+GEMV_TARGET_AVXVNNI inline void int8_block_avxvnni(const int8_t* A, int lda, const uint8_t* X, int ldx, int k,
+                                                   int32_t* acc) {
+    __m256i c[MR][NR];
+    for (int r = 0; r < MR; ++r)
+        for (int v = 0; v < NR; ++v) c[r][v] = _mm256_setzero_si256();
+    for (int p = 0; p < k; p += 32) {
+        __m256i x[NR];
+        for (int v = 0; v < NR; ++v)
+            x[v] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(X + static_cast<size_t>(v) * ldx + p));
+        for (int r = 0; r < MR; ++r) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(A + static_cast<size_t>(r) * lda + p));
+            for (int v = 0; v < NR; ++v) c[r][v] = _mm256_dpbusd_avx_epi32(c[r][v], x[v], a);
+        }
+    }
+    for (int r = 0; r < MR; ++r)
+        for (int v = 0; v < NR; ++v) acc[r * NR + v] = int8_hsum_avx2(c[r][v]);
+}
+
+// vpmaddubsw 得到相邻两对的 16 位和，再用 vpmaddwd 乘 1 扩成 32 位
+template <int MR, int NR>
+GEMV_TARGET_AVX2 inline void int8_block_avx2(const int8_t* A, int lda, const uint8_t* X, int ldx, int k,
+                                             int32_t* acc) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i c[MR][NR];
+    for (int r = 0; r < MR; ++r)
+        for (int v = 0; v < NR; ++v) c[r][v] = _mm256_setzero_si256();
+    for (int p = 0; p < k; p += 32) {
+        __m256i x[NR];
+        for (int v = 0; v < NR; ++v)
+            x[v] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(X + static_cast<size_t>(v) * ldx + p));
+        for (int r = 0; r < MR; ++r) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(A + static_cast<size_t>(r) * lda + p));
+            for (int v = 0; v < NR; ++v) {
+                __m256i s16 = _mm256_maddubs_epi16(x[v], a);
+                c[r][v] = _mm256_add_epi32(c[r][v], _mm256_madd_epi16(s16, ones));
+            }
+        }
+    }
+    for (int r = 0; r < MR; ++r)
+        for (int v = 0; v < NR; ++v) acc[r * NR + v] = int8_hsum_avx2(c[r][v]);
+}
+
+template <int MR, int NR>
+inline void int8_block_scalar(const int8_t* A, int lda, const uint8_t* X, int ldx, int k, int32_t* acc) {
+    for (int r = 0; r < MR; ++r)
+        for (int v = 0; v < NR; ++v) {
+            const int8_t* a = A + static_cast<size_t>(r) * lda;
+            const uint8_t* x = X + static_cast<size_t>(v) * ldx;
+            int32_t s = 0;
+            for (int p = 0; p < k; ++p) s += static_cast<int32_t>(x[p]) * a[p];
+            acc[r * NR + v] = s;
+        }
+}
+
+// 每种 ISA 的块内核与寄存器块宽度：AVX-512 有 32 个 zmm，4 × 4 个累加器；256 位只有 16 个 ymm，用 4 × 2
+struct Int8KernelAvx512Vnni {
+    static constexpr int NR = 4;
+    template <int MR, int N>
+    static void block(const int8_t* A, int lda, const uint8_t* X, int ldx, int k, int32_t* acc) {
+        int8_block_avx512vnni<MR, N>(A, lda, X, ldx, k, acc);
+    }
+};
+
+struct Int8KernelAvxVnni {
+    static constexpr int NR = 2;
+    template <int MR, int N>
+    static void block(const int8_t* A, int lda, const uint8_t* X, int ldx, int k, int32_t* acc) {
+        int8_block_avxvnni<MR, N>(A, lda, X, ldx, k, acc);
+    }
+};
+
+struct Int8KernelAvx2 {
+    static constexpr int NR = 2;
+    template <int MR, int N>
+    static void block(const int8_t* A, int lda, const uint8_t* X, int ldx, int k, int32_t* acc) {
+        int8_block_avx2<MR, N>(A, lda, X, ldx, k, acc);
+    }
+};
+
+struct Int8KernelScalar {
+    static constexpr int NR = 2;
+    template <int MR, int N>
+    static void block(const int8_t* A, int lda, const uint8_t* X, int ldx, int k, int32_t* acc) {
+        int8_block_scalar<MR, N>(A, lda, X, ldx, k, acc);
+    }
+};
+
+// ---------------- 驱动与融合写回 ----------------
+
+// 反量化 MR × NR 个整数点积并写回 Y[i0.., c0..]；beta == 0 时不读 Y
+template <int MR, int NR>
+inline void int8_epilogue(const Int8Matrix& A, const Int8Vectors& X, const int32_t* acc, int i0, int c0, float* Y,
+                          int ldy, float alpha, float beta) {
+    for (int r = 0; r < MR; ++r) {
+        const int i = i0 + r;
+        const int32_t zr = X.zero_point * A.row_sum[i];
+        float* y = Y + static_cast<size_t>(i) * ldy + c0;
+        for (int v = 0; v < NR; ++v) {
+            const int c = c0 + v;
+            const int32_t dot = acc[r * NR + v] - zr - A.zero_point[i] * X.sum[c];
+            const float val = alpha * A.scale[i] * X.scale[c] * static_cast<float>(dot);
+            y[v] = gemv_scale(val, 1.0f, beta, y[v]);
+        }
+    }
+}
+
+template <class K, int MR, int NR>
+inline void int8_tile(const Int8Matrix& A, const Int8Vectors& X, int i, int c, float* Y, int ldy, float alpha,
+                      float beta) {
+    int32_t acc[MR * NR];
+    K::template block<MR, NR>(A.row(i), A.ld, X.vec(c), X.ld, A.ld, acc);
+    int8_epilogue<MR, NR>(A, X, acc, i, c, Y, ldy, alpha, beta);
+}
+
+// Y[m × count]（行跨度 ldy）= alpha * A * X + beta * Y，行按 4 分块，向量按 K::NR 分块；
+// 行块在外层，4 行 A 在向量分块之间留在 L1 / L2 中，A 只从内存读一遍
+template <class K>
+inline void int8_gemm_driver(const Int8Matrix& A, const Int8Vectors& X, float* Y, int ldy, float alpha, float beta) {
+    constexpr int MR = 4, NR = K::NR;
+    const int m4 = A.m / MR * MR, cn = X.count / NR * NR;
+    int i = 0;
+    for (; i < m4; i += MR) {
+        int c = 0;
+        for (; c < cn; c += NR) int8_tile<K, MR, NR>(A, X, i, c, Y, ldy, alpha, beta);
+        for (; c < X.count; ++c) int8_tile<K, MR, 1>(A, X, i, c, Y, ldy, alpha, beta);
+    }
+    for (; i < A.m; ++i) {
+        int c = 0;
+        for (; c < cn; c += NR) int8_tile<K, 1, NR>(A, X, i, c, Y, ldy, alpha, beta);
+        for (; c < X.count; ++c) int8_tile<K, 1, 1>(A, X, i, c, Y, ldy, alpha, beta);
+    }
+}
+
+// 用已量化的 X 计算；X 必须用同一 isa 量化（决定了零点与位数）
+inline void gemm_int8(const Int8Matrix& A, const Int8Vectors& X, float* Y, int ldy, float alpha, float beta,
+                      Int8Isa isa = int8_best_isa()) {
+    switch (isa) {
+        case Int8Isa::Avx512Vnni: int8_gemm_driver<Int8KernelAvx512Vnni>(A, X, Y, ldy, alpha, beta); break;
+        case Int8Isa::AvxVnni: int8_gemm_driver<Int8KernelAvxVnni>(A, X, Y, ldy, alpha, beta); break;
+        case Int8Isa::Avx2: int8_gemm_driver<Int8KernelAvx2>(A, X, Y, ldy, alpha, beta); break;
+        default: int8_gemm_driver<Int8KernelScalar>(A, X, Y, ldy, alpha, beta); break;
+    }
+}
+
+// X 为 n × b 行优先 fp32（与 gemv_batch 相同的布局），调用时动态量化
+inline void gemm_int8(const Int8Matrix& A, const float* X, int b, int ldx, float* Y, int ldy, float alpha, float beta,
+                      Int8Isa isa = int8_best_isa()) {
+    Int8Vectors xq;
+    quantize_int8_vectors(X, A.n, b, ldx, isa, xq);
+    gemm_int8(A, xq, Y, ldy, alpha, beta, isa);
+}
+
+inline void gemv_int8(const Int8Matrix& A, const float* x, float* y, float alpha, float beta,
+                      Int8Isa isa = int8_best_isa()) {
+    gemm_int8(A, x, 1, 1, y, 1, alpha, beta, isa);
+}
+
+inline void gemv_int8(float alpha, const Int8Matrix& A, const std::vector<float>& x, float beta,
+                      std::vector<float>& y) {
+    gemv_int8(A, x.data(), y.data(), alpha, beta);
+}
+
+#endif // GEMV_INT8_H
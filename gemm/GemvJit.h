@@ -0,0 +1,469 @@
+#ifndef GEMV_JIT_H
+#define GEMV_JIT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+#include "CpuFeatures.h"
+#include "GemvDispatch.h"
+#include "JitAssembler.h"
+
+// 按形状特化的 JIT GEMV / GEMM 微内核：首次遇到某个 (m, n, k, lda, ldb, ldc, alpha, beta) 时生成机器码并缓存，
+// 之后同形状的调用直接跳进生成的代码。
+//
+// GEMV：y = alpha * A * x + beta * y（A 为 m × n，行跨度 lda）
+//   - n 方向完全展开：每 4 行一组，每组的指令序列里没有分支，列尾部用掩码加载（AVX2 vmaskmovps / AVX-512 k1）
+//   - x 能放进寄存器时（AVX2 不超过 8 个 ymm = 64 个 float，AVX-512 不超过 16 个 zmm = 256 个 float）只加载一次，
+//     之后每行的 FMA 直接以 A 为内存操作数，瘦高矩阵（m 很大、n 很小）正是这种情况
+//   - 行组之间只有一个计数循环；不超过 8 组时连循环也展开
+// GEMM：C = alpha * A * B + beta * C（行优先，A 为 m × k，B 为 k × n）
+//   - AVX2 4 × 16、AVX-512 8 × 32 的寄存器块，k 方向完全展开，列块在代码中逐个展开
+//   - AVX-512 的 A 元素用 {1to16} 嵌入广播直接参与 FMA
+// alpha == 1 时不乘 alpha，beta == 0 时不读 y / C，beta == 1 时只做加法。
+// 生成的代码超过 kJitMaxCodeBytes、某个地址位移超出 int32（行跨度过大）或 CPU 不支持 AVX2 + FMA 时返回 nullptr，调用方回退到通用内核（gemv_jit / gemm_jit 已处理）。
+//
+// 用法：
+//   gemv_jit(A, x, y, m, n, lda, alpha, beta);          // 带缓存与回退的入口
+//   JitGemvFn f = jit_gemv_kernel(m, n, lda, 1.0f, 0.0f);  // 直接取函数指针：f(A, x, y)
+
+using JitGemvFn = void (*)(const float* A, const float* x, float* y);
+using JitGemmFn = void (*)(const float* A, const float* B, float* C);
+
+enum class JitIsa { None, Avx2, Avx512 };
+
+inline const char* jit_isa_name(JitIsa isa) {
+    switch (isa) {
+        case JitIsa::Avx2: return "avx2";
+        case JitIsa::Avx512: return "avx512";
+        default: return "none";
+    }
+}
+
+inline JitIsa jit_best_isa() {
+#if JIT_SUPPORTED
+    const CpuFeatures& cpu = CpuFeatures::get();
+    if (cpu.avx512f) return JitIsa::Avx512;
+    if (cpu.avx2 && cpu.fma) return JitIsa::Avx2;
+#endif
+    return JitIsa::None;
+}
+
+constexpr size_t kJitMaxCodeBytes = size_t(4) << 20;
+
+namespace jit {
+
+inline uint32_t float_bits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+// 常量池固定 64 字节：前 8 个 int32 是 AVX2 列尾部掩码
+constexpr int kPoolBytes = 64;
+
+inline std::vector<uint8_t> make_pool(int tail) {
+    std::vector<uint8_t> pool(kPoolBytes, 0);
+    for (int i = 0; i < tail && i < 8; ++i) std::memset(&pool[i * 4], 0xFF, 4);
+    return pool;
+}
+
+// 地址位移 / 指针步长按 int64 计算，放不进 disp32 / imm32 时置 overflow，由 generate() 放弃这个形状
+inline int32_t checked_disp(int64_t bytes, bool& overflow) {
+    if (bytes < INT32_MIN || bytes > INT32_MAX) {
+        overflow = true;
+        return 0;
+    }
+    return static_cast<int32_t>(bytes);
+}
+
+// 把标量常量广播到 xmm/ymm 寄存器 reg（经由 eax）
+inline void load_scalar(X86Assembler& a, int reg, float v) {
+    a.mov(RAX, float_bits(v));
+    a.vmovd(reg, RAX);
+    a.vbroadcastss(1, reg, reg);
+}
+
+// ---------------- GEMV ----------------
+
+// 寄存器分配（AVX2）：ymm0-3 四行累加器，ymm4 临时，ymm5 尾部掩码，ymm6 alpha，ymm7 beta，ymm8-15 缓存的 x
+// 寄存器分配（AVX-512）：zmm0-3 累加器，zmm4 临时，k1 尾部掩码，xmm6 / xmm7 alpha / beta，zmm16-31 缓存的 x
+class GemvGenerator {
+public:
+    GemvGenerator(JitIsa isa, int m, int n, int lda, float alpha, float beta)
+        : isa_(isa), m_(m), n_(n), lda_(lda), alpha_(alpha), beta_(beta) {
+        width_ = isa == JitIsa::Avx512 ? 16 : 8;
+        nv_ = n / width_;
+        tail_ = n % width_;
+        total_ = nv_ + (tail_ ? 1 : 0);
+        cache_x_ = total_ <= (isa == JitIsa::Avx512 ? 16 : 8);
+    }
+
+    std::unique_ptr<JitCode> generate() {
+        a_.lea_r11_rip(-kPoolBytes);
+        prologue();
+        const int blocks = m_ / 4;
+        if (blocks > 8) {
+            a_.mov(RCX, static_cast<uint32_t>(blocks));
+            size_t loop = a_.size();
+            rows(4);
+            advance(4);
+            a_.dec(RCX);
+            a_.jnz(loop);
+        } else {
+            for (int b = 0; b < blocks; ++b) {
+                rows(4);
+                advance(4);
+            }
+        }
+        for (int r = 0; r < m_ % 4; ++r) {
+            rows(1);
+            advance(1);
+        }
+        a_.vzeroupper();
+        a_.ret();
+        if (overflow_ || a_.size() > kJitMaxCodeBytes) return nullptr;
+        return std::unique_ptr<JitCode>(new JitCode(make_pool(isa_ == JitIsa::Avx2 ? tail_ : 0), a_.code()));
+    }
+
+private:
+    int xreg(int v) const { return (isa_ == JitIsa::Avx512 ? 16 : 8) + (cache_x_ ? v : 0); }
+    int32_t disp(int64_t bytes) { return checked_disp(bytes, overflow_); }
+    Mem a_mem(int r, int v) { return {RDI, disp((int64_t(r) * lda_ + int64_t(v) * width_) * 4)}; }
+    Mem x_mem(int v) { return {RSI, disp(int64_t(v) * width_ * 4)}; }
+
+    void prologue() {
+        if (tail_) {
+            if (isa_ == JitIsa::Avx512) {
+                a_.mov(RAX, (1u << tail_) - 1);
+                a_.kmovw(1, RAX);
+            } else {
+                a_.vmovups(1, 5, Mem{R11, 0});
+            }
+        }
+        if (alpha_ != 1.0f) load_scalar(a_, 6, alpha_);
+        if (beta_ != 0.0f && beta_ != 1.0f) load_scalar(a_, 7, beta_);
+        // x 常驻寄存器；不常驻时只把尾部向量（掩码后的）放进寄存器
+        for (int v = cache_x_ ? 0 : nv_; v < total_; ++v) {
+            const bool masked = tail_ && v == nv_;
+            const int reg = cache_x_ ? xreg(v) : xreg(0);
+            if (isa_ == JitIsa::Avx512)
+                a_.vmovups_z(reg, x_mem(v), masked ? 1 : 0);
+            else if (masked)
+                a_.vmaskmovps(1, reg, 5, x_mem(v));
+            else
+                a_.vmovups(1, reg, x_mem(v));
+        }
+    }
+
+    void fma_full(int acc, int r, int v) {
+        if (isa_ == JitIsa::Avx512) {
+            if (cache_x_) {
+                a_.vfmadd231ps_z(acc, xreg(v), a_mem(r, v));
+            } else {
+                a_.vmovups_z(4, a_mem(r, v));
+                a_.vfmadd231ps_z(acc, 4, x_mem(v));
+            }
+        } else {
+            if (cache_x_) {
+                a_.vfmadd231ps(1, acc, xreg(v), a_mem(r, v));
+            } else {
+                a_.vmovups(1, 4, a_mem(r, v));
+                a_.vfmadd231ps(1, acc, 4, x_mem(v));
+            }
+        }
+    }
+
+    void fma_tail(int acc, int r) {
+        const int x = cache_x_ ? xreg(nv_) : xreg(0);
+        if (isa_ == JitIsa::Avx512) {
+            a_.vmovups_z(4, a_mem(r, nv_), 1);
+            a_.vfmadd231ps_z(acc, 4, x);
+        } else {
+            a_.vmaskmovps(1, 4, 5, a_mem(r, nv_));
+            a_.vfmadd231ps(1, acc, 4, x);
+        }
+    }
+
+    // 计算 R 行（R = 4 或 1）并写回 y[0..R)
+    void rows(int R) {
+        for (int r = 0; r < R; ++r) a_.vxorps(1, r, r, r);  // VEX 写 ymm 会清零 zmm 高位
+        for (int v = 0; v < nv_; ++v)
+            for (int r = 0; r < R; ++r) fma_full(r, r, v);
+        if (tail_)
+            for (int r = 0; r < R; ++r) fma_tail(r, r);
+        if (isa_ == JitIsa::Avx512) {
+            for (int r = 0; r < R; ++r) {
+                a_.vextractf64x4(4, r, 1);
+                a_.vaddps(1, r, r, 4);
+            }
+        }
+        if (R == 4) {
+            // 四个累加器各自水平求和，结果依次落在 xmm0 的 4 个通道
+            a_.vhaddps(1, 0, 0, 1);
+            a_.vhaddps(1, 2, 2, 3);
+            a_.vhaddps(1, 0, 0, 2);
+            a_.vextractf128(1, 0, 1);
+            a_.vaddps(0, 0, 0, 1);
+            if (alpha_ != 1.0f) a_.vmulps(0, 0, 0, 6);
+            if (beta_ == 1.0f)
+                a_.vaddps(0, 0, 0, Mem{RDX, 0});
+            else if (beta_ != 0.0f)
+                a_.vfmadd231ps(0, 0, 7, Mem{RDX, 0});
+            a_.vmovups(0, Mem{RDX, 0}, 0);
+        } else {
+            a_.vextractf128(1, 0, 1);
+            a_.vaddps(0, 0, 0, 1);
+            a_.vhaddps(0, 0, 0, 0);
+            a_.vhaddps(0, 0, 0, 0);
+            if (alpha_ != 1.0f) a_.vmulss(0, 0, 6);
+            if (beta_ == 1.0f)
+                a_.vaddss(0, 0, Mem{RDX, 0});
+            else if (beta_ != 0.0f)
+                a_.vfmadd231ss(0, 7, Mem{RDX, 0});
+            a_.vmovss(Mem{RDX, 0}, 0);
+        }
+    }
+
+    void advance(int R) {
+        a_.add(RDI, disp(int64_t(R) * lda_ * 4));
+        a_.add(RDX, R * 4);
+    }
+
+    X86Assembler a_;
+    JitIsa isa_;
+    int m_, n_, lda_;
+    float alpha_, beta_;
+    int width_, nv_, tail_, total_;
+    bool cache_x_;
+    bool overflow_ = false;
+};
+
+// ---------------- GEMM ----------------
+
+// 寄存器分配（AVX2，MR = 4，NR = 16）：ymm0-7 累加器（第 r 行第 h 个向量为 2r + h），ymm8-9 B 行，
+//   ymm10 广播的 A 元素，ymm11 alpha，ymm12 beta，ymm13 列尾部掩码
+// 寄存器分配（AVX-512，MR = 8，NR = 32）：zmm0-15 累加器，zmm16-17 B 行，zmm18 alpha，zmm19 beta，k1 列尾部掩码
+class GemmGenerator {
+public:
+    GemmGenerator(JitIsa isa, int m, int n, int k, int lda, int ldb, int ldc, float alpha, float beta)
+        : isa_(isa), m_(m), n_(n), k_(k), lda_(lda), ldb_(ldb), ldc_(ldc), alpha_(alpha), beta_(beta) {
+        width_ = isa == JitIsa::Avx512 ? 16 : 8;
+        mr_ = isa == JitIsa::Avx512 ? 8 : 4;
+        tail_ = n % width_;
+    }
+
+    std::unique_ptr<JitCode> generate() {
+        // 粗略估计代码量：每个 k、每个列块约 (MR * 2 + 2) 条指令，每条不超过 8 字节
+        const size_t col_blocks = static_cast<size_t>((n_ + 2 * width_ - 1) / (2 * width_));
+        const size_t estimate = col_blocks * static_cast<size_t>(k_) * (mr_ * 2 + 2) * 8 * (m_ % mr_ ? 2 : 1);
+        if (estimate > kJitMaxCodeBytes) return nullptr;
+
+        a_.lea_r11_rip(-kPoolBytes);
+        if (tail_) {
+            if (isa_ == JitIsa::Avx512) {
+                a_.mov(RAX, (1u << tail_) - 1);
+                a_.kmovw(1, RAX);
+            } else {
+                a_.vmovups(1, 13, Mem{R11, 0});
+            }
+        }
+        if (isa_ == JitIsa::Avx512) {
+            if (alpha_ != 1.0f) {
+                a_.mov(RAX, float_bits(alpha_));
+                a_.vmovd(6, RAX);
+                a_.vbroadcastss_z(18, 6);
+            }
+            if (beta_ != 0.0f && beta_ != 1.0f) {
+                a_.mov(RAX, float_bits(beta_));
+                a_.vmovd(6, RAX);
+                a_.vbroadcastss_z(19, 6);
+            }
+        } else {
+            if (alpha_ != 1.0f) load_scalar(a_, 11, alpha_);
+            if (beta_ != 0.0f && beta_ != 1.0f) load_scalar(a_, 12, beta_);
+        }
+
+        const int blocks = m_ / mr_;
+        if (blocks > 1) {
+            a_.mov(RCX, static_cast<uint32_t>(blocks));
+            size_t loop = a_.size();
+            row_block(mr_);
+            a_.dec(RCX);
+            a_.jnz(loop);
+        } else if (blocks == 1) {
+            row_block(mr_);
+        }
+        if (m_ % mr_) row_block(m_ % mr_);
+        a_.vzeroupper();
+        a_.ret();
+        if (overflow_ || a_.size() > kJitMaxCodeBytes) return nullptr;
+        return std::unique_ptr<JitCode>(new JitCode(make_pool(isa_ == JitIsa::Avx2 ? tail_ : 0), a_.code()));
+    }
+
+private:
+    int32_t disp(int64_t bytes) { return checked_disp(bytes, overflow_); }
+    int acc(int r, int h) const { return 2 * r + h; }
+    int breg(int h) const { return (isa_ == JitIsa::Avx512 ? 16 : 8) + h; }
+
+    // R 行 × 全部列，结束后 A / C 指针前移 R 行
+    void row_block(int R) {
+        for (int j0 = 0; j0 < n_; j0 += 2 * width_) {
+            const int w = std::min(2 * width_, n_ - j0);
+            const int nvec = (w + width_ - 1) / width_;
+            for (int r = 0; r < R; ++r)
+                for (int h = 0; h < nvec; ++h) a_.vxorps(1, acc(r, h), acc(r, h), acc(r, h));
+            for (int kk = 0; kk < k_; ++kk) {
+                for (int h = 0; h < nvec; ++h) {
+                    const bool masked = tail_ && j0 + (h + 1) * width_ > n_;
+                    Mem b{RSI, disp((int64_t(kk) * ldb_ + j0 + h * width_) * 4)};
+                    if (isa_ == JitIsa::Avx512)
+                        a_.vmovups_z(breg(h), b, masked ? 1 : 0);
+                    else if (masked)
+                        a_.vmaskmovps(1, breg(h), 13, b);
+                    else
+                        a_.vmovups(1, breg(h), b);
+                }
+                for (int r = 0; r < R; ++r) {
+                    Mem a{RDI, disp((int64_t(r) * lda_ + kk) * 4)};
+                    if (isa_ == JitIsa::Avx512) {
+                        for (int h = 0; h < nvec; ++h) a_.vfmadd231ps_z_bcast(acc(r, h), breg(h), a);
+                    } else {
+                        a_.vbroadcastss(1, 10, a);
+                        for (int h = 0; h < nvec; ++h) a_.vfmadd231ps(1, acc(r, h), breg(h), 10);
+                    }
+                }
+            }
+            for (int r = 0; r < R; ++r)
+                for (int h = 0; h < nvec; ++h) epilogue(acc(r, h), Mem{RDX, disp((int64_t(r) * ldc_ + j0 + h * width_) * 4)},
+                                                        tail_ && j0 + (h + 1) * width_ > n_);
+        }
+        a_.add(RDI, disp(int64_t(R) * lda_ * 4));
+        a_.add(RDX, disp(int64_t(R) * ldc_ * 4));
+    }
+
+    void epilogue(int c, const Mem& dst, bool masked) {
+        if (isa_ == JitIsa::Avx512) {
+            if (alpha_ != 1.0f) a_.vmulps_z(c, c, 18);
+            if (beta_ != 0.0f) {
+                a_.vmovups_z(16, dst, masked ? 1 : 0);
+                if (beta_ == 1.0f)
+                    a_.vaddps_z(c, c, 16);
+                else
+                    a_.vfmadd231ps_z(c, 16, 19);
+            }
+            a_.vmovups_z(dst, c, masked ? 1 : 0);
+        } else {
+            if (alpha_ != 1.0f) a_.vmulps(1, c, c, 11);
+            if (beta_ != 0.0f) {
+                if (masked)
+                    a_.vmaskmovps(1, 8, 13, dst);
+                else
+                    a_.vmovups(1, 8, dst);
+                if (beta_ == 1.0f)
+                    a_.vaddps(1, c, c, 8);
+                else
+                    a_.vfmadd231ps(1, c, 8, 12);
+            }
+            if (masked)
+                a_.vmaskmovps(1, dst, 13, c);
+            else
+                a_.vmovups(1, dst, c);
+        }
+    }
+
+    X86Assembler a_;
+    JitIsa isa_;
+    int m_, n_, k_, lda_, ldb_, ldc_;
+    float alpha_, beta_;
+    int width_, mr_, tail_;
+    bool overflow_ = false;
+};
+
+// 形状 -> 生成的代码。生成失败（不支持 / 代码过大）也缓存为空指针，避免反复尝试
+class JitKernelCache {
+public:
+    static JitKernelCache& get() {
+        static JitKernelCache cache;
+        return cache;
+    }
+
+    using Key = std::tuple<int, int, int, int, int, int, int, int, uint32_t, uint32_t>;
+
+    template <typename Fn, typename Make>
+    Fn lookup(const Key& key, Make make) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = kernels_.find(key);
+        if (it == kernels_.end()) it = kernels_.emplace(key, make()).first;
+        return it->second ? it->second->template entry<Fn>() : nullptr;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return kernels_.size();
+    }
+
+    size_t code_bytes() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t total = 0;
+        for (const auto& kv : kernels_)
+            if (kv.second) total += kv.second->code_size();
+        return total;
+    }
+
+private:
+    std::mutex mutex_;
+    std::map<Key, std::unique_ptr<JitCode>> kernels_;
+};
+
+}  // namespace jit
+
+inline JitGemvFn jit_gemv_kernel(int m, int n, int lda, float alpha, float beta, JitIsa isa = jit_best_isa()) {
+    if (isa == JitIsa::None || m <= 0 || n <= 0 || lda < n) return nullptr;
+    jit::JitKernelCache::Key key(0, static_cast<int>(isa), m, n, 0, lda, 0, 0, jit::float_bits(alpha),
+                                 jit::float_bits(beta));
+    return jit::JitKernelCache::get().lookup<JitGemvFn>(
+        key, [&] { return jit::GemvGenerator(isa, m, n, lda, alpha, beta).generate(); });
+}
+
+inline JitGemmFn jit_gemm_kernel(int m, int n, int k, int lda, int ldb, int ldc, float alpha, float beta,
+                                 JitIsa isa = jit_best_isa()) {
+    if (isa == JitIsa::None || m <= 0 || n <= 0 || k <= 0 || lda < k || ldb < n || ldc < n) return nullptr;
+    jit::JitKernelCache::Key key(1, static_cast<int>(isa), m, n, k, lda, ldb, ldc, jit::float_bits(alpha),
+                                 jit::float_bits(beta));
+    return jit::JitKernelCache::get().lookup<JitGemmFn>(
+        key, [&] { return jit::GemmGenerator(isa, m, n, k, lda, ldb, ldc, alpha, beta).generate(); });
+}
+
+// 带缓存的 GEMV 入口：形状不支持时回退到 GemvDispatch.h 的运行时分派
+inline void gemv_jit(const float* A, const float* x, float* y, int m, int n, int lda, float alpha, float beta) {
+    if (JitGemvFn f = jit_gemv_kernel(m, n, lda, alpha, beta)) {
+        f(A, x, y);
+        return;
+    }
+    gemv(A, x, y, m, n, lda, alpha, beta);
+}
+
+// 带缓存的 GEMM 入口：回退为按行累加的标量实现
+inline void gemm_jit(const float* A, const float* B, float* C, int m, int n, int k, int lda, int ldb, int ldc,
+                     float alpha, float beta) {
+    if (JitGemmFn f = jit_gemm_kernel(m, n, k, lda, ldb, ldc, alpha, beta)) {
+        f(A, B, C);
+        return;
+    }
+    for (int i = 0; i < m; ++i) {
+        float* c = C + static_cast<size_t>(i) * ldc;
+        for (int j = 0; j < n; ++j) c[j] = beta == 0.0f ? 0.0f : beta * c[j];
+        for (int p = 0; p < k; ++p) {
+            const float a = alpha * A[static_cast<size_t>(i) * lda + p];
+            const float* b = B + static_cast<size_t>(p) * ldb;
+            for (int j = 0; j < n; ++j) c[j] += a * b[j];
+        }
+    }
+}
+
+#endif // GEMV_JIT_H
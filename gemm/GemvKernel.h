@@ -0,0 +1,194 @@
+#ifndef GEMV_KERNEL_H
+#define GEMV_KERNEL_H
+
+#include <immintrin.h>  // AVX2 / AVX-512 intrinsics
+#include <cstddef>
+
+#include "Epilogue.h"
+
+// 生产用 GEMV 内核：y = alpha * A * x + beta * y
+// 与 gemv_kernel_opt2 相同的 4 累加器展开主循环，但：
+//   - 支持任意 n：剩余 < 8（AVX-512 为 < 16）的列用掩码加载处理，不再丢弃
+//   - 支持任意行跨度 lda，且不要求 32 字节对齐（全部使用非对齐加载）
+// 各 ISA 版本通过 target 属性单独编译，未加 -mavx2 的翻译单元也能包含本头文件并在运行时分派
+
+#define GEMV_TARGET_SSE4 __attribute__((target("sse4.1")))
+#define GEMV_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define GEMV_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+
+// 剩余 r (0 <= r < 8) 列的 AVX2 掩码：前 r 个通道最高位为 1
+GEMV_TARGET_AVX2 inline __m256i gemv_tail_mask_avx2(int r) {
+    static const int mask_table[16] = {-1, -1, -1, -1, -1, -1, -1, -1,
+                                       0, 0, 0, 0, 0, 0, 0, 0};
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask_table + 8 - r));
+}
+
+// 256 位水平加和
+GEMV_TARGET_AVX2 inline float gemv_hsum_avx2(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_hadd_ps(s, s);
+    s = _mm_hadd_ps(s, s);
+    return _mm_cvtss_f32(s);
+}
+
+// AVX2 单行点积，prefetch_floats > 0 时对 A 行做软件预取
+GEMV_TARGET_AVX2 inline float gemv_dot_avx2(const float* a, const float* x, int n, int prefetch_floats = 0) {
+    __m256 sum1 = _mm256_setzero_ps();
+    __m256 sum2 = _mm256_setzero_ps();
+    __m256 sum3 = _mm256_setzero_ps();
+    __m256 sum4 = _mm256_setzero_ps();
+
+    int j = 0;
+    // 主循环：一次 32 个元素（4 个 256 位向量）
+    for (; j + 32 <= n; j += 32) {
+        if (prefetch_floats > 0) {
+            _mm_prefetch(reinterpret_cast<const char*>(a + j + prefetch_floats), _MM_HINT_T0);
+        }
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j), _mm256_loadu_ps(x + j), sum1);
+        sum2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j + 8), _mm256_loadu_ps(x + j + 8), sum2);
+        sum3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j + 16), _mm256_loadu_ps(x + j + 16), sum3);
+        sum4 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j + 24), _mm256_loadu_ps(x + j + 24), sum4);
+    }
+    // 清理循环：不足 32 但至少 8 个
+    for (; j + 8 <= n; j += 8) {
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j), _mm256_loadu_ps(x + j), sum1);
+    }
+    // 尾部：剩余 < 8 个，掩码加载，越界通道读为 0 且不会触发访存异常
+    if (j < n) {
+        __m256i mask = gemv_tail_mask_avx2(n - j);
+        __m256 a_vec = _mm256_maskload_ps(a + j, mask);
+        __m256 x_vec = _mm256_maskload_ps(x + j, mask);
+        sum2 = _mm256_fmadd_ps(a_vec, x_vec, sum2);
+    }
+
+    sum1 = _mm256_add_ps(_mm256_add_ps(sum1, sum2), _mm256_add_ps(sum3, sum4));
+    return gemv_hsum_avx2(sum1);
+}
+
+// AVX-512 单行点积：一次 64 个元素，尾部用 k 掩码
+GEMV_TARGET_AVX512 inline float gemv_dot_avx512(const float* a, const float* x, int n, int prefetch_floats = 0) {
+    __m512 sum1 = _mm512_setzero_ps();
+    __m512 sum2 = _mm512_setzero_ps();
+    __m512 sum3 = _mm512_setzero_ps();
+    __m512 sum4 = _mm512_setzero_ps();
+
+    int j = 0;
+    for (; j + 64 <= n; j += 64) {
+        if (prefetch_floats > 0) {
+            _mm_prefetch(reinterpret_cast<const char*>(a + j + prefetch_floats), _MM_HINT_T0);
+        }
+        sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + j), _mm512_loadu_ps(x + j), sum1);
+        sum2 = _mm512_fmadd_ps(_mm512_loadu_ps(a + j + 16), _mm512_loadu_ps(x + j + 16), sum2);
+        sum3 = _mm512_fmadd_ps(_mm512_loadu_ps(a + j + 32), _mm512_loadu_ps(x + j + 32), sum3);
+        sum4 = _mm512_fmadd_ps(_mm512_loadu_ps(a + j + 48), _mm512_loadu_ps(x + j + 48), sum4);
+    }
+    for (; j + 16 <= n; j += 16) {
+        sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + j), _mm512_loadu_ps(x + j), sum1);
+    }
+    if (j < n) {
+        __mmask16 k = static_cast<__mmask16>((1u << (n - j)) - 1);
+        sum2 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(k, a + j), _mm512_maskz_loadu_ps(k, x + j), sum2);
+    }
+
+    sum1 = _mm512_add_ps(_mm512_add_ps(sum1, sum2), _mm512_add_ps(sum3, sum4));
+    return _mm512_reduce_add_ps(sum1);
+}
+
+// SSE4 单行点积：没有 AVX2 的老机器使用，一次 16 个元素
+GEMV_TARGET_SSE4 inline float gemv_dot_sse4(const float* a, const float* x, int n) {
+    __m128 sum1 = _mm_setzero_ps();
+    __m128 sum2 = _mm_setzero_ps();
+    __m128 sum3 = _mm_setzero_ps();
+    __m128 sum4 = _mm_setzero_ps();
+
+    int j = 0;
+    for (; j + 16 <= n; j += 16) {
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + j), _mm_loadu_ps(x + j)));
+        sum2 = _mm_add_ps(sum2, _mm_mul_ps(_mm_loadu_ps(a + j + 4), _mm_loadu_ps(x + j + 4)));
+        sum3 = _mm_add_ps(sum3, _mm_mul_ps(_mm_loadu_ps(a + j + 8), _mm_loadu_ps(x + j + 8)));
+        sum4 = _mm_add_ps(sum4, _mm_mul_ps(_mm_loadu_ps(a + j + 12), _mm_loadu_ps(x + j + 12)));
+    }
+    for (; j + 4 <= n; j += 4) {
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + j), _mm_loadu_ps(x + j)));
+    }
+    sum1 = _mm_add_ps(_mm_add_ps(sum1, sum2), _mm_add_ps(sum3, sum4));
+    sum1 = _mm_hadd_ps(sum1, sum1);
+    sum1 = _mm_hadd_ps(sum1, sum1);
+    float total = _mm_cvtss_f32(sum1);
+    for (; j < n; ++j) total += a[j] * x[j];  // SSE 没有掩码加载，尾部走标量
+    return total;
+}
+
+// 按编译目标选择最宽的点积实现
+inline float gemv_dot(const float* a, const float* x, int n, int prefetch_floats = 0) {
+#ifdef __AVX512F__
+    return gemv_dot_avx512(a, x, n, prefetch_floats);
+#else
+    return gemv_dot_avx2(a, x, n, prefetch_floats);
+#endif
+}
+
+// 合并 alpha/beta：beta == 0 时不读 y，避免未初始化的 y 把 NaN 带进结果
+inline float gemv_scale(float dot, float alpha, float beta, float y_old) {
+    return beta == 0.0f ? alpha * dot : alpha * dot + beta * y_old;
+}
+
+// 完整 GEMV：任意 m、n、lda（lda >= n，单位为元素），无对齐要求
+GEMV_TARGET_AVX2 inline void gemv_masked_avx2(const float* A, const float* x, float* y, int m, int n,
+                                              int lda, float alpha, float beta) {
+    for (int i = 0; i < m; ++i) {
+        float dot = gemv_dot_avx2(A + static_cast<size_t>(i) * lda, x, n);
+        y[i] = gemv_scale(dot, alpha, beta, y[i]);
+    }
+}
+
+GEMV_TARGET_AVX512 inline void gemv_masked_avx512(const float* A, const float* x, float* y, int m, int n,
+                                                  int lda, float alpha, float beta) {
+    for (int i = 0; i < m; ++i) {
+        float dot = gemv_dot_avx512(A + static_cast<size_t>(i) * lda, x, n);
+        y[i] = gemv_scale(dot, alpha, beta, y[i]);
+    }
+}
+
+GEMV_TARGET_SSE4 inline void gemv_masked_sse4(const float* A, const float* x, float* y, int m, int n,
+                                              int lda, float alpha, float beta) {
+    for (int i = 0; i < m; ++i) {
+        float dot = gemv_dot_sse4(A + static_cast<size_t>(i) * lda, x, n);
+        y[i] = gemv_scale(dot, alpha, beta, y[i]);
+    }
+}
+
+inline void gemv_masked(const float* A, const float* x, float* y, int m, int n, int lda,
+                        float alpha, float beta) {
+#ifdef __AVX512F__
+    gemv_masked_avx512(A, x, y, m, n, lda, alpha, beta);
+#else
+    gemv_masked_avx2(A, x, y, m, n, lda, alpha, beta);
+#endif
+}
+
+// 融合写回的 GEMV：y = ep(alpha * A * x + beta * y)
+// 每 W 行（编译目标的向量宽度）的点积收集成一个向量，整体合并 alpha / beta 并套用算子链后一次写回 y；
+// 偏置、激活、残差不再各自扫一遍 y。不足 W 行的尾部走标量版本
+// EpVec<__m256 / __m512> 会触发 -Wignored-attributes（见 Epilogue.h），只在这里关闭
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+template <class Ep>
+inline void gemv_fused(const float* A, const float* x, float* y, int m, int n, int lda, float alpha, float beta,
+                       const Ep& ep) {
+    using V = EpWideVec;
+    constexpr int W = EpVec<V>::width;
+    alignas(64) float dots[W];
+    int i = 0;
+    for (; i + W <= m; i += W) {
+        for (int r = 0; r < W; ++r) dots[r] = gemv_dot(A + static_cast<size_t>(i + r) * lda, x, n);
+        EpVec<V>::store(y + i, ep_finish(EpVec<V>::load(dots), y + i, alpha, beta, ep, EpilogueAt{0, i}));
+    }
+    for (; i < m; ++i) {
+        float dot = gemv_dot(A + static_cast<size_t>(i) * lda, x, n);
+        y[i] = ep_finish(dot, y + i, alpha, beta, ep, EpilogueAt{0, i});
+    }
+}
+#pragma GCC diagnostic pop
+
+#endif // GEMV_KERNEL_H
@@ -0,0 +1,95 @@
+#ifndef GEMV_PARALLEL_H
+#define GEMV_PARALLEL_H
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "GemvKernel.h"
+#include "ThreadPool.h"
+
+// 多线程 GEMV：y = alpha * A * x + beta * y
+// 按行把 A 切成连续分片交给常驻线程池，每个线程只读自己那一段 A，
+// 带宽受限的 GEMV 可以用满多个核的内存通道（readme 中的优化 3）
+
+// 并行 GEMV 配置
+struct GemvParallelConfig {
+    int page_size = 4096;          // 分片边界按页对齐，避免两个线程共享同一页
+    int prefetch_distance = 512;   // 行内软件预取距离（字节），0 表示关闭
+};
+
+// 单个线程负责的行区间
+struct GemvChunk {
+    int row_begin;
+    int row_end;
+    int prefetch_distance;  // 每个线程独立的预取距离，可按所在节点的延迟单独调整
+};
+
+// 按线程数切分行，分片边界对齐到页，保证首次访问（first touch）后每页只属于一个线程
+inline std::vector<GemvChunk> gemv_partition_rows(int m, int lda, int num_threads,
+                                                  const GemvParallelConfig& cfg = GemvParallelConfig()) {
+    int row_bytes = lda * static_cast<int>(sizeof(float));
+    int rows_per_page = std::max(1, cfg.page_size / std::max(1, row_bytes));  // 一页能装下的行数
+    int units = (m + rows_per_page - 1) / rows_per_page;                     // 以“页行组”为切分单位
+
+    std::vector<GemvChunk> chunks(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        int u0 = static_cast<int>(static_cast<long long>(units) * t / num_threads);
+        int u1 = static_cast<int>(static_cast<long long>(units) * (t + 1) / num_threads);
+        chunks[t].row_begin = std::min(m, u0 * rows_per_page);
+        chunks[t].row_end = std::min(m, u1 * rows_per_page);
+        chunks[t].prefetch_distance = cfg.prefetch_distance;
+    }
+    return chunks;
+}
+
+// 处理一个行区间，lda 为 A 的行跨度（元素个数）
+inline void gemv_rows(const float* A, const float* x, float* y, int n, int lda,
+                      float alpha, float beta, const GemvChunk& chunk) {
+    int prefetch_floats = chunk.prefetch_distance / static_cast<int>(sizeof(float));
+    for (int i = chunk.row_begin; i < chunk.row_end; ++i) {
+        float dot = gemv_dot(A + static_cast<size_t>(i) * lda, x, n, prefetch_floats);
+        y[i] = gemv_scale(dot, alpha, beta, y[i]);
+    }
+}
+
+// 首次访问初始化：由将来负责该分片的线程写入 A，
+// Linux 按 first-touch 分配物理页，线程绑核后这些页就落在该线程的本地 NUMA 节点
+inline void gemv_first_touch(float* A, int m, int lda, ThreadPool& pool,
+                             const GemvParallelConfig& cfg = GemvParallelConfig()) {
+    std::vector<GemvChunk> chunks = gemv_partition_rows(m, lda, pool.size(), cfg);
+    pool.run([&](int tid) {
+        const GemvChunk& c = chunks[tid];
+        if (c.row_end > c.row_begin) {
+            std::memset(A + static_cast<size_t>(c.row_begin) * lda, 0,
+                        static_cast<size_t>(c.row_end - c.row_begin) * lda * sizeof(float));
+        }
+    });
+}
+
+// 并行 GEMV 引擎：分片只计算一次，之后每次调用直接复用
+class GemvParallel {
+public:
+    GemvParallel(ThreadPool& pool, int m, int n, int lda,
+                 const GemvParallelConfig& cfg = GemvParallelConfig())
+        : pool_(pool), n_(n), lda_(lda),
+          chunks_(gemv_partition_rows(m, lda, pool.size(), cfg)) {}
+
+    // 单独调整某个线程的预取距离（字节）
+    void set_prefetch_distance(int tid, int bytes) { chunks_[tid].prefetch_distance = bytes; }
+
+    const std::vector<GemvChunk>& chunks() const { return chunks_; }
+
+    void operator()(const float* A, const float* x, float* y, float alpha, float beta) const {
+        pool_.run([&](int tid) {
+            gemv_rows(A, x, y, n_, lda_, alpha, beta, chunks_[tid]);
+        });
+    }
+
+private:
+    ThreadPool& pool_;
+    int n_, lda_;
+    std::vector<GemvChunk> chunks_;
+};
+
+#endif // GEMV_PARALLEL_H
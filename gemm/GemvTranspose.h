@@ -0,0 +1,235 @@
+#ifndef GEMV_TRANSPOSE_H
+#define GEMV_TRANSPOSE_H
+
+#include <immintrin.h>
+#include <algorithm>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "GemvDispatch.h"
+#include "GemvKernel.h"
+#include "GemvParallel.h"
+#include "ThreadPool.h"
+#include "../base/SlabAllocator.h"
+
+// 转置 GEMV：y = alpha * Aᵀ * x + beta * y，A 仍是行优先 m × n（行跨度 lda），x 长 m，y 长 n
+// 直接在原存储上计算，不构造转置副本。y = sum_i x[i] * A[i, :]，即逐行 AXPY：
+//   - y 按面板（AVX2 8 × 8 = 64 列，AVX-512 8 × 16 = 128 列）常驻寄存器，R = 4 行一组：
+//     面板加载一次 y，4 行 A 各做 8 次 FMA 后写回，A 的每个元素只读一次，4 条行流对硬件预取友好
+//   - 剩余整向量逐个处理，最后不足一个向量的列用掩码加载 / 存储
+//   - beta 先单独作用于 y（beta == 0 时直接清零、不读 y），alpha 合并进 x[i] 的广播
+// 列优先存储的 A 就是行优先的 Aᵀ，所以：
+//   列优先 A * x  -> 本文件的 AXPY 内核（gemv_colmajor）
+//   列优先 Aᵀ * x -> 行优先的点积内核 gemv()（gemv_colmajor_t）
+// 多线程版本 GemvTParallel 按行切分，各线程把部分和写进私有 y，再按列分段归约。
+
+constexpr int GEMV_T_ROWS = 4;    // 每组行数 R
+constexpr int GEMV_T_PANEL = 8;   // 每个面板的向量个数
+
+// ---------------- AVX2 ----------------
+
+// R 行 × V 个向量：y[0 .. 8V) += sum_r alpha * x[r] * A[r, 0 .. 8V)
+template <int R, int V>
+GEMV_TARGET_AVX2 inline void gemv_t_panel_avx2(const float* A, int lda, const float* x, float* y, float alpha) {
+    __m256 acc[V];
+    for (int v = 0; v < V; ++v) acc[v] = _mm256_loadu_ps(y + 8 * v);
+    for (int r = 0; r < R; ++r) {
+        const float* a = A + static_cast<size_t>(r) * lda;
+        __m256 xr = _mm256_set1_ps(alpha * x[r]);
+        for (int v = 0; v < V; ++v) acc[v] = _mm256_fmadd_ps(xr, _mm256_loadu_ps(a + 8 * v), acc[v]);
+    }
+    for (int v = 0; v < V; ++v) _mm256_storeu_ps(y + 8 * v, acc[v]);
+}
+
+// 不足 8 列的尾部
+template <int R>
+GEMV_TARGET_AVX2 inline void gemv_t_tail_avx2(const float* A, int lda, const float* x, float* y, float alpha,
+                                              int cols) {
+    __m256i mask = gemv_tail_mask_avx2(cols);
+    __m256 acc = _mm256_maskload_ps(y, mask);
+    for (int r = 0; r < R; ++r) {
+        __m256 xr = _mm256_set1_ps(alpha * x[r]);
+        acc = _mm256_fmadd_ps(xr, _mm256_maskload_ps(A + static_cast<size_t>(r) * lda, mask), acc);
+    }
+    _mm256_maskstore_ps(y, mask, acc);
+}
+
+template <int R>
+GEMV_TARGET_AVX2 inline void gemv_t_rows_avx2(const float* A, int lda, const float* x, float* y, int n,
+                                              float alpha) {
+    int j = 0;
+    for (; j + 8 * GEMV_T_PANEL <= n; j += 8 * GEMV_T_PANEL)
+        gemv_t_panel_avx2<R, GEMV_T_PANEL>(A + j, lda, x, y + j, alpha);
+    for (; j + 8 <= n; j += 8) gemv_t_panel_avx2<R, 1>(A + j, lda, x, y + j, alpha);
+    if (j < n) gemv_t_tail_avx2<R>(A + j, lda, x, y + j, alpha, n - j);
+}
+
+// y += alpha * A[0 .. m)ᵀ * x
+GEMV_TARGET_AVX2 inline void gemv_t_accumulate_avx2(const float* A, const float* x, float* y, int m, int n,
+                                                    int lda, float alpha) {
+    int i = 0;
+    for (; i + GEMV_T_ROWS <= m; i += GEMV_T_ROWS)
+        gemv_t_rows_avx2<GEMV_T_ROWS>(A + static_cast<size_t>(i) * lda, lda, x + i, y, n, alpha);
+    for (; i < m; ++i) gemv_t_rows_avx2<1>(A + static_cast<size_t>(i) * lda, lda, x + i, y, n, alpha);
+}
+
+// ---------------- AVX-512 ----------------
+
+template <int R, int V>
+GEMV_TARGET_AVX512 inline void gemv_t_panel_avx512(const float* A, int lda, const float* x, float* y, float alpha) {
+    __m512 acc[V];
+    for (int v = 0; v < V; ++v) acc[v] = _mm512_loadu_ps(y + 16 * v);
+    for (int r = 0; r < R; ++r) {
+        const float* a = A + static_cast<size_t>(r) * lda;
+        __m512 xr = _mm512_set1_ps(alpha * x[r]);
+        for (int v = 0; v < V; ++v) acc[v] = _mm512_fmadd_ps(xr, _mm512_loadu_ps(a + 16 * v), acc[v]);
+    }
+    for (int v = 0; v < V; ++v) _mm512_storeu_ps(y + 16 * v, acc[v]);
+}
+
+template <int R>
+GEMV_TARGET_AVX512 inline void gemv_t_tail_avx512(const float* A, int lda, const float* x, float* y, float alpha,
+                                                  int cols) {
+    __mmask16 k = static_cast<__mmask16>((1u << cols) - 1);
+    __m512 acc = _mm512_maskz_loadu_ps(k, y);
+    for (int r = 0; r < R; ++r) {
+        __m512 xr = _mm512_set1_ps(alpha * x[r]);
+        acc = _mm512_fmadd_ps(xr, _mm512_maskz_loadu_ps(k, A + static_cast<size_t>(r) * lda), acc);
+    }
+    _mm512_mask_storeu_ps(y, k, acc);
+}
+
+template <int R>
+GEMV_TARGET_AVX512 inline void gemv_t_rows_avx512(const float* A, int lda, const float* x, float* y, int n,
+                                                  float alpha) {
+    int j = 0;
+    for (; j + 16 * GEMV_T_PANEL <= n; j += 16 * GEMV_T_PANEL)
+        gemv_t_panel_avx512<R, GEMV_T_PANEL>(A + j, lda, x, y + j, alpha);
+    for (; j + 16 <= n; j += 16) gemv_t_panel_avx512<R, 1>(A + j, lda, x, y + j, alpha);
+    if (j < n) gemv_t_tail_avx512<R>(A + j, lda, x, y + j, alpha, n - j);
+}
+
+GEMV_TARGET_AVX512 inline void gemv_t_accumulate_avx512(const float* A, const float* x, float* y, int m, int n,
+                                                        int lda, float alpha) {
+    int i = 0;
+    for (; i + GEMV_T_ROWS <= m; i += GEMV_T_ROWS)
+        gemv_t_rows_avx512<GEMV_T_ROWS>(A + static_cast<size_t>(i) * lda, lda, x + i, y, n, alpha);
+    for (; i < m; ++i) gemv_t_rows_avx512<1>(A + static_cast<size_t>(i) * lda, lda, x + i, y, n, alpha);
+}
+
+// ---------------- 标量回退与分派 ----------------
+
+inline void gemv_t_accumulate_scalar(const float* A, const float* x, float* y, int m, int n, int lda, float alpha) {
+    for (int i = 0; i < m; ++i) {
+        const float* a = A + static_cast<size_t>(i) * lda;
+        const float xi = alpha * x[i];
+        for (int j = 0; j < n; ++j) y[j] += xi * a[j];
+    }
+}
+
+using GemvTAccumulateFn = void (*)(const float* A, const float* x, float* y, int m, int n, int lda, float alpha);
+
+inline GemvTAccumulateFn gemv_t_select(const CpuFeatures& cpu, const char** name = nullptr) {
+    auto pick = [&](GemvTAccumulateFn fn, const char* s) {
+        if (name) *name = s;
+        return fn;
+    };
+    if (cpu.avx512f && cpu.avx2 && cpu.fma) return pick(gemv_t_accumulate_avx512, "avx512");
+    if (cpu.avx2 && cpu.fma) return pick(gemv_t_accumulate_avx2, "avx2");
+    return pick(gemv_t_accumulate_scalar, "scalar");
+}
+
+// y += alpha * A[0 .. m)ᵀ * x，按 CPU 选择内核
+inline void gemv_t_accumulate(const float* A, const float* x, float* y, int m, int n, int lda, float alpha) {
+    static const GemvTAccumulateFn fn = gemv_t_select(CpuFeatures::get());
+    fn(A, x, y, m, n, lda, alpha);
+}
+
+// y = beta * y；beta == 0 时直接清零，不读 y（与 gemv_scale 的约定一致）
+inline void gemv_t_scale_y(float* y, int n, float beta) {
+    if (beta == 0.0f)
+        std::fill(y, y + n, 0.0f);
+    else if (beta != 1.0f)
+        for (int j = 0; j < n; ++j) y[j] *= beta;
+}
+
+// 行优先 A（m × n）：y[n] = alpha * Aᵀ * x[m] + beta * y
+inline void gemv_t(const float* A, const float* x, float* y, int m, int n, int lda, float alpha, float beta) {
+    gemv_t_scale_y(y, n, beta);
+    gemv_t_accumulate(A, x, y, m, n, lda, alpha);
+}
+
+inline void gemv_t(float alpha, const std::vector<float>& A, const std::vector<float>& x, float beta,
+                   std::vector<float>& y, int m, int n) {
+    gemv_t(A.data(), x.data(), y.data(), m, n, n, alpha, beta);
+}
+
+// 列优先 A（m × n，列跨度 lda >= m）：y[m] = alpha * A * x[n] + beta * y
+inline void gemv_colmajor(const float* A, const float* x, float* y, int m, int n, int lda, float alpha,
+                          float beta) {
+    gemv_t(A, x, y, n, m, lda, alpha, beta);
+}
+
+// 列优先 A（m × n）：y[n] = alpha * Aᵀ * x[m] + beta * y，每列连续，就是行优先的点积 GEMV
+inline void gemv_colmajor_t(const float* A, const float* x, float* y, int m, int n, int lda, float alpha,
+                            float beta) {
+    gemv(A, x, y, n, m, lda, alpha, beta);
+}
+
+// ---------------- 多线程：按行切分 + 私有 y 归约 ----------------
+// 阶段 1：线程 t 处理自己的行区间（分片与 GemvParallel 相同，按页对齐），部分和写进私有 y_t（首次写入由本线程完成）
+// 阶段 2：按列把 [0, n) 分段，每个线程把所有 y_t 的对应段相加，合并 beta 后写回 y
+// 私有缓冲区在构造时一次性分配，每个线程的起点按 64 字节对齐，线程之间没有伪共享。
+// 列优先 A * x 与行优先 Aᵀ * x 是同一个计算，按 (n, m) 构造即可复用。
+class GemvTParallel {
+public:
+    GemvTParallel(ThreadPool& pool, int m, int n, int lda, const GemvParallelConfig& cfg = GemvParallelConfig())
+        : pool_(pool), m_(m), n_(n), lda_(lda), stride_((n + 15) / 16 * 16),
+          chunks_(gemv_partition_rows(m, lda, pool.size(), cfg)),
+          partial_(pool.size() > 1 ? static_cast<size_t>(pool.size()) * stride_ : 0) {}
+
+    const std::vector<GemvChunk>& chunks() const { return chunks_; }
+
+    void operator()(const float* A, const float* x, float* y, float alpha, float beta) {
+        const int nt = pool_.size();
+        if (nt == 1) {
+            gemv_t(A, x, y, m_, n_, lda_, alpha, beta);
+            return;
+        }
+
+        pool_.run([&](int tid) {
+            float* yt = partial_.data() + static_cast<size_t>(tid) * stride_;
+            std::fill(yt, yt + n_, 0.0f);
+            const GemvChunk& c = chunks_[tid];
+            if (c.row_end > c.row_begin)
+                gemv_t_accumulate(A + static_cast<size_t>(c.row_begin) * lda_, x + c.row_begin, yt,
+                                  c.row_end - c.row_begin, n_, lda_, alpha);
+        });
+
+        pool_.run([&](int tid) {
+            // 列分段按 16 个 float 对齐，相邻线程不写同一条缓存行
+            const int units = stride_ / 16;
+            const int j0 = std::min(n_, units * tid / nt * 16);
+            const int j1 = std::min(n_, units * (tid + 1) / nt * 16);
+            if (j1 <= j0) return;
+            const float* y0 = partial_.data();
+            if (beta == 0.0f) {
+                for (int j = j0; j < j1; ++j) y[j] = y0[j];
+            } else {
+                for (int j = j0; j < j1; ++j) y[j] = y0[j] + beta * y[j];
+            }
+            for (int t = 1; t < nt; ++t) {
+                const float* yt = partial_.data() + static_cast<size_t>(t) * stride_;
+                for (int j = j0; j < j1; ++j) y[j] += yt[j];
+            }
+        });
+    }
+
+private:
+    ThreadPool& pool_;
+    int m_, n_, lda_, stride_;
+    std::vector<GemvChunk> chunks_;
+    std::vector<float, SlabAllocator<float>> partial_;  // nt × stride_ 的私有 y
+};
+
+#endif // GEMV_TRANSPOSE_H
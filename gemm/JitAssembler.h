@@ -0,0 +1,240 @@
+#ifndef JIT_ASSEMBLER_H
+#define JIT_ASSEMBLER_H
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#include <sys/mman.h>
+#include <unistd.h>
+#define JIT_SUPPORTED 1
+#else
+#define JIT_SUPPORTED 0
+#endif
+
+// 运行时生成 x86-64 机器码的最小汇编器：只覆盖 GemvJit.h 里的内核用到的指令。
+//   - 向量指令统一用 3 字节 VEX（xmm/ymm 0-15）或 EVEX（zmm 0-31、掩码 k1-k7）编码
+//   - 内存操作数只有 [base + disp]，disp 能放进 disp8 时用短编码（EVEX 按 N 压缩）
+//   - 常量池放在代码前面，通过 lea r11, [rip + disp] 取地址，代码与常量池一起映射，生成时就能算出位移
+// gemv_kernel_opt*.asm 是 nasm -f macho64 格式；这里直接写字节，Linux 和 macOS（x86-64）都能用，
+// 调用约定为 System V（rdi, rsi, rdx 传前三个指针参数）。
+
+namespace jit {
+
+enum Gpr { RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+// [base + disp]
+struct Mem {
+    int base;
+    int32_t disp;
+};
+
+class X86Assembler {
+public:
+    std::vector<uint8_t>& code() { return code_; }
+    size_t size() const { return code_.size(); }
+
+    void db(uint8_t b) { code_.push_back(b); }
+    void dd(uint32_t v) {
+        for (int i = 0; i < 4; ++i) db(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    // ---------------- 通用寄存器 ----------------
+
+    void ret() { db(0xC3); }
+    void vzeroupper() {
+        db(0xC5);
+        db(0xF8);
+        db(0x77);
+    }
+
+    // mov r32, imm32（写 32 位寄存器会清零高 32 位）
+    void mov(Gpr r, uint32_t imm) {
+        if (r >= 8) db(0x41);
+        db(static_cast<uint8_t>(0xB8 + (r & 7)));
+        dd(imm);
+    }
+
+    // add r64, imm32
+    void add(Gpr r, int32_t imm) {
+        db(static_cast<uint8_t>(0x48 | (r >= 8 ? 1 : 0)));
+        db(0x81);
+        db(static_cast<uint8_t>(0xC0 | (r & 7)));
+        dd(static_cast<uint32_t>(imm));
+    }
+
+    // dec r32
+    void dec(Gpr r) {
+        if (r >= 8) db(0x41);
+        db(0xFF);
+        db(static_cast<uint8_t>(0xC8 | (r & 7)));
+    }
+
+    // jnz 到已生成的位置 target
+    void jnz(size_t target) {
+        db(0x0F);
+        db(0x85);
+        dd(static_cast<uint32_t>(static_cast<int32_t>(target) - static_cast<int32_t>(code_.size() + 4)));
+    }
+
+    // lea r11, [rip + disp]：rel 是目标相对代码起点的偏移（常量池在代码前面时为负）
+    void lea_r11_rip(int64_t rel) {
+        db(0x4C);
+        db(0x8D);
+        db(0x1D);
+        dd(static_cast<uint32_t>(static_cast<int32_t>(rel - static_cast<int64_t>(code_.size() + 4))));
+    }
+
+    // ---------------- VEX ----------------
+
+    // L: 0 = 128 位，1 = 256 位；map: 1 = 0F, 2 = 0F38, 3 = 0F3A；pp: 0 = 无, 1 = 66, 2 = F3, 3 = F2
+    void vex(int map, int pp, int L, int W, uint8_t op, int reg, int vvvv, int rm) {
+        vex_prefix(map, pp, L, W, reg, vvvv, rm);
+        db(op);
+        db(static_cast<uint8_t>(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+    }
+    void vex(int map, int pp, int L, int W, uint8_t op, int reg, int vvvv, const Mem& m) {
+        vex_prefix(map, pp, L, W, reg, vvvv, m.base);
+        db(op);
+        modrm_mem(reg, m, 1);
+    }
+
+    void vmovups(int L, int dst, const Mem& m) { vex(1, 0, L, 0, 0x10, dst, 0, m); }
+    void vmovups(int L, const Mem& m, int src) { vex(1, 0, L, 0, 0x11, src, 0, m); }
+    void vmovss(int dst, const Mem& m) { vex(1, 2, 0, 0, 0x10, dst, 0, m); }
+    void vmovss(const Mem& m, int src) { vex(1, 2, 0, 0, 0x11, src, 0, m); }
+    void vxorps(int L, int dst, int a, int b) { vex(1, 0, L, 0, 0x57, dst, a, b); }
+    void vaddps(int L, int dst, int a, int b) { vex(1, 0, L, 0, 0x58, dst, a, b); }
+    void vaddps(int L, int dst, int a, const Mem& m) { vex(1, 0, L, 0, 0x58, dst, a, m); }
+    void vmulps(int L, int dst, int a, int b) { vex(1, 0, L, 0, 0x59, dst, a, b); }
+    void vaddss(int dst, int a, const Mem& m) { vex(1, 2, 0, 0, 0x58, dst, a, m); }
+    void vmulss(int dst, int a, int b) { vex(1, 2, 0, 0, 0x59, dst, a, b); }
+    void vhaddps(int L, int dst, int a, int b) { vex(1, 3, L, 0, 0x7C, dst, a, b); }
+    void vbroadcastss(int L, int dst, int src_xmm) { vex(2, 1, L, 0, 0x18, dst, 0, src_xmm); }
+    void vbroadcastss(int L, int dst, const Mem& m) { vex(2, 1, L, 0, 0x18, dst, 0, m); }
+    // dst += a * b
+    void vfmadd231ps(int L, int dst, int a, int b) { vex(2, 1, L, 0, 0xB8, dst, a, b); }
+    void vfmadd231ps(int L, int dst, int a, const Mem& m) { vex(2, 1, L, 0, 0xB8, dst, a, m); }
+    void vfmadd231ss(int dst, int a, const Mem& m) { vex(2, 1, 0, 0, 0xB9, dst, a, m); }
+    // 掩码最高位为 1 的通道才读 / 写，其余通道读出 0、不写内存（不会越界触发缺页）
+    void vmaskmovps(int L, int dst, int mask, const Mem& m) { vex(2, 1, L, 0, 0x2C, dst, mask, m); }
+    void vmaskmovps(int L, const Mem& m, int mask, int src) { vex(2, 1, L, 0, 0x2E, src, mask, m); }
+    void vextractf128(int dst_xmm, int src_ymm, uint8_t imm) {
+        vex(3, 1, 1, 0, 0x19, src_ymm, 0, dst_xmm);
+        db(imm);
+    }
+    void vmovd(int dst_xmm, Gpr src) { vex(1, 1, 0, 0, 0x6E, dst_xmm, 0, src); }
+    void kmovw(int k, Gpr src) { vex(1, 0, 0, 0, 0x92, k, 0, src); }
+
+    // ---------------- EVEX（512 位） ----------------
+
+    // aaa: 掩码寄存器编号（0 表示不带掩码），z: 零掩码，bcast: 内存操作数按 {1toN} 广播
+    void evex(int map, int pp, int W, uint8_t op, int reg, int vvvv, int rm, int aaa = 0, bool z = false) {
+        evex_prefix(map, pp, W, reg, vvvv, rm, false, aaa, z, false);
+        db(op);
+        db(static_cast<uint8_t>(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+    }
+    // N: disp8 压缩的缩放因子（整向量访问为 64，标量 / 广播为 4）
+    void evex(int map, int pp, int W, uint8_t op, int reg, int vvvv, const Mem& m, int N, int aaa = 0, bool z = false,
+              bool bcast = false) {
+        evex_prefix(map, pp, W, reg, vvvv, m.base, true, aaa, z, bcast);
+        db(op);
+        modrm_mem(reg, m, N);
+    }
+
+    void vmovups_z(int dst, const Mem& m, int k = 0) { evex(1, 0, 0, 0x10, dst, 0, m, 64, k, k != 0); }
+    void vmovups_z(const Mem& m, int src, int k = 0) { evex(1, 0, 0, 0x11, src, 0, m, 64, k, false); }
+    void vfmadd231ps_z(int dst, int a, int b) { evex(2, 1, 0, 0xB8, dst, a, b); }
+    void vfmadd231ps_z(int dst, int a, const Mem& m) { evex(2, 1, 0, 0xB8, dst, a, m, 64); }
+    void vfmadd231ps_z_bcast(int dst, int a, const Mem& m) { evex(2, 1, 0, 0xB8, dst, a, m, 4, 0, false, true); }
+    void vaddps_z(int dst, int a, int b) { evex(1, 0, 0, 0x58, dst, a, b); }
+    void vmulps_z(int dst, int a, int b) { evex(1, 0, 0, 0x59, dst, a, b); }
+    void vbroadcastss_z(int dst, int src_xmm) { evex(2, 1, 0, 0x18, dst, 0, src_xmm); }
+    void vextractf64x4(int dst_ymm, int src_zmm, uint8_t imm) {
+        evex(3, 1, 1, 0x1B, src_zmm, 0, dst_ymm);
+        db(imm);
+    }
+
+private:
+    void vex_prefix(int map, int pp, int L, int W, int reg, int vvvv, int rm) {
+        db(0xC4);
+        db(static_cast<uint8_t>(((reg & 8) ? 0 : 0x80) | 0x40 | ((rm & 8) ? 0 : 0x20) | map));
+        db(static_cast<uint8_t>((W << 7) | ((~vvvv & 15) << 3) | (L << 2) | pp));
+    }
+
+    void evex_prefix(int map, int pp, int W, int reg, int vvvv, int rm, bool mem, int aaa, bool z, bool bcast) {
+        db(0x62);
+        int x = mem ? 1 : ((rm & 16) ? 0 : 1);  // 寄存器操作数的第 4 位放在 X 位
+        db(static_cast<uint8_t>(((reg & 8) ? 0 : 0x80) | (x << 6) | ((rm & 8) ? 0 : 0x20) | ((reg & 16) ? 0 : 0x10) |
+                                map));
+        db(static_cast<uint8_t>((W << 7) | ((~vvvv & 15) << 3) | 0x04 | pp));
+        db(static_cast<uint8_t>((z ? 0x80 : 0) | (2 << 5) | (bcast ? 0x10 : 0) | ((vvvv & 16) ? 0 : 0x08) | aaa));
+    }
+
+    // 总是带位移（mod = 01 / 10），避开 rbp / r13 在 mod = 00 时表示 RIP 相对寻址的特例
+    void modrm_mem(int reg, const Mem& m, int N) {
+        const bool short_disp = m.disp % N == 0 && m.disp / N >= -128 && m.disp / N <= 127;
+        db(static_cast<uint8_t>((short_disp ? 0x40 : 0x80) | ((reg & 7) << 3) | (m.base & 7)));
+        if ((m.base & 7) == RSP) db(0x24);  // rsp / r12 作基址时需要 SIB
+        if (short_disp)
+            db(static_cast<uint8_t>(static_cast<int8_t>(m.disp / N)));
+        else
+            dd(static_cast<uint32_t>(m.disp));
+    }
+
+    std::vector<uint8_t> code_;
+};
+
+// 可执行内存：常量池 + 代码一起复制进来后改为只读可执行（W^X）
+class JitCode {
+public:
+    JitCode() = default;
+
+    JitCode(const std::vector<uint8_t>& pool, const std::vector<uint8_t>& code) {
+#if JIT_SUPPORTED
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_ = (pool.size() + code.size() + page - 1) / page * page;
+        void* p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+        base_ = static_cast<uint8_t*>(p);
+        if (!pool.empty()) std::memcpy(base_, pool.data(), pool.size());
+        std::memcpy(base_ + pool.size(), code.data(), code.size());
+        if (mprotect(base_, size_, PROT_READ | PROT_EXEC) != 0) {
+            munmap(base_, size_);
+            throw std::bad_alloc();
+        }
+        entry_ = base_ + pool.size();
+        code_size_ = code.size();
+#else
+        (void)pool;
+        (void)code;
+#endif
+    }
+
+    ~JitCode() {
+#if JIT_SUPPORTED
+        if (base_) munmap(base_, size_);
+#endif
+    }
+
+    JitCode(const JitCode&) = delete;
+    JitCode& operator=(const JitCode&) = delete;
+
+    template <typename Fn>
+    Fn entry() const {
+        return reinterpret_cast<Fn>(entry_);
+    }
+    size_t code_size() const { return code_size_; }
+
+private:
+    uint8_t* base_ = nullptr;
+    uint8_t* entry_ = nullptr;
+    size_t size_ = 0;
+    size_t code_size_ = 0;
+};
+
+}  // namespace jit
+
+#endif // JIT_ASSEMBLER_H
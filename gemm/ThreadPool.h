@@ -0,0 +1,139 @@
+#ifndef GEMM_THREAD_POOL_H
+#define GEMM_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// 常驻线程池：线程只创建一次，每次 run() 把同一个任务广播给所有线程
+// 调用线程自身作为 0 号线程参与计算，run() 返回时所有线程都已完成
+class ThreadPool {
+public:
+    // num_threads: 参与计算的线程总数（包括调用线程）
+    // pin_threads: 是否把第 t 个线程绑定到第 t 个 CPU（保证首次访问的页留在本地 NUMA 节点）
+    //   调用线程原来的亲和性在构造时保存，线程池析构时恢复，不会在线程池之外一直绑在 CPU 0 上
+    explicit ThreadPool(int num_threads = std::thread::hardware_concurrency(), bool pin_threads = true)
+        : num_threads_(num_threads > 0 ? num_threads : 1) {
+        if (pin_threads) {
+            save_caller_affinity();
+            pin_to_cpu(0);
+        }
+        for (int t = 1; t < num_threads_; ++t) {
+            workers_.emplace_back([this, t, pin_threads] {
+                if (pin_threads) pin_to_cpu(t);
+                worker_loop(t);
+            });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            ++generation_;
+        }
+        start_cv_.notify_all();
+        for (auto& w : workers_) w.join();
+        restore_caller_affinity();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return num_threads_; }
+
+    // 在所有线程上执行 task(tid)，tid 取值 [0, size())
+    void run(const std::function<void(int)>& task) {
+        if (num_threads_ == 1) {
+            task(0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &task;
+            pending_ = num_threads_ - 1;
+            ++generation_;
+        }
+        start_cv_.notify_all();
+
+        task(0);  // 调用线程负责 0 号分片
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return pending_ == 0; });
+        task_ = nullptr;
+    }
+
+private:
+    void worker_loop(int tid) {
+        unsigned long seen = 0;
+        while (true) {
+            const std::function<void(int)>* task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_cv_.wait(lock, [&] { return generation_ != seen; });
+                seen = generation_;
+                if (stop_) return;
+                task = task_;
+            }
+            (*task)(tid);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--pending_ == 0) done_cv_.notify_one();
+            }
+        }
+    }
+
+    void save_caller_affinity() {
+#ifdef __linux__
+        caller_ = pthread_self();
+        CPU_ZERO(&caller_set_);
+        caller_saved_ = pthread_getaffinity_np(caller_, sizeof(caller_set_), &caller_set_) == 0;
+#endif
+    }
+
+    // 只在构造线程上恢复：在别的线程析构时原线程可能已经退出
+    void restore_caller_affinity() {
+#ifdef __linux__
+        if (caller_saved_ && pthread_equal(caller_, pthread_self()))
+            pthread_setaffinity_np(caller_, sizeof(caller_set_), &caller_set_);
+#endif
+    }
+
+    static void pin_to_cpu(int cpu) {
+#ifdef __linux__
+        int ncpu = static_cast<int>(std::thread::hardware_concurrency());
+        if (ncpu <= 0) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu % ncpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)cpu;  // macOS 不支持硬绑定，交给调度器
+#endif
+    }
+
+    int num_threads_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    const std::function<void(int)>* task_ = nullptr;
+    unsigned long generation_ = 0;  // 每次 run() 递增，唤醒等待中的线程
+    int pending_ = 0;               // 尚未完成当前任务的工作线程数
+    bool stop_ = false;
+#ifdef __linux__
+    pthread_t caller_{};
+    cpu_set_t caller_set_;
+    bool caller_saved_ = false;  // 构造时绑定了调用线程，析构时需要恢复
+#endif
+};
+
+#endif // GEMM_THREAD_POOL_H
@@ -60,6 +60,7 @@ void gemv_kernel(float* A, float* x, float* y, int m, int n, float alpha, float
 
             // 注意：汇编版忽略了剩余 < 8 的元素，这里也保持一致
             // 若需完全正确性，可添加标量循环处理剩余元素
+            // 生产环境请使用 GemvKernel.h 中的 gemv_masked：任意 n / lda，掩码加载处理尾部
         }
 
         // 合并累加器
@@ -0,0 +1,192 @@
+#include <algorithm>        // 用于 std::max
+#include <chrono>           // 用于性能计时
+#include <cmath>            // 用于 std::tanh
+#include <cstdlib>          // 用于 std::aligned_alloc
+#include <iostream>         // 用于标准输入输出
+#include <random>           // 用于生成随机测试数据
+#include <vector>           // 用于向量存储
+
+#include "Epilogue.h"
+#include "GemvKernel.h"
+#include "../tilesize/GemmPacked.h"
+
+/*
+编译：
+g++ -O3 -mavx2 -mfma -std=c++17 main_epilogue.cpp -o epilogue
+（加 -mavx512f 使用 AVX-512 微内核与 512 位写回）
+执行：./epilogue
+
+一层全连接：C = GELU(A * B + bias) + residual
+  分开做：GEMM 写 C，再分别扫一遍 C 加偏置、做 GELU、加残差（每遍都读写整个 C）
+  融合：  gemm_packed_fused / gemv_fused 在寄存器块写回时一次完成
+先对照标量参考（std::tanh 版 GELU）检查结果，含边界块、多个 K 面板与 beta != 0，再比较耗时。
+融合路径的 mc 截断为 GEMM_FUSED_MC，分开做的 GEMM 同时给出默认分块与相同分块两种耗时，
+加速比按相同分块计算，只反映省掉的扫描；耗时取多次运行中最快的一次。
+*/
+
+using namespace epilogue;
+
+static float gelu_ref(float x) {
+    return 0.5f * x * (1.0f + std::tanh(0.7978845608f * (x + 0.044715f * x * x * x)));
+}
+
+static std::vector<float> random_vector(size_t n, std::mt19937& gen) {
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> v(n);
+    for (auto& e : v) e = dist(gen);
+    return v;
+}
+
+static float max_rel_err(const std::vector<float>& y, const std::vector<float>& ref) {
+    float err = 0.0f;
+    for (size_t i = 0; i < y.size(); ++i) err = std::max(err, std::fabs(y[i] - ref[i]) / (1.0f + std::fabs(ref[i])));
+    return err;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wignored-attributes"  // EpVec<__m256 / __m512>，见 Epilogue.h
+// 单个算子单独扫一遍 m × n 的 C（未融合的做法，向量化方式与融合版相同）
+template <class Op>
+static void sweep(float* C, int m, int n, int ldc, const Op& op) {
+    using V = EpWideVec;
+    constexpr int W = EpVec<V>::width;
+    for (int i = 0; i < m; ++i) {
+        float* c = C + static_cast<size_t>(i) * ldc;
+        int j = 0;
+        for (; j + W <= n; j += W) EpVec<V>::store(c + j, op(EpVec<V>::load(c + j), EpilogueAt{i, j}));
+        for (; j < n; ++j) c[j] = op(c[j], EpilogueAt{i, j});
+    }
+}
+#pragma GCC diagnostic pop
+
+static bool check_gemm(const TileSize& ts, const CacheConfig& cache) {
+    std::mt19937 gen(5);
+    bool ok = true;
+    // 行列都不是微内核的整数倍；K 足够大时跨多个 kc 面板
+    for (auto shape : {std::make_tuple(7, 13, 5), std::make_tuple(50, 70, 33), std::make_tuple(97, 131, 1000)}) {
+        const int M = std::get<0>(shape), N = std::get<1>(shape), K = std::get<2>(shape);
+        std::vector<float> A = random_vector(static_cast<size_t>(M) * K, gen), B = random_vector(static_cast<size_t>(K) * N, gen);
+        std::vector<float> bias = random_vector(N, gen), R = random_vector(static_cast<size_t>(M) * N, gen);
+        std::vector<float> C0 = random_vector(static_cast<size_t>(M) * N, gen);
+        const float alpha = 0.5f, beta = -0.25f;
+
+        std::vector<float> ref(C0.size());
+        for (int i = 0; i < M; ++i)
+            for (int j = 0; j < N; ++j) {
+                double s = 0.0;
+                for (int k = 0; k < K; ++k) s += static_cast<double>(A[static_cast<size_t>(i) * K + k]) * B[static_cast<size_t>(k) * N + j];
+                const size_t o = static_cast<size_t>(i) * N + j;
+                ref[o] = gelu_ref(static_cast<float>(alpha * s + beta * C0[o]) + bias[j]) + R[o];
+            }
+
+        std::vector<float> C = C0;
+        gemm_packed_fused(A.data(), B.data(), C.data(), M, N, K, ts, alpha, beta,
+                          make_epilogue(Bias{bias.data()}, Gelu{}, Residual{R.data(), N}), cache);
+        float err = max_rel_err(C, ref);
+        std::cout << "  GEMM " << M << "x" << N << "x" << K << ": error " << err << "\n";
+        ok &= err < 1e-4f;
+    }
+    return ok;
+}
+
+static bool check_gemv() {
+    std::mt19937 gen(6);
+    bool ok = true;
+    for (int m : {5, 16, 37, 100}) {
+        const int n = 45, lda = 48;
+        std::vector<float> A = random_vector(static_cast<size_t>(m) * lda, gen), x = random_vector(n, gen);
+        std::vector<float> bias = random_vector(m, gen), r = random_vector(m, gen), y0 = random_vector(m, gen);
+        std::vector<float> ref(m);
+        for (int i = 0; i < m; ++i) {
+            double s = 0.0;
+            for (int j = 0; j < n; ++j) s += static_cast<double>(A[static_cast<size_t>(i) * lda + j]) * x[j];
+            ref[i] = std::max(0.0f, static_cast<float>(2.0 * s + 0.5 * y0[i]) + bias[i]) * 3.0f + r[i];
+        }
+        std::vector<float> y = y0;
+        gemv_fused(A.data(), x.data(), y.data(), m, n, lda, 2.0f, 0.5f,
+                   make_epilogue(Bias{bias.data()}, Relu{}, Scale{3.0f}, Residual{r.data(), 0}));
+        float err = max_rel_err(y, ref);
+        ok &= err < 1e-5f;
+        if (err >= 1e-5f) std::cout << "  GEMV m=" << m << ": error " << err << "\n";
+    }
+    std::cout << "  GEMV: " << (ok ? "OK" : "FAILED") << "\n";
+    return ok;
+}
+
+// 取最快的一次：单核虚拟机上平均值受干扰很大
+template <typename F>
+static double time_ms(F&& f, int iters) {
+    f();  // 预热
+    double best = 0.0;
+    for (int it = 0; it < iters; ++it) {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        auto end = std::chrono::high_resolution_clock::now();
+        double t = std::chrono::duration<double, std::milli>(end - start).count();
+        best = it == 0 ? t : std::min(best, t);
+    }
+    return best;
+}
+
+int main() {
+    CacheConfig cache;
+    TileSizeCalculator calculator(cache);
+
+    std::cout << "correctness\n";
+    bool ok = check_gemm(calculator.compute(128, 128, 256), cache);
+    ok &= check_gemv();
+
+    std::mt19937 gen(42);
+    std::cout << "\nGEMM + bias + GELU + residual\n";
+    // K 小时 GEMM 本身很快，后处理扫描 C 的开销占比最大
+    for (auto shape : {std::make_tuple(4096, 1024, 64), std::make_tuple(2048, 1024, 256), std::make_tuple(1024, 1024, 1024)}) {
+        const int M = std::get<0>(shape), N = std::get<1>(shape), K = std::get<2>(shape);
+        TileSize ts = calculator.compute(M, N, K);
+        std::vector<float> A = random_vector(static_cast<size_t>(M) * K, gen), B = random_vector(static_cast<size_t>(K) * N, gen);
+        std::vector<float> bias = random_vector(N, gen), R = random_vector(static_cast<size_t>(M) * N, gen);
+        std::vector<float> C(static_cast<size_t>(M) * N), C_sep(C.size());
+        const GemmBlocking bk = gemm_blocking_from_tiles(ts, cache, M, N, K);
+        float* a_pack = static_cast<float*>(std::aligned_alloc(64, (gemm_pack_a_size(bk) * sizeof(float) + 63) / 64 * 64));
+        float* b_pack = static_cast<float*>(std::aligned_alloc(64, (gemm_pack_b_size(bk) * sizeof(float) + 63) / 64 * 64));
+
+        auto separate = [&](const GemmBlocking& blocking) {
+            std::fill(C_sep.begin(), C_sep.end(), 0.0f);
+            gemm_packed(A.data(), K, B.data(), N, C_sep.data(), N, M, N, K, blocking, a_pack, b_pack);
+            sweep(C_sep.data(), M, N, N, Bias{bias.data()});
+            sweep(C_sep.data(), M, N, N, Gelu{});
+            sweep(C_sep.data(), M, N, N, Residual{R.data(), N});
+        };
+        double t_sep = time_ms([&] { separate(bk); }, 7);
+        double t_sep_same = time_ms([&] { separate(gemm_blocking_fused(bk)); }, 7);
+        double t_fused = time_ms([&] {
+            gemm_packed_fused(A.data(), K, B.data(), N, C.data(), N, M, N, K, bk, a_pack, b_pack, 1.0f, 0.0f,
+                              make_epilogue(Bias{bias.data()}, Gelu{}, Residual{R.data(), N}));
+        }, 7);
+        std::free(a_pack);
+        std::free(b_pack);
+        std::cout << "  " << M << "x" << N << "x" << K << ": separate " << t_sep << " ms (mc " << bk.mc << "), "
+                  << t_sep_same << " ms (mc " << gemm_blocking_fused(bk).mc << "), fused " << t_fused
+                  << " ms, speedup " << t_sep_same / t_fused << "x, diff " << max_rel_err(C, C_sep) << "\n";
+    }
+
+    std::cout << "\nGEMV + bias + ReLU + residual\n";
+    {
+        const int m = 16384, n = 1024;
+        std::vector<float> A = random_vector(static_cast<size_t>(m) * n, gen), x = random_vector(n, gen);
+        std::vector<float> bias = random_vector(m, gen), r = random_vector(m, gen), y(m), y_sep(m);
+        double t_sep = time_ms([&] {
+            gemv_masked(A.data(), x.data(), y_sep.data(), m, n, n, 1.0f, 0.0f);
+            sweep(y_sep.data(), 1, m, m, Bias{bias.data()});
+            sweep(y_sep.data(), 1, m, m, Relu{});
+            sweep(y_sep.data(), 1, m, m, Residual{r.data(), 0});
+        }, 10);
+        double t_fused = time_ms([&] {
+            gemv_fused(A.data(), x.data(), y.data(), m, n, n, 1.0f, 0.0f,
+                       make_epilogue(Bias{bias.data()}, Relu{}, Residual{r.data(), 0}));
+        }, 10);
+        std::cout << "  " << m << "x" << n << ": separate " << t_sep << " ms, fused " << t_fused << " ms, diff "
+                  << max_rel_err(y, y_sep) << " (y 只有 m 个元素，GEMV 的收益主要在省掉的 kernel 调用)\n";
+    }
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
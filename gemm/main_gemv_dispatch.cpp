@@ -0,0 +1,61 @@
+#include <iostream>         // 用于标准输入输出
+#include <vector>           // 用于动态数组存储矩阵和向量
+#include <chrono>           // 用于性能计时
+#include <random>           // 用于生成随机测试数据
+#include <cmath>            // 用于 std::fabs
+
+#include "GemvDispatch.h"
+
+/*
+编译（注意不加 -mavx2，内核由 target 属性单独编译，运行时分派）：
+g++ -O3 -std=c++17 main_gemv_dispatch.cpp -o gemv_dispatch
+执行：./gemv_dispatch
+*/
+
+// 朴素实现，作为正确性参考
+void gemv_naive(float alpha, const std::vector<float>& A, const std::vector<float>& x,
+                float beta, std::vector<float>& y, int m, int n) {
+    for (int i = 0; i < m; ++i) {
+        float sum = 0.0f;
+        for (int j = 0; j < n; ++j) sum += A[i * n + j] * x[j];
+        y[i] = alpha * sum + beta * y[i];
+    }
+}
+
+// 测试一种形状：对比朴素实现并计时
+bool test_shape(int m, int n) {
+    std::vector<float> A(m * n), x(n), y(m), y_ref(m);
+    std::mt19937 gen(m + n);
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    for (auto& v : A) v = dis(gen);
+    for (auto& v : x) v = dis(gen);
+    for (int i = 0; i < m; ++i) y[i] = y_ref[i] = dis(gen);
+
+    gemv_naive(1.0f, A, x, 0.5f, y_ref, m, n);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    gemv(1.0f, A, x, 0.5f, y, m, n);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+    GemvShape shape = gemv_classify(m, n);
+    float max_err = 0.0f;
+    for (int i = 0; i < m; ++i) max_err = std::max(max_err, std::fabs(y[i] - y_ref[i]) / std::fabs(y_ref[i]));
+    bool ok = max_err < 1e-4f;
+    std::cout << m << "x" << n << " [" << gemv_shape_name(shape) << "] -> "
+              << gemv_dispatch_table().name[static_cast<int>(shape)] << ", "
+              << duration.count() << " microseconds, max rel err " << max_err
+              << (ok ? "" : " (MISMATCH)") << "\n";
+    return ok;
+}
+
+int main() {
+    CpuFeatures::get().print();
+
+    bool ok = true;
+    ok &= test_shape(65536, 24);    // 瘦高
+    ok &= test_shape(1024, 1024);   // 方阵
+    ok &= test_shape(64, 65537);    // 矮宽，奇数列
+    ok &= test_shape(1000, 37);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+#include <algorithm>        // 用于 std::max
+#include <chrono>           // 用于性能计时
+#include <cmath>            // 用于 std::fabs
+#include <cstdlib>          // 用于 std::atoi
+#include <iostream>         // 用于标准输入输出
+#include <random>           // 用于生成随机测试数据
+#include <vector>           // 用于向量存储
+
+#include "GemvDispatch.h"
+#include "GemvHalf.h"
+
+/*
+编译：
+g++ -O3 -std=c++17 main_gemv_f16.cpp -o gemv_f16
+执行：./gemv_f16 [行数] [列数]
+
+A 分别以 fp32、fp16、bf16 存储做 GEMV，对比耗时与有效带宽（按各自的字节数计）。
+正确性：16 位内核的结果与"先反量化回 fp32 再做 fp32 GEMV"一致，与原始 fp32 结果的差距即量化误差。
+*/
+
+// 双精度参考：y = A * x
+static std::vector<float> reference(const std::vector<float>& A, const std::vector<float>& x, int m, int n, int lda) {
+    std::vector<float> y(m);
+    for (int i = 0; i < m; ++i) {
+        double s = 0.0;
+        for (int j = 0; j < n; ++j) s += static_cast<double>(A[static_cast<size_t>(i) * lda + j]) * x[j];
+        y[i] = static_cast<float>(s);
+    }
+    return y;
+}
+
+static float max_rel_err(const std::vector<float>& y, const std::vector<float>& ref) {
+    float scale = 0.0f, err = 0.0f;
+    for (size_t i = 0; i < y.size(); ++i) {
+        scale = std::max(scale, std::fabs(ref[i]));
+        err = std::max(err, std::fabs(y[i] - ref[i]));
+    }
+    return err / std::max(scale, 1e-30f);
+}
+
+// 标量转换与 F16C 硬件转换逐位一致（含舍入、非规格化数、溢出）
+static bool check_conversion() {
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<uint32_t> bits;
+    std::vector<float> v(1 << 16);
+    for (auto& f : v) {
+        uint32_t u = bits(gen);
+        u = (u & 0x8FFFFFFF) | (static_cast<uint32_t>(100 + u % 60) << 23);  // 指数集中在 fp16 范围附近
+        std::memcpy(&f, &u, sizeof(f));
+    }
+    v[0] = 65519.0f;  // 舍入到 65504
+    v[1] = 65520.0f;  // 舍入到 Inf
+    v[2] = 5.96e-8f;  // 最小非规格化数附近
+    std::vector<uint16_t> soft(v.size()), hard(v.size());
+    for (size_t i = 0; i < v.size(); ++i) soft[i] = float_to_f16(v[i]);
+    pack_f16(v.data(), hard.data(), v.size());
+    int mismatch = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        mismatch += soft[i] != hard[i];
+        float back = f16_to_float(soft[i]);
+        mismatch += float_to_f16(back) != soft[i];  // 往返不变
+    }
+    std::cout << "fp16 conversion: " << mismatch << " mismatches"
+              << (CpuFeatures::get().f16c ? " (vs F16C)" : " (no F16C, roundtrip only)") << "\n";
+    return mismatch == 0;
+}
+
+// 不同 n（含尾部）、lda、alpha / beta 下 16 位内核与反量化后的 fp32 GEMV 对照
+static bool check_kernels() {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    bool ok = true;
+    for (int n : {1, 7, 8, 15, 16, 33, 100, 257}) {
+        const int m = 13, lda = n + 5;
+        std::vector<float> A(static_cast<size_t>(m) * lda), x(n), y0(m);
+        for (auto& a : A) a = dist(gen);
+        for (auto& v : x) v = dist(gen);
+        for (auto& v : y0) v = dist(gen);
+        for (int bf : {0, 1}) {
+            std::vector<uint16_t> A16 = bf ? quantize_bf16(A) : quantize_f16(A);
+            std::vector<float> Aq = bf ? dequantize_bf16(A16) : dequantize_f16(A16);
+            std::vector<float> y = y0, y_ref = y0;
+            if (bf)
+                gemv_bf16(A16.data(), x.data(), y.data(), m, n, lda, 1.5f, -0.5f);
+            else
+                gemv_f16(A16.data(), x.data(), y.data(), m, n, lda, 1.5f, -0.5f);
+            gemv_scalar_unrolled(Aq.data(), x.data(), y_ref.data(), m, n, lda, 1.5f, -0.5f);
+            float err = max_rel_err(y, y_ref);
+            if (err > 1e-5f) {
+                std::cout << "  " << (bf ? "bf16" : "fp16") << " n=" << n << " error " << err << "\n";
+                ok = false;
+            }
+        }
+    }
+    std::cout << "kernels vs dequantized fp32: " << (ok ? "OK" : "FAILED") << "\n";
+    return ok;
+}
+
+template <typename F>
+static double time_us(F&& f, int iters) {
+    f();  // 预热
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int it = 0; it < iters; ++it) f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iters;
+}
+
+int main(int argc, char** argv) {
+    int m = argc > 1 ? std::atoi(argv[1]) : 8192;
+    int n = argc > 2 ? std::atoi(argv[2]) : 8192;  // 默认 fp32 256 MB，远大于 LLC
+
+    CpuFeatures::get().print();
+    const char* f16_name = nullptr;
+    const char* bf16_name = nullptr;
+    gemv_half_select<false>(CpuFeatures::get(), &f16_name);
+    gemv_half_select<true>(CpuFeatures::get(), &bf16_name);
+    std::cout << "fp16 kernel: " << f16_name << ", bf16 kernel: " << bf16_name << "\n";
+
+    bool ok = check_conversion();
+    ok &= check_kernels();
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> A(static_cast<size_t>(m) * n), x(n), y(m);
+    for (auto& a : A) a = dist(gen);
+    for (auto& v : x) v = dist(gen);
+    std::vector<uint16_t> A_f16 = quantize_f16(A), A_bf16 = quantize_bf16(A);
+
+    // 量化误差：相对双精度参考（只取前 256 行）
+    const int check_rows = std::min(m, 256);
+    std::vector<float> y_ref = reference(A, x, check_rows, n, n);
+    auto head_err = [&](const std::vector<float>& y) {
+        return max_rel_err(std::vector<float>(y.begin(), y.begin() + check_rows), y_ref);
+    };
+
+    const int iters = 10;
+    const double elems = static_cast<double>(m) * n;
+    std::cout << "\nGEMV " << m << "x" << n << "\n";
+
+    double t32 = time_us([&] { gemv(A.data(), x.data(), y.data(), m, n, n, 1.0f, 0.0f); }, iters);
+    std::cout << "  fp32: " << t32 << " us, " << elems * 4 / (t32 * 1e3) << " GB/s, error " << head_err(y) << "\n";
+
+    double t16 = time_us([&] { gemv_f16(A_f16.data(), x.data(), y.data(), m, n, n, 1.0f, 0.0f); }, iters);
+    std::cout << "  fp16: " << t16 << " us, " << elems * 2 / (t16 * 1e3) << " GB/s, error " << head_err(y)
+              << ", speedup " << t32 / t16 << "x\n";
+
+    double tbf = time_us([&] { gemv_bf16(A_bf16.data(), x.data(), y.data(), m, n, n, 1.0f, 0.0f); }, iters);
+    std::cout << "  bf16: " << tbf << " us, " << elems * 2 / (tbf * 1e3) << " GB/s, error " << head_err(y)
+              << ", speedup " << t32 / tbf << "x\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+#include <algorithm>        // 用于 std::max
+#include <chrono>           // 用于性能计时
+#include <cmath>            // 用于 std::fabs
+#include <cstdlib>          // 用于 std::atoi
+#include <iostream>         // 用于标准输入输出
+#include <random>           // 用于生成随机测试数据
+#include <vector>           // 用于向量存储
+
+#include "GemvBatch.h"
+#include "GemvDispatch.h"
+#include "GemvInt8.h"
+
+/*
+编译：
+g++ -O3 -std=c++17 -pthread main_gemv_int8.cpp -o gemv_int8
+执行：./gemv_int8 [行数] [列数] [批量]
+
+对本机支持的每种 int8 内核（AVX512-VNNI / AVX-VNNI / AVX2 vpmaddubsw / 标量）：
+  1. 与标量内核在同一份量化数据上的结果逐位一致（整数点积精确，写回公式相同）
+  2. 与 fp32 结果的相对误差在量化误差范围内（对称 / 非对称两种权重量化）
+  3. GEMV 与批量 GEMM 相对 fp32 gemv / gemv_batch 的耗时
+*/
+
+static std::vector<float> random_vector(size_t n, std::mt19937& gen, float lo = -1.0f, float hi = 1.0f) {
+    std::uniform_real_distribution<float> dist(lo, hi);
+    std::vector<float> v(n);
+    for (auto& e : v) e = dist(gen);
+    return v;
+}
+
+static float max_rel_err(const std::vector<float>& y, const std::vector<float>& ref) {
+    float scale = 0.0f, err = 0.0f;
+    for (size_t i = 0; i < y.size(); ++i) {
+        scale = std::max(scale, std::fabs(ref[i]));
+        err = std::max(err, std::fabs(y[i] - ref[i]));
+    }
+    return err / std::max(scale, 1e-30f);
+}
+
+static std::vector<Int8Isa> available_isas() {
+    std::vector<Int8Isa> isas = {Int8Isa::Scalar};
+    const CpuFeatures& cpu = CpuFeatures::get();
+    if (cpu.avx2) isas.push_back(Int8Isa::Avx2);
+    if (cpu.avx_vnni && cpu.avx2) isas.push_back(Int8Isa::AvxVnni);
+    if (cpu.avx512_vnni && cpu.avx512bw && cpu.avx2) isas.push_back(Int8Isa::Avx512Vnni);
+    return isas;
+}
+
+static bool check(const std::vector<Int8Isa>& isas) {
+    std::mt19937 gen(3);
+    bool ok = true;
+    for (Int8Scheme scheme : {Int8Scheme::Symmetric, Int8Scheme::Asymmetric}) {
+        const char* scheme_name = scheme == Int8Scheme::Symmetric ? "symmetric" : "asymmetric";
+        for (int n : {1, 31, 64, 100, 333}) {
+            for (int b : {1, 3, 6}) {
+                const int m = 11, lda = n + 3, ldx = b + 1, ldy = b + 2;
+                // 非对称量化用偏移的权重（全为正）体现零点的作用
+                std::vector<float> A = scheme == Int8Scheme::Symmetric
+                                           ? random_vector(static_cast<size_t>(m) * lda, gen)
+                                           : random_vector(static_cast<size_t>(m) * lda, gen, 0.5f, 1.5f);
+                std::vector<float> X = random_vector(static_cast<size_t>(n) * ldx, gen);
+                std::vector<float> Y0 = random_vector(static_cast<size_t>(m) * ldy, gen);
+                Int8Matrix A8 = quantize_int8_rows(A.data(), m, n, lda, scheme);
+
+                std::vector<float> ref = Y0;
+                for (int i = 0; i < m; ++i)
+                    for (int c = 0; c < b; ++c) {
+                        double s = 0.0;
+                        for (int j = 0; j < n; ++j)
+                            s += static_cast<double>(A[static_cast<size_t>(i) * lda + j]) * X[static_cast<size_t>(j) * ldx + c];
+                        ref[static_cast<size_t>(i) * ldy + c] = static_cast<float>(1.5 * s - 0.5 * Y0[static_cast<size_t>(i) * ldy + c]);
+                    }
+
+                for (Int8Isa isa : isas) {
+                    Int8Vectors xq;
+                    quantize_int8_vectors(X.data(), n, b, ldx, isa, xq);
+                    std::vector<float> Y = Y0, Y_scalar = Y0;
+                    gemm_int8(A8, xq, Y.data(), ldy, 1.5f, -0.5f, isa);
+                    gemm_int8(A8, xq, Y_scalar.data(), ldy, 1.5f, -0.5f, Int8Isa::Scalar);
+                    bool exact = Y == Y_scalar;
+                    // 误差界：A 与 X 各自的半个量化步长（7 位 X 的步长是 8 位的两倍）
+                    float tol = isa == Int8Isa::Avx2 ? 0.04f : 0.025f;
+                    float err = max_rel_err(Y, ref);
+                    if (!exact || err > tol) {
+                        std::cout << "  " << int8_isa_name(isa) << " " << scheme_name << " n=" << n << " b=" << b
+                                  << (exact ? "" : " differs from scalar") << ", error " << err << "\n";
+                        ok = false;
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "correctness: " << (ok ? "OK" : "FAILED") << "\n";
+    return ok;
+}
+
+template <typename F>
+static double time_us(F&& f, int iters) {
+    f();  // 预热
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int it = 0; it < iters; ++it) f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iters;
+}
+
+int main(int argc, char** argv) {
+    int m = argc > 1 ? std::atoi(argv[1]) : 8192;
+    int n = argc > 2 ? std::atoi(argv[2]) : 8192;
+    int b = argc > 3 ? std::atoi(argv[3]) : 16;
+
+    CpuFeatures::get().print();
+    std::vector<Int8Isa> isas = available_isas();
+    std::cout << "best int8 kernel: " << int8_isa_name(int8_best_isa()) << "\n";
+    bool ok = check(isas);
+
+    std::mt19937 gen(42);
+    std::vector<float> A = random_vector(static_cast<size_t>(m) * n, gen), x = random_vector(n, gen), y(m);
+    std::vector<float> X = random_vector(static_cast<size_t>(n) * b, gen), Y(static_cast<size_t>(m) * b);
+    Int8Matrix A8 = quantize_int8_rows(A, m, n, Int8Scheme::Symmetric);
+
+    const int iters = 10;
+    const double elems = static_cast<double>(m) * n;
+    std::cout << "\nGEMV " << m << "x" << n << "\n";
+    double t32 = time_us([&] { gemv(A.data(), x.data(), y.data(), m, n, n, 1.0f, 0.0f); }, iters);
+    std::vector<float> y_ref = y;
+    std::cout << "  fp32:          " << t32 << " us, " << elems * 4 / (t32 * 1e3) << " GB/s\n";
+    for (Int8Isa isa : isas) {
+        if (isa == Int8Isa::Scalar) continue;
+        double t8 = time_us([&] { gemv_int8(A8, x.data(), y.data(), 1.0f, 0.0f, isa); }, iters);
+        std::cout << "  " << int8_isa_name(isa) << ": " << t8 << " us, " << elems / (t8 * 1e3) << " GB/s, speedup "
+                  << t32 / t8 << "x, error " << max_rel_err(y, y_ref) << "\n";
+    }
+
+    std::cout << "\nGEMM " << m << "x" << n << " x " << b << " vectors\n";
+    double tb32 = time_us([&] { gemv_batch(A.data(), X.data(), Y.data(), m, n, b); }, 3);
+    std::vector<float> Y_ref = Y;
+    std::cout << "  fp32 gemv_batch: " << tb32 << " us, " << 2.0 * elems * b / (tb32 * 1e3) << " GFLOP/s\n";
+    for (Int8Isa isa : isas) {
+        if (isa == Int8Isa::Scalar) continue;
+        double tb8 = time_us([&] { gemm_int8(A8, X.data(), b, b, Y.data(), b, 1.0f, 0.0f, isa); }, 3);
+        std::cout << "  " << int8_isa_name(isa) << ": " << tb8 << " us, " << 2.0 * elems * b / (tb8 * 1e3)
+                  << " GOP/s, speedup " << tb32 / tb8 << "x, error " << max_rel_err(Y, Y_ref) << "\n";
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include <iostream>         // 用于标准输入输出
+#include <vector>           // 用于动态数组存储矩阵和向量
+#include <chrono>           // 用于性能计时
+#include <random>           // 用于生成随机测试数据
+#include <cmath>            // 用于 std::fabs
+#include <string>
+
+#include "GemvKernel.h"
+
+/*
+编译（AVX2）：
+g++ -O3 -mavx2 -mfma -std=c++17 main_gemv_kernel_tail.cpp -o gemv_tail
+编译（AVX-512）：
+g++ -O3 -mavx512f -mavx2 -mfma -std=c++17 main_gemv_kernel_tail.cpp -o gemv_tail
+执行：./gemv_tail
+*/
+
+// 朴素实现，作为正确性参考（支持 lda）
+void gemv_naive(const float* A, const float* x, float* y, int m, int n, int lda, float alpha, float beta) {
+    for (int i = 0; i < m; ++i) {
+        double sum = 0.0;
+        for (int j = 0; j < n; ++j) sum += static_cast<double>(A[static_cast<size_t>(i) * lda + j]) * x[j];
+        y[i] = static_cast<float>(alpha * sum + beta * y[i]);
+    }
+}
+
+// 检查一种形状：A 与 x 都故意偏移 1 个 float，保证不是 32 字节对齐
+bool check_shape(int m, int n, int lda) {
+    std::mt19937 gen(m * 131 + n);
+    std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+    std::vector<float> A_buf(static_cast<size_t>(m) * lda + 1), x_buf(n + 1), y(m), y_ref(m);
+    float* A = A_buf.data() + 1;
+    float* x = x_buf.data() + 1;
+    for (auto& v : A_buf) v = dis(gen);
+    for (auto& v : x_buf) v = dis(gen);
+    for (int i = 0; i < m; ++i) y[i] = y_ref[i] = dis(gen);
+
+    gemv_naive(A, x, y_ref.data(), m, n, lda, 0.75f, -0.5f);
+    gemv_masked(A, x, y.data(), m, n, lda, 0.75f, -0.5f);
+
+    for (int i = 0; i < m; ++i) {
+        if (std::fabs(y[i] - y_ref[i]) > 1e-4f * (1.0f + std::fabs(y_ref[i]))) {
+            std::cerr << "Mismatch m=" << m << " n=" << n << " lda=" << lda << " row " << i
+                      << ": " << y[i] << " vs " << y_ref[i] << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+#ifdef __AVX512F__
+    std::cout << "Kernel: AVX-512 (k-mask tail)\n";
+#else
+    std::cout << "Kernel: AVX2 (maskload tail)\n";
+#endif
+
+    // 覆盖 n = 1..130 以及 lda > n 的情况
+    bool ok = true;
+    for (int n = 1; n <= 130 && ok; ++n) {
+        ok = check_shape(7, n, n) && check_shape(5, n, n + 3);
+    }
+    ok = ok && check_shape(33, 4099, 4099);
+    std::cout << (ok ? "All shapes match naive reference.\n" : "Shape check FAILED.\n");
+
+    // 奇数形状的性能：以前只能走朴素回退
+    int m = 2048, n = 1023;
+    std::vector<float> A(static_cast<size_t>(m) * n, 0.5f), x(n, 1.0f), y(m, 0.0f);
+    auto start = std::chrono::high_resolution_clock::now();
+    gemv_masked(A.data(), x.data(), y.data(), m, n, n, 1.0f, 0.0f);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Masked GEMV " << m << "x" << n << " took " << duration.count() << " microseconds\n";
+    std::cout << "y[0] = " << y[0] << " (expected " << 0.5f * n << ")\n";
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include <iostream>         // 用于标准输入输出
+#include <vector>           // 用于动态数组存储矩阵和向量
+#include <chrono>           // 用于性能计时
+#include <random>           // 用于生成随机测试数据
+#include <cmath>            // 用于 std::fabs
+#include <cstdlib>          // 用于 std::atoi
+#include <thread>           // 用于 hardware_concurrency
+
+#include "GemvParallel.h"
+#include "../base/HugePageBuffer.h"
+
+/*
+编译：
+g++ -O3 -mavx2 -mfma -std=c++17 -pthread main_gemv_parallel.cpp -o gemv_parallel
+执行：./gemv_parallel [线程数]
+*/
+
+// 朴素实现，作为正确性参考
+void gemv_naive(float alpha, const float* A, const float* x, float beta, float* y, int m, int n) {
+    for (int i = 0; i < m; ++i) {
+        float sum = 0.0f;
+        for (int j = 0; j < n; ++j) sum += A[static_cast<size_t>(i) * n + j] * x[j];
+        y[i] = alpha * sum + beta * y[i];
+    }
+}
+
+int main(int argc, char** argv) {
+    int num_threads = argc > 1 ? std::atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency());
+    int m = 8192, n = 4100;  // n 故意取非 8 的倍数，覆盖清理循环
+    float alpha = 1.5f, beta = 0.5f;
+
+    ThreadPool pool(num_threads);
+    std::cout << "Threads: " << pool.size() << "\n";
+
+    // A 放在大页上（不可用时回退普通页），并由各自负责的线程完成首次访问
+    HugePageBuffer A_buf(static_cast<size_t>(m) * n * sizeof(float));
+    float* A = A_buf.as<float>();
+    gemv_first_touch(A, m, n, pool);
+    std::cout << "A: " << A_buf.describe() << "\n";
+
+    std::vector<float> x(n), y(m), y_ref(m);
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    for (size_t i = 0; i < static_cast<size_t>(m) * n; ++i) A[i] = dis(gen);
+    for (int i = 0; i < n; ++i) x[i] = dis(gen);
+    for (int i = 0; i < m; ++i) y[i] = y_ref[i] = dis(gen);
+
+    GemvParallel gemv(pool, m, n, n);
+    for (const GemvChunk& c : gemv.chunks()) {
+        std::cout << "  rows [" << c.row_begin << ", " << c.row_end << ")\n";
+    }
+
+    // 正确性检查
+    gemv_naive(alpha, A, x.data(), beta, y_ref.data(), m, n);
+    gemv(A, x.data(), y.data(), alpha, beta);
+    float max_err = 0.0f;
+    for (int i = 0; i < m; ++i) max_err = std::max(max_err, std::fabs(y[i] - y_ref[i]) / std::fabs(y_ref[i]));
+    std::cout << "Max relative error vs naive: " << max_err << (max_err < 1e-4f ? " (OK)\n" : " (MISMATCH)\n");
+
+    // 性能测试：多次调用取平均
+    const int iters = 20;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int it = 0; it < iters; ++it) gemv(A, x.data(), y.data(), alpha, 0.0f);
+    auto end = std::chrono::high_resolution_clock::now();
+    double us = std::chrono::duration<double, std::micro>(end - start).count() / iters;
+    double gbs = static_cast<double>(m) * n * sizeof(float) / (us * 1e3);
+    std::cout << "Parallel GEMV took " << us << " microseconds, " << gbs << " GB/s\n";
+
+    return max_err < 1e-4f ? 0 : 1;
+}
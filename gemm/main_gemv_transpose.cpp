@@ -0,0 +1,190 @@
+#include <algorithm>        // 用于 std::max
+#include <chrono>           // 用于性能计时
+#include <cmath>            // 用于 std::fabs
+#include <cstdlib>          // 用于 std::atoi
+#include <iostream>         // 用于标准输入输出
+#include <random>           // 用于生成随机测试数据
+#include <thread>           // 用于 hardware_concurrency
+#include <tuple>            // 用于测试形状
+#include <vector>           // 用于向量存储
+
+#include "GemvTranspose.h"
+
+/*
+编译：
+g++ -O3 -std=c++17 -pthread main_gemv_transpose.cpp -o gemv_transpose
+执行：./gemv_transpose [线程数]
+
+y = Aᵀ x（A 行优先）与列优先 A 的 GEMV：
+  1. 每种 AXPY 内核（AVX-512 / AVX2 / 标量）对照双精度参考，覆盖列尾部、m % 4 余行、lda > n 与不同 alpha / beta
+  2. 列优先包装 gemv_colmajor / gemv_colmajor_t 与多线程 GemvTParallel（私有 y 归约）
+  3. 8192 × 8192 上 A x、Aᵀ x（转置副本 + gemv）与 Aᵀ x（gemv_t）的耗时
+*/
+
+static std::vector<float> random_vector(size_t n, std::mt19937& gen) {
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> v(n);
+    for (auto& e : v) e = dist(gen);
+    return v;
+}
+
+static float max_rel_err(const std::vector<float>& y, const std::vector<float>& ref) {
+    float err = 0.0f;
+    for (size_t i = 0; i < y.size(); ++i) err = std::max(err, std::fabs(y[i] - ref[i]) / (1.0f + std::fabs(ref[i])));
+    return err;
+}
+
+// 行优先 A（m × n）：ref = alpha * Aᵀ x + beta * y0
+static std::vector<float> reference_t(const std::vector<float>& A, const std::vector<float>& x, const std::vector<float>& y0,
+                                      int m, int n, int lda, float alpha, float beta) {
+    std::vector<float> ref(n);
+    for (int j = 0; j < n; ++j) {
+        double s = 0.0;
+        for (int i = 0; i < m; ++i) s += static_cast<double>(A[static_cast<size_t>(i) * lda + j]) * x[i];
+        ref[j] = static_cast<float>(alpha * s + (beta == 0.0f ? 0.0 : static_cast<double>(beta) * y0[j]));
+    }
+    return ref;
+}
+
+static bool check_kernels() {
+    const CpuFeatures& cpu = CpuFeatures::get();
+    std::vector<std::pair<GemvTAccumulateFn, const char*>> kernels = {{gemv_t_accumulate_scalar, "scalar"}};
+    if (cpu.avx2 && cpu.fma) kernels.push_back({gemv_t_accumulate_avx2, "avx2"});
+    if (cpu.avx512f && cpu.avx2 && cpu.fma) kernels.push_back({gemv_t_accumulate_avx512, "avx512"});
+
+    std::mt19937 gen(7);
+    bool ok = true;
+    for (auto& k : kernels) {
+        bool k_ok = true;
+        for (int m : {1, 3, 4, 7, 33}) {
+            for (int n : {1, 5, 8, 16, 63, 64, 129, 300}) {
+                const int lda = n + 5;
+                std::vector<float> A = random_vector(static_cast<size_t>(m) * lda, gen), x = random_vector(m, gen);
+                std::vector<float> y0 = random_vector(n, gen);
+                for (auto ab : {std::make_pair(1.0f, 0.0f), std::make_pair(1.0f, 1.0f), std::make_pair(1.5f, -0.5f)}) {
+                    std::vector<float> ref = reference_t(A, x, y0, m, n, lda, ab.first, ab.second);
+                    std::vector<float> y = y0;
+                    gemv_t_scale_y(y.data(), n, ab.second);
+                    k.first(A.data(), x.data(), y.data(), m, n, lda, ab.first);
+                    float err = max_rel_err(y, ref);
+                    if (err > 1e-5f) {
+                        std::cout << "  " << k.second << " m=" << m << " n=" << n << " alpha=" << ab.first
+                                  << " beta=" << ab.second << ": error " << err << "\n";
+                        k_ok = false;
+                    }
+                }
+            }
+        }
+        std::cout << "  " << k.second << ": " << (k_ok ? "OK" : "FAILED") << "\n";
+        ok &= k_ok;
+    }
+    return ok;
+}
+
+static bool check_colmajor_and_parallel() {
+    std::mt19937 gen(8);
+    bool ok = true;
+    // 列优先 A：m × n，列跨度 lda；按行优先看就是 n × m 的 Aᵀ
+    const int m = 517, n = 301, lda = 520;
+    std::vector<float> A = random_vector(static_cast<size_t>(n) * lda, gen);
+    std::vector<float> xn = random_vector(n, gen), xm = random_vector(m, gen);
+    std::vector<float> ym0 = random_vector(m, gen), yn0 = random_vector(n, gen);
+
+    std::vector<float> ref_ax(m), ref_atx(n);
+    for (int i = 0; i < m; ++i) {
+        double s = 0.0;
+        for (int j = 0; j < n; ++j) s += static_cast<double>(A[static_cast<size_t>(j) * lda + i]) * xn[j];
+        ref_ax[i] = static_cast<float>(2.0 * s - 0.5 * ym0[i]);
+    }
+    for (int j = 0; j < n; ++j) {
+        double s = 0.0;
+        for (int i = 0; i < m; ++i) s += static_cast<double>(A[static_cast<size_t>(j) * lda + i]) * xm[i];
+        ref_atx[j] = static_cast<float>(2.0 * s - 0.5 * yn0[j]);
+    }
+
+    std::vector<float> y = ym0;
+    gemv_colmajor(A.data(), xn.data(), y.data(), m, n, lda, 2.0f, -0.5f);
+    float err = max_rel_err(y, ref_ax);
+    std::cout << "  gemv_colmajor A x:    error " << err << "\n";
+    ok &= err < 1e-5f;
+
+    y = yn0;
+    gemv_colmajor_t(A.data(), xm.data(), y.data(), m, n, lda, 2.0f, -0.5f);
+    err = max_rel_err(y, ref_atx);
+    std::cout << "  gemv_colmajor_t Aᵀ x: error " << err << "\n";
+    ok &= err < 1e-5f;
+
+    // 多线程：行优先 n × m 的 Aᵀ x 即列优先 A x；线程数不整除行数、列数
+    for (int nt : {1, 3, 4}) {
+        ThreadPool pool(nt, false);
+        GemvTParallel gemv_tp(pool, n, m, lda);
+        for (float beta : {0.0f, -0.5f}) {
+            y = ym0;
+            gemv_tp(A.data(), xn.data(), y.data(), 2.0f, beta);
+            std::vector<float> ref = reference_t(A, xn, ym0, n, m, lda, 2.0f, beta);
+            err = max_rel_err(y, ref);
+            if (err > 1e-5f) {
+                std::cout << "  GemvTParallel threads=" << nt << " beta=" << beta << ": error " << err << "\n";
+                ok = false;
+            }
+        }
+    }
+    std::cout << "  GemvTParallel: " << (ok ? "OK" : "FAILED") << "\n";
+    return ok;
+}
+
+template <typename F>
+static double time_us(F&& f, int iters) {
+    f();  // 预热
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int it = 0; it < iters; ++it) f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iters;
+}
+
+int main(int argc, char** argv) {
+    int num_threads = argc > 1 ? std::atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency());
+
+    const char* name = nullptr;
+    gemv_t_select(CpuFeatures::get(), &name);
+    std::cout << "gemv_t kernel: " << name << "\n";
+
+    std::cout << "correctness\n";
+    bool ok = check_kernels();
+    ok &= check_colmajor_and_parallel();
+
+    const int m = 8192, n = 8192, iters = 10;
+    std::mt19937 gen(42);
+    std::vector<float> A = random_vector(static_cast<size_t>(m) * n, gen), AT(A.size());
+    std::vector<float> xm = random_vector(m, gen), xn = random_vector(n, gen), y(n), y_ref(n);
+    const double gb = static_cast<double>(m) * n * sizeof(float) / 1e3;
+
+    std::cout << "\n" << m << "x" << n << "\n";
+    double t_ax = time_us([&] { gemv(A.data(), xn.data(), y.data(), m, n, n, 1.0f, 0.0f); }, iters);
+    std::cout << "  A x (gemv):               " << t_ax << " us, " << gb / t_ax << " GB/s\n";
+
+    // 先转置再调用点积 GEMV：转置本身要读写整个矩阵一次
+    double t_copy = time_us([&] {
+        constexpr int B = 32;
+        for (int i0 = 0; i0 < m; i0 += B)
+            for (int j0 = 0; j0 < n; j0 += B)
+                for (int i = i0; i < std::min(i0 + B, m); ++i)
+                    for (int j = j0; j < std::min(j0 + B, n); ++j)
+                        AT[static_cast<size_t>(j) * m + i] = A[static_cast<size_t>(i) * n + j];
+        gemv(AT.data(), xm.data(), y_ref.data(), n, m, m, 1.0f, 0.0f);
+    }, iters);
+    std::cout << "  Aᵀ x (transpose + gemv):  " << t_copy << " us\n";
+
+    double t_t = time_us([&] { gemv_t(A.data(), xm.data(), y.data(), m, n, n, 1.0f, 0.0f); }, iters);
+    std::cout << "  Aᵀ x (gemv_t):            " << t_t << " us, " << gb / t_t << " GB/s, vs copy "
+              << t_copy / t_t << "x, diff " << max_rel_err(y, y_ref) << "\n";
+
+    ThreadPool pool(num_threads);
+    GemvTParallel gemv_tp(pool, m, n, n);
+    double t_p = time_us([&] { gemv_tp(A.data(), xm.data(), y.data(), 1.0f, 0.0f); }, iters);
+    std::cout << "  Aᵀ x (GemvTParallel, " << pool.size() << " threads): " << t_p << " us, " << gb / t_p
+              << " GB/s, diff " << max_rel_err(y, y_ref) << "\n";
+
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
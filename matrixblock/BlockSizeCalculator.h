@@ -7,10 +7,8 @@
 #include <cstdlib>
 #include <cstring>
 
-// macOS 特定头文件
-#ifdef __APPLE__
-#include <sys/sysctl.h> // macOS sysctl API
-#endif
+#include "../Head/CacheTopology.h"
+#include "../Head/PaddedMatrix.h"
 
 // 缓存信息结构体
 template <typename T>
@@ -32,6 +30,9 @@ public:
     static void compute_block_sizes(const CacheInfo<T>& cache, int rows_A, int cols_A,
                                     int rows_B, int cols_B,
                                     int& M, int& K, int& N);
+
+    // 按缓存的组数（容量 / (路数 × 行大小)）为 cols 列的行主序矩阵选择前导维，避免二次幂宽度的行落在同一组
+    static int leading_dim(const CacheInfo<T>& cache, int cols);
 };
 
 // 获取缓存信息（兼容 macOS 和 Linux）
@@ -39,52 +40,24 @@ template <typename T>
 CacheInfo<T> BlockSizeCalculator<T>::get_cache_info(const std::string& cache_type) {
     CacheInfo<T> info = {0};
 
-#ifdef __linux__ // Linux 系统
-    std::ifstream file("/proc/cpuinfo");
-    if (!file.is_open()) return info;
-
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.find(cache_type) != std::string::npos) {
-            size_t pos = line.find(':');
-            if (pos != std::string::npos) {
-                std::string value_str = line.substr(pos + 1);
-                int size_kb;
-                if (std::sscanf(value_str.c_str(), "%dKB", &size_kb) == 1) {
-                    info.size = size_kb * 1024; // 转换为字节
-                }
-            }
-        } else if (line.find("cache line size") != std::string::npos) {
-            int line_size;
-            std::sscanf(line.c_str(), "%*[^:]: %d", &line_size);
-            info.line_size = line_size;
-        }
-    }
-
-#elif defined(__APPLE__) // macOS 系统
-    size_t len = sizeof(info.size);
-
-    if (cache_type == "L1d cache") {
-        int mib[2] = {CTL_HW, HW_L1DCACHESIZE};
-        sysctl(mib, 2, &info.size, &len, nullptr, 0);
-    } else if (cache_type == "L2 cache") {
-        int mib[2] = {CTL_HW, HW_L2CACHESIZE};
-        sysctl(mib, 2, &info.size, &len, nullptr, 0);
-    } else if (cache_type == "L3 cache") {
-        int mib[2] = {CTL_HW, HW_L3CACHESIZE};
-        sysctl(mib, 2, &info.size, &len, nullptr, 0);
-    }
-
-    // 默认缓存行大小（假设64字节）
-    info.line_size = 64;
-
-#else
-#error "Unsupported platform"
-#endif
-
+    // 从 sysfs 缓存拓扑取数：/proc/cpuinfo 中并没有各级缓存容量的行，
+    // 旧实现在 Linux 上得到 size = 0，分块退化
+    const CacheLevelInfo* cache = CacheTopology::get().data_cache(cache_level_from_name(cache_type));
+    if (!cache) return info;
+    info.size = static_cast<int>(cache->blocking_size());  // 共享的 L3 只算本线程的份额
+    info.line_size = cache->line_size;
+    info.associativity = cache->ways;
     return info;
 }
 
+template <typename T>
+int BlockSizeCalculator<T>::leading_dim(const CacheInfo<T>& cache, int cols) {
+    if (cache.associativity <= 0 || cache.line_size <= 0) return cols;  // 几何未知（或全相联）时不填充
+    // 组数按 size 推算，size 对 L1 / L2 是整体容量；共享 L3 的 size 是分块份额，不能用在这里
+    int sets = cache.size / (cache.associativity * cache.line_size);
+    return padded_leading_dim(cols, sizeof(T), cache.line_size, sets);
+}
+
 // 根据缓存大小和矩阵维度动态计算分块尺寸
 template <typename T>
 void BlockSizeCalculator<T>::compute_block_sizes(const CacheInfo<T>& cache, int rows_A, int cols_A,
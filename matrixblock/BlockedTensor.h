@@ -0,0 +1,268 @@
+#ifndef BLOCKED_TENSOR_H
+#define BLOCKED_TENSOR_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "TileTensor.h"
+#include "../base/SlabAllocator.h"
+
+// N 维分块张量：按 compute_block_sizes 算出的块尺寸真正重排数据。
+//
+// 存储顺序是“块优先”（tile-major）：先按块网格的行优先顺序排列各块，每块内部再按块内行优先连续存放，
+//   offset(i) = block_id(i / block) * block_volume + inner(i % block)
+// 一块是一段连续内存，大小就是 compute_block_sizes 按缓存预算选出来的体积，遍历一块时只碰这一段，
+// 不会像行优先布局那样每换一行就跳过 shape[N-1] 个元素。
+// 边界块按完整块分配，越界部分填 0，所以每块长度相同、起始地址都按 64 字节对齐（块体积是 16 的倍数时）。
+//
+// 用法（4 维 (batch, head, seq, dim)）：
+//   auto t = BlockedTensor<float, 4>::from_cache({4, 8, 1024, 64}, "L2 cache");
+//   t.pack(src);                                   // 行优先 -> 分块
+//   for (auto blk : t.blocks()) { ... blk.data ... blk(local) ... }
+//   t.unpack(dst);                                 // 分块 -> 行优先
+template <typename T, size_t N>
+class BlockedTensor {
+    static_assert(N > 0, "BlockedTensor needs at least one dimension");
+
+public:
+    using Index = std::array<size_t, N>;
+
+    // 一块的视图：data 指向该块的连续存储，origin 是块在全局坐标中的起点，
+    // extent 是块内有效元素的范围（边界块小于 block），块内按 block 的行优先步长寻址
+    template <typename U>
+    struct BlockView {
+        U* data;
+        Index origin;
+        Index extent;
+        Index block;
+
+        size_t stride(size_t dim) const {
+            size_t s = 1;
+            for (size_t d = dim + 1; d < N; ++d) s *= block[d];
+            return s;
+        }
+
+        U& operator()(const Index& local) const {
+            size_t off = 0;
+            for (size_t d = 0; d < N; ++d) off = off * block[d] + local[d];
+            return data[off];
+        }
+    };
+
+    // 按存储顺序遍历所有块
+    template <typename Tensor, typename U>
+    class BlockIterator {
+    public:
+        BlockIterator(Tensor* t, size_t b) : t_(t), b_(b) {}
+        BlockView<U> operator*() const { return t_->block_view(b_); }
+        BlockIterator& operator++() {
+            ++b_;
+            return *this;
+        }
+        bool operator!=(const BlockIterator& o) const { return b_ != o.b_; }
+        bool operator==(const BlockIterator& o) const { return b_ == o.b_; }
+
+    private:
+        Tensor* t_;
+        size_t b_;
+    };
+
+    template <typename Iterator>
+    struct BlockRange {
+        Iterator first, last;
+        Iterator begin() const { return first; }
+        Iterator end() const { return last; }
+    };
+
+    using iterator = BlockIterator<BlockedTensor, T>;
+    using const_iterator = BlockIterator<const BlockedTensor, const T>;
+
+    BlockedTensor() = default;
+
+    BlockedTensor(const Index& shape, const Index& block) : shape_(shape), block_(block) {
+        block_volume_ = 1;
+        num_blocks_ = 1;
+        for (size_t d = 0; d < N; ++d) {
+            if (shape_[d] == 0) throw std::invalid_argument("BlockedTensor: zero-sized dimension");
+            if (block_[d] == 0 || block_[d] > shape_[d]) block_[d] = shape_[d];
+            grid_[d] = (shape_[d] + block_[d] - 1) / block_[d];
+            block_volume_ *= block_[d];
+            num_blocks_ *= grid_[d];
+        }
+        storage_.assign(num_blocks_ * block_volume_, T());
+    }
+
+    // 用 BlockSizeCalculator 按指定缓存层级的容量选择块尺寸
+    static BlockedTensor from_cache(const Index& shape, const std::string& cache_type = "L2 cache") {
+        CacheInfo<T> cache = BlockSizeCalculator<T>::get_cache_info(cache_type);
+        std::vector<int> dims(shape.begin(), shape.end());
+        std::vector<std::pair<int, int>> block_sizes;
+        Index block = shape;
+        if (cache.size > 0) {
+            BlockSizeCalculator<T>::compute_block_sizes(cache, dims, block_sizes);
+            for (size_t d = 0; d < N; ++d) {
+                // 块数不变，把块长均分到各块上，边界块的填充最少（1024 按 48 切要填到 1056，均分后为 47 * 22）
+                size_t b = static_cast<size_t>(block_sizes[d].first * block_sizes[d].second);
+                b = std::max<size_t>(1, std::min(b, shape[d]));
+                size_t count = (shape[d] + b - 1) / b;
+                block[d] = (shape[d] + count - 1) / count;
+            }
+            // 最内维取缓存行的整数倍，块内每行都从行首开始，便于向量化
+            size_t line = cache.line_size > 0 ? cache.line_size / sizeof(T) : 0;
+            if (line > 1 && block[N - 1] < shape[N - 1]) {
+                size_t b = (block[N - 1] + line - 1) / line * line;
+                block[N - 1] = std::min(b, shape[N - 1]);
+            }
+        }
+        return BlockedTensor(shape, block);
+    }
+
+    const Index& shape() const { return shape_; }
+    const Index& block() const { return block_; }
+    const Index& grid() const { return grid_; }
+    size_t num_blocks() const { return num_blocks_; }
+    size_t block_volume() const { return block_volume_; }
+    size_t block_bytes() const { return block_volume_ * sizeof(T); }
+    size_t storage_size() const { return storage_.size(); }  // 含边界块的填充
+
+    size_t size() const {
+        size_t n = 1;
+        for (size_t d = 0; d < N; ++d) n *= shape_[d];
+        return n;
+    }
+
+    T* data() { return storage_.data(); }
+    const T* data() const { return storage_.data(); }
+
+    // 全局坐标 -> 存储偏移
+    size_t offset(const Index& i) const {
+        size_t b = 0, inner = 0;
+        for (size_t d = 0; d < N; ++d) {
+            b = b * grid_[d] + i[d] / block_[d];
+            inner = inner * block_[d] + i[d] % block_[d];
+        }
+        return b * block_volume_ + inner;
+    }
+
+    T& operator()(const Index& i) { return storage_[offset(i)]; }
+    const T& operator()(const Index& i) const { return storage_[offset(i)]; }
+
+    template <typename... Idx>
+    T& operator()(Idx... i) {
+        static_assert(sizeof...(Idx) == N, "index count must match tensor rank");
+        return (*this)(Index{static_cast<size_t>(i)...});
+    }
+    template <typename... Idx>
+    const T& operator()(Idx... i) const {
+        static_assert(sizeof...(Idx) == N, "index count must match tensor rank");
+        return (*this)(Index{static_cast<size_t>(i)...});
+    }
+
+    // 第 b 块（存储顺序）在块网格中的坐标
+    Index block_coord(size_t b) const {
+        Index c;
+        for (size_t d = N; d-- > 0;) {
+            c[d] = b % grid_[d];
+            b /= grid_[d];
+        }
+        return c;
+    }
+
+    T* block_data(size_t b) { return storage_.data() + b * block_volume_; }
+    const T* block_data(size_t b) const { return storage_.data() + b * block_volume_; }
+
+    BlockView<T> block_view(size_t b) { return make_view<T>(block_data(b), b); }
+    BlockView<const T> block_view(size_t b) const { return make_view<const T>(block_data(b), b); }
+
+    BlockRange<iterator> blocks() { return {iterator(this, 0), iterator(this, num_blocks_)}; }
+    BlockRange<const_iterator> blocks() const { return {const_iterator(this, 0), const_iterator(this, num_blocks_)}; }
+
+    // 行优先 -> 分块：每块内最内维的有效部分是源数据中的一段连续内存，逐段 memcpy
+    void pack(const T* src) {
+        const Index src_stride = row_major_strides();
+        for (size_t b = 0; b < num_blocks_; ++b) {
+            BlockView<T> v = block_view(b);
+            for_each_row(v, src_stride, [&](T* blk, size_t src_off, size_t len) {
+                std::memcpy(blk, src + src_off, len * sizeof(T));
+            });
+        }
+    }
+
+    // 分块 -> 行优先（只写有效元素，填充部分丢弃）
+    void unpack(T* dst) const {
+        const Index dst_stride = row_major_strides();
+        for (size_t b = 0; b < num_blocks_; ++b) {
+            BlockView<const T> v = block_view(b);
+            for_each_row(v, dst_stride, [&](const T* blk, size_t dst_off, size_t len) {
+                std::memcpy(dst + dst_off, blk, len * sizeof(T));
+            });
+        }
+    }
+
+    // 整块填充（边界块的填充区也会被写成 value）
+    void fill(const T& value) { storage_.assign(storage_.size(), value); }
+
+private:
+    template <typename U, typename Ptr>
+    BlockView<U> make_view(Ptr data, size_t b) const {
+        BlockView<U> v{data, block_coord(b), Index{}, block_};
+        for (size_t d = 0; d < N; ++d) {
+            v.origin[d] *= block_[d];
+            v.extent[d] = std::min(block_[d], shape_[d] - v.origin[d]);
+        }
+        return v;
+    }
+
+    Index row_major_strides() const {
+        Index s;
+        s[N - 1] = 1;
+        for (size_t d = N - 1; d-- > 0;) s[d] = s[d + 1] * shape_[d + 1];
+        return s;
+    }
+
+    // 遍历块内每一“行”（前 N-1 维的每个有效坐标），给出块内指针、行优先布局中的偏移和有效长度。
+    // 前 N-1 维用里程计方式递增，块内偏移和行优先偏移都增量更新，不做除法
+    template <typename U, typename Fn>
+    void for_each_row(const BlockView<U>& v, const Index& row_stride, Fn fn) const {
+        Index local{};
+        Index blk_stride;
+        blk_stride[N - 1] = 1;
+        for (size_t d = N - 1; d-- > 0;) blk_stride[d] = blk_stride[d + 1] * block_[d + 1];
+
+        size_t blk_off = 0, row_off = 0;
+        for (size_t d = 0; d < N; ++d) row_off += v.origin[d] * row_stride[d];
+        const size_t len = v.extent[N - 1];
+
+        while (true) {
+            fn(v.data + blk_off, row_off, len);
+            if (N == 1) return;
+            size_t d = N - 1;
+            while (d-- > 0) {
+                if (++local[d] < v.extent[d]) {
+                    blk_off += blk_stride[d];
+                    row_off += row_stride[d];
+                    break;
+                }
+                blk_off -= (local[d] - 1) * blk_stride[d];
+                row_off -= (local[d] - 1) * row_stride[d];
+                local[d] = 0;
+                if (d == 0) return;
+            }
+        }
+    }
+
+    Index shape_{};
+    Index block_{};
+    Index grid_{};
+    size_t block_volume_ = 0;
+    size_t num_blocks_ = 0;
+    std::vector<T, SlabAllocator<T>> storage_;
+};
+
+#endif // BLOCKED_TENSOR_H
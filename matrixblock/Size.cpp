@@ -4,12 +4,8 @@
 #include <cstdint>
 #include <ctime>
 
-// 跨平台缓存检测头文件
-#ifdef __linux__
-#include <unistd.h>
-#elif defined(__APPLE__)
-#include <sys/sysctl.h>
-#endif
+// 跨平台缓存检测
+#include "../Head/CacheTopology.h"
 
 // 分块参数结构体
 struct TileSize {
@@ -33,34 +29,13 @@ struct CacheConfig {
         detect_cache_sizes();  // 尝试检测本地缓存大小
     }
 
-    // 检测本地缓存大小
+    // 检测本地缓存大小：统一取自 CacheTopology（读取 sysfs，失败时回退到 sysconf / sysctl）
+    // L3 取平均到每个逻辑 CPU 的份额，多线程同时分块时不会超额占用共享的 L3
     void detect_cache_sizes() {
-#ifdef __linux__
-        // Linux 使用 sysconf 获取缓存大小
-        l1_size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
-        l2_size = sysconf(_SC_LEVEL2_CACHE_SIZE);
-        l3_size = sysconf(_SC_LEVEL3_CACHE_SIZE);
-        if (l1_size <= 0 || l2_size <= 0 || l3_size <= 0) {
-            std::cerr << "Warning: Failed to detect cache sizes on Linux, using defaults.\n";
-            l1_size = 32 * 1024;
-            l2_size = 256 * 1024;
-            l3_size = 8 * 1024 * 1024;
-        }
-#elif defined(__APPLE__)
-        // macOS 使用 sysctl 获取缓存大小
-        size_t len = sizeof(int64_t);
-        if (sysctlbyname("hw.l1dcachesize", &l1_size, &len, NULL, 0) != 0) {
-            l1_size = 32 * 1024;  // 默认值
-        }
-        if (sysctlbyname("hw.l2cachesize", &l2_size, &len, NULL, 0) != 0) {
-            l2_size = 256 * 1024;
-        }
-        if (sysctlbyname("hw.l3cachesize", &l3_size, &len, NULL, 0) != 0) {
-            l3_size = 8 * 1024 * 1024;
-        }
-#else
-        std::cerr << "Warning: Cache detection not supported on this platform, using defaults.\n";
-#endif
+        const CacheTopology& topo = CacheTopology::get();
+        l1_size = topo.data_cache_blocking_size(1, l1_size);
+        l2_size = topo.data_cache_blocking_size(2, l2_size);
+        l3_size = topo.data_cache_blocking_size(3, l3_size);
     }
 };
 
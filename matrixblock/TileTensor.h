@@ -8,10 +8,7 @@
 #include <cstring>
 #include <vector>
 
-// macOS 特定头文件
-#ifdef __APPLE__
-#include <sys/sysctl.h> // macOS sysctl API
-#endif
+#include "../Head/CacheTopology.h"
 
 // 缓存信息结构体
 template <typename T>
@@ -40,49 +37,13 @@ template <typename T>
 CacheInfo<T> BlockSizeCalculator<T>::get_cache_info(const std::string& cache_type) {
     CacheInfo<T> info = {0};
 
-#ifdef __linux__ // Linux 系统
-    std::ifstream file("/proc/cpuinfo");
-    if (!file.is_open()) return info;
-
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.find(cache_type) != std::string::npos) {
-            size_t pos = line.find(':');
-            if (pos != std::string::npos) {
-                std::string value_str = line.substr(pos + 1);
-                int size_kb;
-                if (std::sscanf(value_str.c_str(), "%dKB", &size_kb) == 1) {
-                    info.size = size_kb * 1024; // 转换为字节
-                }
-            }
-        } else if (line.find("cache line size") != std::string::npos) {
-            int line_size;
-            std::sscanf(line.c_str(), "%*[^:]: %d", &line_size);
-            info.line_size = line_size;
-        }
-    }
-
-#elif defined(__APPLE__) // macOS 系统
-    size_t len = sizeof(info.size);
-
-    if (cache_type == "L1d cache") {
-        int mib[2] = {CTL_HW, HW_L1DCACHESIZE};
-        sysctl(mib, 2, &info.size, &len, nullptr, 0);
-    } else if (cache_type == "L2 cache") {
-        int mib[2] = {CTL_HW, HW_L2CACHESIZE};
-        sysctl(mib, 2, &info.size, &len, nullptr, 0);
-    } else if (cache_type == "L3 cache") {
-        int mib[2] = {CTL_HW, HW_L3CACHESIZE};
-        sysctl(mib, 2, &info.size, &len, nullptr, 0);
-    }
-
-    // 默认缓存行大小（假设64字节）
-    info.line_size = 64;
-
-#else
-#error "Unsupported platform"
-#endif
-
+    // 从 sysfs 缓存拓扑取数：/proc/cpuinfo 中并没有各级缓存容量的行，
+    // 旧实现在 Linux 上得到 size = 0，分块退化
+    const CacheLevelInfo* cache = CacheTopology::get().data_cache(cache_level_from_name(cache_type));
+    if (!cache) return info;
+    info.size = static_cast<int>(cache->blocking_size());  // 共享的 L3 只算本线程的份额
+    info.line_size = cache->line_size;
+    info.associativity = cache->ways;
     return info;
 }
 
@@ -130,22 +91,21 @@ void BlockSizeCalculator<T>::compute_block_sizes(const CacheInfo<T>& cache,
         }
     }
 
-    // 最终验证约束条件
-    int total_block_memory = 0;
-    for (int dim = 0; dim < num_dims; ++dim) {
-        total_block_memory += block_sizes[dim].first * block_sizes[dim].second;
-    }
-
-    while (total_block_memory * sizeof(T) > usable_cache) {
-        for (int dim = 0; dim < num_dims; ++dim) {
-            block_sizes[dim].first /= 2;
-            block_sizes[dim].first = std::max(1, block_sizes[dim].first);
-        }
-
-        total_block_memory = 0;
-        for (int dim = 0; dim < num_dims; ++dim) {
-            total_block_memory += block_sizes[dim].first * block_sizes[dim].second;
-        }
+    // 最终验证约束条件：一个块占用的元素数是各维块长的乘积（不是和），
+    // 超出缓存预算时每次把最大的一维减半，尽量保持块的各维均衡
+    auto block_volume = [&]() {
+        size_t volume = 1;
+        for (int dim = 0; dim < num_dims; ++dim)
+            volume *= static_cast<size_t>(block_sizes[dim].first) * block_sizes[dim].second;
+        return volume;
+    };
+
+    while (block_volume() * sizeof(T) > static_cast<size_t>(usable_cache)) {
+        int largest = 0;
+        for (int dim = 1; dim < num_dims; ++dim)
+            if (block_sizes[dim].first > block_sizes[largest].first) largest = dim;
+        if (block_sizes[largest].first <= 1) break;
+        block_sizes[largest].first /= 2;
     }
 }
 
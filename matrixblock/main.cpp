@@ -1,10 +1,11 @@
 #include "BlockSizeCalculator.h"
+#include "../base/HugePageBuffer.h"
 #include <iostream>
 #include <chrono> // 高精度计时器
 
-// 分块矩阵乘法核心函数
+// 分块矩阵乘法核心函数（带前导维：A / B / C 相邻两行分别相隔 lda / ldb / ldc 个元素）
 template <typename T>
-void block_matmul(const T* A, const T* B, T* C,
+void block_matmul(const T* A, int lda, const T* B, int ldb, T* C, int ldc,
                   int rows_A, int cols_A, int rows_B, int cols_B,
                   int block_M, int block_K, int block_N) {
     for (int i = 0; i < rows_A; i += block_M) {
@@ -14,9 +15,9 @@ void block_matmul(const T* A, const T* B, T* C,
                     for (int jj = j; jj < j + block_N && jj < cols_B; ++jj) {
                         T sum = 0;
                         for (int kk = k; kk < k + block_K && kk < cols_A; ++kk) {
-                            sum += A[ii * cols_A + kk] * B[kk * cols_B + jj];
+                            sum += A[ii * lda + kk] * B[kk * ldb + jj];
                         }
-                        C[ii * cols_B + jj] += sum;
+                        C[ii * ldc + jj] += sum;
                     }
                 }
             }
@@ -24,6 +25,22 @@ void block_matmul(const T* A, const T* B, T* C,
     }
 }
 
+// 紧凑存储
+template <typename T>
+void block_matmul(const T* A, const T* B, T* C,
+                  int rows_A, int cols_A, int rows_B, int cols_B,
+                  int block_M, int block_K, int block_N) {
+    block_matmul(A, cols_A, B, cols_B, C, cols_B, rows_A, cols_A, rows_B, cols_B, block_M, block_K, block_N);
+}
+
+// 按缓存几何填充前导维的矩阵
+template <typename T>
+void block_matmul(const PaddedMatrix<T>& A, const PaddedMatrix<T>& B, PaddedMatrix<T>& C,
+                  int block_M, int block_K, int block_N) {
+    block_matmul(A.data(), A.ld(), B.data(), B.ld(), C.data(), C.ld(),
+                 A.rows(), A.cols(), B.rows(), B.cols(), block_M, block_K, block_N);
+}
+
 // 测量性能
 template <typename T>
 double measure_performance(const T* A, const T* B, T* C,
@@ -46,12 +63,51 @@ double measure_performance(const T* A, const T* B, T* C,
     return duration.count() / iterations;
 }
 
+// 二次幂尺寸下对比紧凑存储与填充前导维：B 按列读、C 按块写时，紧凑存储的各行落在少数几个缓存组里
+template <typename T>
+void run_padding_comparison(int n, int iterations = 3) {
+    CacheInfo<T> L1_cache = BlockSizeCalculator<T>::get_cache_info("L1d cache");
+    int block_M, block_K, block_N;
+    BlockSizeCalculator<T>::compute_block_sizes(L1_cache, n, n, n, n, block_M, block_K, block_N);
+    int ld = BlockSizeCalculator<T>::leading_dim(L1_cache, n);
+
+    double time[2];
+    T checksum[2];
+    for (int padded = 0; padded < 2; ++padded) {
+        int stride = padded ? ld : n;
+        PaddedMatrix<T> A(n, n, stride), B(n, n, stride), C(n, n, stride);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j) {
+                A(i, j) = static_cast<T>((i + j) % 7);
+                B(i, j) = static_cast<T>((i * 3 + j) % 5);
+            }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int iter = 0; iter < iterations; ++iter) {
+            C.fill(0);
+            block_matmul(A, B, C, block_M, block_K, block_N);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        time[padded] = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+        checksum[padded] = C(n - 1, n - 1) + C(n / 2, 1);
+    }
+
+    std::cout << n << "x" << n << " (L1 " << L1_cache.size / 1024 << "KB, " << L1_cache.associativity
+              << "-way, block M=" << block_M << " K=" << block_K << " N=" << block_N << "): ld " << n
+              << ": " << time[0] << " ms, ld " << ld << ": " << time[1] << " ms, speedup "
+              << time[0] / time[1] << "x" << (checksum[0] == checksum[1] ? "" : " (MISMATCH)") << std::endl;
+}
+
 // 主函数
 template <typename T>
 void run_matrix_multiplication(int rows_A, int cols_A, int rows_B, int cols_B) {
-    T* A = new T[rows_A * cols_A]{};
-    T* B = new T[rows_B * cols_B]{};
-    T* C = new T[rows_A * cols_B]{};
+    // 操作数放在大页上（小矩阵或大页不可用时回退普通页或堆），HugePageBuffer 保证内容已清零
+    HugePageArray<T> A_buf(static_cast<size_t>(rows_A) * cols_A);
+    HugePageArray<T> B_buf(static_cast<size_t>(rows_B) * cols_B);
+    HugePageArray<T> C_buf(static_cast<size_t>(rows_A) * cols_B);
+    T* A = A_buf.data();
+    T* B = B_buf.data();
+    T* C = C_buf.data();
 
     // 初始化矩阵（示例）
     for (int i = 0; i < rows_A * cols_A; ++i) A[i] = static_cast<T>(1.0);
@@ -84,8 +140,6 @@ void run_matrix_multiplication(int rows_A, int cols_A, int rows_B, int cols_B) {
               << ", Time: " << time_L2 << " ms" << std::endl;
     std::cout << "L1 Block Size: M=" << M_L1 << ", K=" << K_L1 << ", N=" << N_L1
               << ", Time: " << time_L1 << " ms" << std::endl;
-
-    delete[] A; delete[] B; delete[] C;
 }
 
 int main() {
@@ -109,5 +163,10 @@ int main() {
     std::cout << "\nTesting with int type:" << std::endl;
     run_matrix_multiplication<int>(rows_A, cols_A, rows_B, cols_B);
 
+    // 二次幂尺寸：前导维填充前后对比
+    std::cout << "\nLeading-dimension padding (float):" << std::endl;
+    run_padding_comparison<float>(512);
+    run_padding_comparison<float>(1024, 1);
+
     return 0;
 }
\ No newline at end of file
@@ -1,12 +1,78 @@
-#include "TileTensor.h"
+#include "BlockedTensor.h"
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <random>
+
+/*
+编译：
+g++ -O3 -march=native -std=c++17 main_tensor.cpp -o main_tensor
+执行：./main_tensor
+
+先打印按 L1 计算出的二维分块策略，再把一个 4 维 (batch, head, seq, dim) 张量按 L2 的分块尺寸
+重排成 BlockedTensor，检查 pack / unpack 往返一致，并对比逐块两遍处理（求块内最大值再缩放）
+在行优先布局和分块布局上的耗时。
+*/
+
+// 行优先布局上按块做两遍处理：块内每行只有 block[3] 个元素连续，换行要跨过整行
+static double tile_normalize_row_major(std::vector<float>& x, const std::array<size_t, 4>& shape,
+                                       const std::array<size_t, 4>& block) {
+    const size_t s2 = shape[3], s1 = shape[2] * s2, s0 = shape[1] * s1;
+    double checksum = 0;
+    for (size_t b0 = 0; b0 < shape[0]; b0 += block[0])
+    for (size_t b1 = 0; b1 < shape[1]; b1 += block[1])
+    for (size_t b2 = 0; b2 < shape[2]; b2 += block[2])
+    for (size_t b3 = 0; b3 < shape[3]; b3 += block[3]) {
+        const size_t e0 = std::min(block[0], shape[0] - b0), e1 = std::min(block[1], shape[1] - b1);
+        const size_t e2 = std::min(block[2], shape[2] - b2), e3 = std::min(block[3], shape[3] - b3);
+        float m = 0;
+        for (size_t i = 0; i < e0; ++i)
+            for (size_t j = 0; j < e1; ++j)
+                for (size_t k = 0; k < e2; ++k) {
+                    const float* row = &x[(b0 + i) * s0 + (b1 + j) * s1 + (b2 + k) * s2 + b3];
+                    for (size_t l = 0; l < e3; ++l) m = std::max(m, std::fabs(row[l]));
+                }
+        const float inv = m > 0 ? 1.0f / m : 1.0f;
+        for (size_t i = 0; i < e0; ++i)
+            for (size_t j = 0; j < e1; ++j)
+                for (size_t k = 0; k < e2; ++k) {
+                    float* row = &x[(b0 + i) * s0 + (b1 + j) * s1 + (b2 + k) * s2 + b3];
+                    for (size_t l = 0; l < e3; ++l) row[l] *= inv;
+                }
+        checksum += m;
+    }
+    return checksum;
+}
+
+// 分块布局上同样的处理：每块是一段连续内存，填充区为 0，不影响最大绝对值
+static double tile_normalize_blocked(BlockedTensor<float, 4>& t) {
+    double checksum = 0;
+    const size_t n = t.block_volume();
+    for (auto blk : t.blocks()) {
+        float m = 0;
+        for (size_t i = 0; i < n; ++i) m = std::max(m, std::fabs(blk.data[i]));
+        const float inv = m > 0 ? 1.0f / m : 1.0f;
+        for (size_t i = 0; i < n; ++i) blk.data[i] *= inv;
+        checksum += m;
+    }
+    return checksum;
+}
+
+template <typename F>
+static double time_ms(F&& f, int repeat = 5) {
+    double best = 1e30;
+    for (int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        auto end = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
 
 int main() {
-    // 假设我们有一个四维张量 A，其形状为 (4, 2, 1024, 128)
-    // std::vector<int> tensor_shape = {4, 2, 1024, 128,512};
     std::vector<int> tensor_shape = {512,512};
 
-
     // 获取缓存信息
     auto cache_info = BlockSizeCalculator<float>::get_cache_info("L1 cache");
 
@@ -21,5 +87,38 @@ int main() {
     }
     std::cout << std::endl;
 
+    // 四维张量 (batch, head, seq, dim)，按 L2 容量分块
+    const std::array<size_t, 4> shape = {4, 8, 1024, 128};
+    auto blocked = BlockedTensor<float, 4>::from_cache(shape, "L2 cache");
+    const auto& blk = blocked.block();
+    std::cout << "4-D shape (" << shape[0] << ", " << shape[1] << ", " << shape[2] << ", " << shape[3]
+              << "), block (" << blk[0] << ", " << blk[1] << ", " << blk[2] << ", " << blk[3] << "), "
+              << blocked.num_blocks() << " blocks of " << blocked.block_bytes() / 1024 << " KB" << std::endl;
+
+    std::vector<float> src(blocked.size()), back(blocked.size());
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (auto& v : src) v = dist(gen);
+
+    double pack_ms = time_ms([&] { blocked.pack(src.data()); });
+    double unpack_ms = time_ms([&] { blocked.unpack(back.data()); });
+    bool roundtrip = back == src;
+    bool indexing = blocked(3, 5, 1000, 17) == src[((3 * shape[1] + 5) * shape[2] + 1000) * shape[3] + 17];
+    std::cout << "pack " << pack_ms << " ms, unpack " << unpack_ms << " ms, roundtrip "
+              << (roundtrip && indexing ? "OK" : "MISMATCH") << std::endl;
+
+    // 逐块两遍处理：先各做一次并比较结果，再只对处理本身计时（重复处理后数值不变，不影响访存模式）
+    std::vector<float> row_major = src;
+    blocked.pack(src.data());
+    double c1 = tile_normalize_row_major(row_major, shape, blk);
+    double c2 = tile_normalize_blocked(blocked);
+    blocked.unpack(back.data());
+    float max_diff = 0;
+    for (size_t i = 0; i < src.size(); ++i) max_diff = std::max(max_diff, std::fabs(back[i] - row_major[i]));
+    double row_ms = time_ms([&] { tile_normalize_row_major(row_major, shape, blk); });
+    double blocked_ms = time_ms([&] { tile_normalize_blocked(blocked); });
+    std::cout << "tile normalize: row-major " << row_ms << " ms, blocked " << blocked_ms << " ms, checksum diff "
+              << std::fabs(c1 - c2) << ", max diff " << max_diff << std::endl;
+
     return 0;
-}
\ No newline at end of file
+}
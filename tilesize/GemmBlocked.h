@@ -0,0 +1,59 @@
+#ifndef GEMM_BLOCKED_H
+#define GEMM_BLOCKED_H
+
+#include <algorithm>
+
+#include "TitleSizeCalculator.h"
+#include "../Head/PaddedMatrix.h"
+#include "../Head/PerfCounters.h"
+
+// 三级分块的标量 GEMM：C += A * B，分块参数来自 TileSizeCalculator::compute。
+// 原先只在 main.cpp 中定义，放到头文件里供 benchmark/kernel_bench.cpp 等复用
+
+// 分块矩阵乘法实现（带前导维：A / B / C 相邻两行分别相隔 lda / ldb / ldc 个元素）
+inline void gemm_blocked(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int N, int K,
+                         const TileSize& ts) {
+    PERF_SCOPE("gemm_blocked");  // 编译时定义 PERF_COUNTERS_ENABLE 才会计数
+    // 外层循环 (L3 级别)
+    for (int i0 = 0; i0 < M; i0 += ts.ti_outer * ts.ti_mid * ts.ti_inner) {
+        for (int j0 = 0; j0 < N; j0 += ts.tj_outer * ts.tj_mid * ts.tj_inner) {
+            for (int k0 = 0; k0 < K; k0 += ts.tk_mid) {
+                // 中层循环 (L2 级别)
+                for (int im = i0; im < std::min(i0 + ts.ti_outer * ts.ti_mid * ts.ti_inner, M); 
+                     im += ts.ti_mid * ts.ti_inner) {
+                    for (int jm = j0; jm < std::min(j0 + ts.tj_outer * ts.tj_mid * ts.tj_inner, N); 
+                         jm += ts.tj_mid * ts.tj_inner) {
+                        // 内层循环 (L1 级别)
+                        for (int i = im; i < std::min(im + ts.ti_mid * ts.ti_inner, M); 
+                             i += ts.ti_inner) {
+                            for (int j = jm; j < std::min(jm + ts.tj_mid * ts.tj_inner, N); 
+                                 j += ts.tj_inner) {
+                                for (int k = k0; k < std::min(k0 + ts.tk_mid, K); k++) {
+                                    // 计算 4x4 子块
+                                    for (int p = i; p < std::min(i + ts.ti_inner, M); p++) {
+                                        for (int q = j; q < std::min(j + ts.tj_inner, N); q++) {
+                                            C[p * ldc + q] += A[p * lda + k] * B[k * ldb + q];
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 紧凑存储
+inline void gemm_blocked(const float* A, const float* B, float* C, int M, int N, int K, const TileSize& ts) {
+    gemm_blocked(A, K, B, N, C, N, M, N, K, ts);
+}
+
+// 按缓存几何填充前导维的矩阵
+inline void gemm_blocked(const PaddedMatrix<float>& A, const PaddedMatrix<float>& B, PaddedMatrix<float>& C,
+                         const TileSize& ts) {
+    gemm_blocked(A.data(), A.ld(), B.data(), B.ld(), C.data(), C.ld(), A.rows(), B.cols(), A.cols(), ts);
+}
+
+#endif // GEMM_BLOCKED_H
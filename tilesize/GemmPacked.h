@@ -0,0 +1,317 @@
+#ifndef GEMM_PACKED_H
+#define GEMM_PACKED_H
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "TitleSizeCalculator.h"
+#include "../base/SlabAllocator.h"
+#include "../gemm/Epilogue.h"
+
+// GotoBLAS / BLIS 风格的打包分块 SGEMM：C += A * B（与 gemm_blocked 相同的累加语义）
+//
+//   for jc (NC 列，L3)              B 的 KC×NC 面板打包一次，在整个 ic 循环中复用
+//     for pc (KC，L2)
+//       打包 B[pc:pc+KC, jc:jc+NC]
+//       for ic (MC 行，L2)          A 的 MC×KC 块打包后常驻 L2
+//         打包 A[ic:ic+MC, pc:pc+KC]
+//         for jr (NR) / ir (MR)     MR×NR 寄存器块微内核，B 的 KC×NR 条带常驻 L1
+//
+// 打包后微内核只做连续访问，C 的 MR×NR 块整个 K 循环都留在寄存器中。
+// gemm_packed_fused 在写回寄存器块时合并 alpha / beta 并套用 Epilogue.h 的算子链（偏置、激活、残差）。
+// 需要 -mavx2 -mfma 编译；加 -mavx512f 时使用 6×32 的 AVX-512 微内核。
+
+#ifdef __AVX512F__
+constexpr int GEMM_MR = 6;   // 微内核行数
+constexpr int GEMM_NR = 32;  // 微内核列数（2 个 512 位向量）
+#else
+constexpr int GEMM_MR = 6;
+constexpr int GEMM_NR = 16;  // 2 个 256 位向量：6×2 = 12 个累加器 + 2 个 B + 1 个广播 = 15 个 ymm
+#endif
+
+// 三级分块参数（单位：元素）
+struct GemmBlocking {
+    int mc;  // A 块行数（L2）
+    int nc;  // B 面板列数（L3）
+    int kc;  // 归约轴分块（L2）
+};
+
+// 由 TileSizeCalculator::compute 的结果推导打包缓冲区大小：
+//   kc = tk_mid；mc 从 ti_inner*ti_mid 出发按 MR 取整，并在 A 块不超过半个 L2 的前提下放大；
+//   nc 取 L3 级 j 分块 tj_inner*tj_mid*tj_outer，按 NR 取整，并限制 B 面板不超过半个 l3_size。
+//   l3_size 是每个逻辑 CPU 的 L3 份额而不是整个共享 L3：GemmParallel 的每个线程各自打包一块 nc 宽的 B 面板，
+//   按份额取 nc 才能让所有线程的面板同时驻留；单线程时会比整个 L3 保守
+inline GemmBlocking gemm_blocking_from_tiles(const TileSize& ts, const CacheConfig& cache, int M, int N, int K) {
+    auto round_up = [](int v, int r) { return (v + r - 1) / r * r; };
+    GemmBlocking bk;
+    bk.kc = std::max(1, std::min(ts.tk_mid, K));
+
+    bk.mc = round_up(std::max(1, ts.ti_inner * ts.ti_mid), GEMM_MR);
+    int64_t l2_half = cache.l2_size / 2;
+    const int64_t fsize = sizeof(float);
+    while (bk.mc < M && static_cast<int64_t>(bk.mc) * 2 * bk.kc * fsize <= l2_half) bk.mc *= 2;
+    bk.mc = std::min(bk.mc, round_up(M, GEMM_MR));
+
+    bk.nc = round_up(std::max(1, ts.tj_inner * ts.tj_mid * std::max(1, ts.tj_outer)), GEMM_NR);
+    int64_t l3_half = cache.l3_size / 2;
+    while (bk.nc > GEMM_NR && static_cast<int64_t>(bk.nc) * bk.kc * fsize > l3_half) bk.nc -= GEMM_NR;
+    bk.nc = std::min(bk.nc, round_up(N, GEMM_NR));
+    return bk;
+}
+
+// 打包 A 的 mc×kc 块：按 MR 行一组，组内按 k 优先存放（a[k*MR + r]），不足 MR 行补 0
+inline void gemm_pack_a(const float* A, int lda, int mc, int kc, float* buf) {
+    for (int ir = 0; ir < mc; ir += GEMM_MR) {
+        int rows = std::min(GEMM_MR, mc - ir);
+        for (int k = 0; k < kc; ++k) {
+            for (int r = 0; r < GEMM_MR; ++r) {
+                *buf++ = r < rows ? A[static_cast<size_t>(ir + r) * lda + k] : 0.0f;
+            }
+        }
+    }
+}
+
+// 打包 B 的 kc×nc 面板：按 NR 列一组，组内按 k 优先存放（b[k*NR + j]），不足 NR 列补 0
+inline void gemm_pack_b(const float* B, int ldb, int kc, int nc, float* buf) {
+    for (int jr = 0; jr < nc; jr += GEMM_NR) {
+        int cols = std::min(GEMM_NR, nc - jr);
+        for (int k = 0; k < kc; ++k) {
+            const float* src = B + static_cast<size_t>(k) * ldb + jr;
+            if (cols == GEMM_NR) {
+                std::memcpy(buf, src, GEMM_NR * sizeof(float));
+            } else {
+                std::memcpy(buf, src, cols * sizeof(float));
+                std::memset(buf + cols, 0, (GEMM_NR - cols) * sizeof(float));
+            }
+            buf += GEMM_NR;
+        }
+    }
+}
+
+// 微内核用 EpVec<__m256 / __m512> 写，会触发 -Wignored-attributes（见 Epilogue.h），到文件末尾为止关闭
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+
+#ifdef __AVX512F__
+using GemmVec = __m512;
+#else
+using GemmVec = __m256;
+#endif
+constexpr int GEMM_VW = EpVec<GemmVec>::width;  // 每个向量的列数，GEMM_NR = 2 * GEMM_VW
+
+// MR×NR 寄存器块：acc[r][h] = sum_k a[k*MR + r] * b[k*NR + h*VW ..]
+// 强制内联：不内联时 acc 经由内存传递，整个 k 循环都会在栈上读写累加器
+__attribute__((always_inline)) inline void gemm_micro_accumulate(int kc, const float* a, const float* b, GemmVec acc[GEMM_MR][2]) {
+    using T = EpVec<GemmVec>;
+    for (int r = 0; r < GEMM_MR; ++r) acc[r][0] = acc[r][1] = T::set1(0.0f);
+
+    for (int k = 0; k < kc; ++k) {
+        GemmVec b0 = T::load(b);
+        GemmVec b1 = T::load(b + GEMM_VW);
+        for (int r = 0; r < GEMM_MR; ++r) {
+            GemmVec ar = T::set1(a[r]);  // vbroadcastss
+            acc[r][0] = T::fmadd(ar, b0, acc[r][0]);
+            acc[r][1] = T::fmadd(ar, b1, acc[r][1]);
+        }
+        a += GEMM_MR;
+        b += GEMM_NR;
+    }
+}
+
+// 微内核：C[MR×NR] += a[MR×kc] * b[kc×NR]（AVX2 6×16，AVX-512 6×32）
+inline void gemm_micro_kernel(int kc, const float* a, const float* b, float* c, int ldc) {
+    using T = EpVec<GemmVec>;
+    GemmVec acc[GEMM_MR][2];
+    gemm_micro_accumulate(kc, a, b, acc);
+    for (int r = 0; r < GEMM_MR; ++r) {
+        float* cr = c + static_cast<size_t>(r) * ldc;
+        T::store(cr, T::add(T::load(cr), acc[r][0]));
+        T::store(cr + GEMM_VW, T::add(T::load(cr + GEMM_VW), acc[r][1]));
+    }
+}
+
+// 边界块：先算到临时的 MR×NR 缓冲，再把有效的 rows×cols 部分累加回 C
+inline void gemm_micro_kernel_edge(int kc, const float* a, const float* b, float* c, int ldc, int rows, int cols) {
+    alignas(64) float tmp[GEMM_MR * GEMM_NR] = {0};
+    gemm_micro_kernel(kc, a, b, tmp, GEMM_NR);
+    for (int r = 0; r < rows; ++r) {
+        for (int j = 0; j < cols; ++j) c[static_cast<size_t>(r) * ldc + j] += tmp[r * GEMM_NR + j];
+    }
+}
+
+// 宏内核：对已打包的 A 块（mc×kc）与 B 面板（kc×nc）遍历 MR×NR 寄存器块
+inline void gemm_macro_kernel(int mc, int nc, int kc, const float* a_pack, const float* b_pack,
+                              float* C, int ldc) {
+    for (int jr = 0; jr < nc; jr += GEMM_NR) {
+        int cols = std::min(GEMM_NR, nc - jr);
+        const float* b = b_pack + static_cast<size_t>(jr) * kc;
+        for (int ir = 0; ir < mc; ir += GEMM_MR) {
+            int rows = std::min(GEMM_MR, mc - ir);
+            const float* a = a_pack + static_cast<size_t>(ir) * kc;
+            float* c = C + static_cast<size_t>(ir) * ldc + jr;
+            if (rows == GEMM_MR && cols == GEMM_NR) {
+                gemm_micro_kernel(kc, a, b, c, ldc);
+            } else {
+                gemm_micro_kernel_edge(kc, a, b, c, ldc, rows, cols);
+            }
+        }
+    }
+}
+
+// 打包缓冲区大小（元素个数），按 MR / NR 补齐
+inline size_t gemm_pack_a_size(const GemmBlocking& bk) {
+    return static_cast<size_t>((bk.mc + GEMM_MR - 1) / GEMM_MR * GEMM_MR) * bk.kc;
+}
+inline size_t gemm_pack_b_size(const GemmBlocking& bk) {
+    return static_cast<size_t>((bk.nc + GEMM_NR - 1) / GEMM_NR * GEMM_NR) * bk.kc;
+}
+
+// 带跨度的打包 GEMM，调用方提供打包缓冲区（64 字节对齐）
+inline void gemm_packed(const float* A, int lda, const float* B, int ldb, float* C, int ldc,
+                        int M, int N, int K, const GemmBlocking& bk, float* a_pack, float* b_pack) {
+    for (int jc = 0; jc < N; jc += bk.nc) {
+        int nc = std::min(bk.nc, N - jc);
+        for (int pc = 0; pc < K; pc += bk.kc) {
+            int kc = std::min(bk.kc, K - pc);
+            gemm_pack_b(B + static_cast<size_t>(pc) * ldb + jc, ldb, kc, nc, b_pack);
+            for (int ic = 0; ic < M; ic += bk.mc) {
+                int mc = std::min(bk.mc, M - ic);
+                gemm_pack_a(A + static_cast<size_t>(ic) * lda + pc, lda, mc, kc, a_pack);
+                gemm_macro_kernel(mc, nc, kc, a_pack, b_pack, C + static_cast<size_t>(ic) * ldc + jc, ldc);
+            }
+        }
+    }
+}
+
+// 与 gemm_blocked 相同签名的入口：分块大小来自 TileSizeCalculator::compute
+inline void gemm_packed(const float* A, const float* B, float* C, int M, int N, int K,
+                        const TileSize& ts, const CacheConfig& cache = CacheConfig()) {
+    GemmBlocking bk = gemm_blocking_from_tiles(ts, cache, M, N, K);
+    size_t a_bytes = (gemm_pack_a_size(bk) * sizeof(float) + 63) / 64 * 64;
+    size_t b_bytes = (gemm_pack_b_size(bk) * sizeof(float) + 63) / 64 * 64;
+    // 打包缓冲区每次调用都要申请：走 slab 分配器的线程缓存，重复调用时复用同一块内存
+    float* a_pack = static_cast<float*>(slab_alloc(a_bytes));
+    float* b_pack = static_cast<float*>(slab_alloc(b_bytes));
+    gemm_packed(A, K, B, N, C, N, M, N, K, bk, a_pack, b_pack);
+    slab_free(a_pack, a_bytes);
+    slab_free(b_pack, b_bytes);
+}
+
+// ---------------- 融合写回：C = ep(alpha * A * B + beta * C) ----------------
+// K 分成多个 kc 面板时：第一个面板写回 alpha * acc + beta * C，之后的面板累加 alpha * acc，
+// 只有最后一个面板（此时寄存器块里是完整结果）才套用算子链，C 只被读写 K / kc 次，不再有额外的后处理扫描。
+// 算子链在面板循环里选定：中间面板实例化空链的宏内核，微内核里没有分支，累加器不会因为两种写回并存而溢出到栈上
+
+// 融合路径的 mc 上限：宏内核 jr 在外、ir 在内，一条 jr 条带要纵向扫过 mc 行 C 和残差 R，
+// 行跨度通常不小于一页，mc 上千行时每个寄存器块都落在新的页上，TLB 与硬件预取全部失效。
+// 限制为 4 个 MR 行组后，C 与 R 涉及的页数在 L1 DTLB 之内，下一条 jr 条带接着读同一批行的相邻缓存行；
+// A 块变小只增加宏内核调用次数，A 的每个元素仍然只打包一次
+constexpr int GEMM_FUSED_MC = 4 * GEMM_MR;
+
+inline GemmBlocking gemm_blocking_fused(GemmBlocking bk) {
+    bk.mc = std::min(bk.mc, GEMM_FUSED_MC);
+    return bk;
+}
+
+// 寄存器块写回：C = ep(alpha * acc + beta * C)
+template <class Ep>
+__attribute__((always_inline)) inline void gemm_store_tile(const GemmVec acc[GEMM_MR][2], float* c, int ldc,
+                                                           float alpha, float beta, const Ep& ep, EpilogueAt at) {
+    for (int r = 0; r < GEMM_MR; ++r) {
+        for (int h = 0; h < 2; ++h) {
+            float* p = c + static_cast<size_t>(r) * ldc + h * GEMM_VW;
+            EpVec<GemmVec>::store(p, ep_finish(acc[r][h], p, alpha, beta, ep, EpilogueAt{at.row + r, at.col + h * GEMM_VW}));
+        }
+    }
+}
+
+template <class Ep>
+inline void gemm_micro_kernel_fused(int kc, const float* a, const float* b, float* c, int ldc, float alpha,
+                                    float beta, const Ep& ep, EpilogueAt at) {
+    GemmVec acc[GEMM_MR][2];
+    gemm_micro_accumulate(kc, a, b, acc);
+    gemm_store_tile(acc, c, ldc, alpha, beta, ep, at);
+}
+
+// 边界块：寄存器块先写到临时缓冲，有效部分逐元素走标量版本的写回
+template <class Ep>
+inline void gemm_micro_kernel_fused_edge(int kc, const float* a, const float* b, float* c, int ldc, int rows,
+                                         int cols, float alpha, float beta, const Ep& ep, EpilogueAt at) {
+    alignas(64) float tmp[GEMM_MR * GEMM_NR] = {0};
+    gemm_micro_kernel(kc, a, b, tmp, GEMM_NR);
+    for (int r = 0; r < rows; ++r) {
+        for (int j = 0; j < cols; ++j) {
+            float* p = c + static_cast<size_t>(r) * ldc + j;
+            EpilogueAt pos{at.row + r, at.col + j};
+            *p = ep_finish(tmp[r * GEMM_NR + j], p, alpha, beta, ep, pos);
+        }
+    }
+}
+
+// at 为本宏块左上角在整个 C 中的坐标（算子按全局坐标取偏置 / 残差）
+template <class Ep>
+inline void gemm_macro_kernel_fused(int mc, int nc, int kc, const float* a_pack, const float* b_pack, float* C,
+                                    int ldc, float alpha, float beta, const Ep& ep, EpilogueAt at) {
+    for (int jr = 0; jr < nc; jr += GEMM_NR) {
+        int cols = std::min(GEMM_NR, nc - jr);
+        const float* b = b_pack + static_cast<size_t>(jr) * kc;
+        for (int ir = 0; ir < mc; ir += GEMM_MR) {
+            int rows = std::min(GEMM_MR, mc - ir);
+            const float* a = a_pack + static_cast<size_t>(ir) * kc;
+            float* c = C + static_cast<size_t>(ir) * ldc + jr;
+            EpilogueAt pos{at.row + ir, at.col + jr};
+            if (rows == GEMM_MR && cols == GEMM_NR) {
+                gemm_micro_kernel_fused(kc, a, b, c, ldc, alpha, beta, ep, pos);
+            } else {
+                gemm_micro_kernel_fused_edge(kc, a, b, c, ldc, rows, cols, alpha, beta, ep, pos);
+            }
+        }
+    }
+}
+
+// 带跨度的融合 GEMM，调用方提供打包缓冲区（64 字节对齐，按 bk 分配）；要求 K > 0。mc 按 GEMM_FUSED_MC 截断
+template <class Ep>
+inline void gemm_packed_fused(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int N,
+                              int K, const GemmBlocking& blocking, float* a_pack, float* b_pack, float alpha,
+                              float beta, const Ep& ep) {
+    const GemmBlocking bk = gemm_blocking_fused(blocking);
+    for (int jc = 0; jc < N; jc += bk.nc) {
+        int nc = std::min(bk.nc, N - jc);
+        for (int pc = 0; pc < K; pc += bk.kc) {
+            int kc = std::min(bk.kc, K - pc);
+            const float beta_pc = pc == 0 ? beta : 1.0f;
+            const bool last = pc + kc >= K;
+            gemm_pack_b(B + static_cast<size_t>(pc) * ldb + jc, ldb, kc, nc, b_pack);
+            for (int ic = 0; ic < M; ic += bk.mc) {
+                int mc = std::min(bk.mc, M - ic);
+                gemm_pack_a(A + static_cast<size_t>(ic) * lda + pc, lda, mc, kc, a_pack);
+                float* c = C + static_cast<size_t>(ic) * ldc + jc;
+                if (last)
+                    gemm_macro_kernel_fused(mc, nc, kc, a_pack, b_pack, c, ldc, alpha, beta_pc, ep, EpilogueAt{ic, jc});
+                else
+                    gemm_macro_kernel_fused(mc, nc, kc, a_pack, b_pack, c, ldc, alpha, beta_pc, Epilogue<>{},
+                                            EpilogueAt{ic, jc});
+            }
+        }
+    }
+}
+
+// 紧凑存储的入口：C = ep(alpha * A * B + beta * C)，分块大小来自 TileSizeCalculator::compute
+template <class Ep>
+inline void gemm_packed_fused(const float* A, const float* B, float* C, int M, int N, int K, const TileSize& ts,
+                              float alpha, float beta, const Ep& ep, const CacheConfig& cache = CacheConfig()) {
+    GemmBlocking bk = gemm_blocking_from_tiles(ts, cache, M, N, K);
+    size_t a_bytes = (gemm_pack_a_size(bk) * sizeof(float) + 63) / 64 * 64;
+    size_t b_bytes = (gemm_pack_b_size(bk) * sizeof(float) + 63) / 64 * 64;
+    float* a_pack = static_cast<float*>(slab_alloc(a_bytes));
+    float* b_pack = static_cast<float*>(slab_alloc(b_bytes));
+    gemm_packed_fused(A, K, B, N, C, N, M, N, K, bk, a_pack, b_pack, alpha, beta, ep);
+    slab_free(a_pack, a_bytes);
+    slab_free(b_pack, b_bytes);
+}
+
+#pragma GCC diagnostic pop
+
+#endif // GEMM_PACKED_H
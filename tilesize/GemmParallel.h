@@ -0,0 +1,186 @@
+#ifndef GEMM_PARALLEL_H
+#define GEMM_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "../gemm/ThreadPool.h"
+#include "GemmPacked.h"
+
+// 多线程 GEMM：C += A * B
+// gemm_blocked 中 i0 / j0 两层外循环得到的输出块互不相关，这里把它们作为任务分给线程：
+//   - 每个线程有私有的打包 A / B 缓冲区，整个输出块的 K 循环都在本线程完成，C 无需加锁
+//   - 初始按行优先把连续的块分给各线程（相邻块共享 A 行或 B 列），做完后从其他线程的队尾窃取
+//   - 块宽受 L3 约束：CacheConfig::l3_size 已是每个逻辑 CPU 的 L3 份额，每个线程的 B 面板不超过半份，
+//     所有线程合计不超过半个共享 L3
+
+// 单个线程的任务区间 [begin, end)，打包进一个 64 位原子量：
+// 自己从队头取，窃取者从队尾取，用 CAS 保证每个块只被执行一次
+struct alignas(64) GemmTaskRange {
+    std::atomic<uint64_t> range{0};
+
+    static uint64_t pack(uint32_t begin, uint32_t end) { return (static_cast<uint64_t>(begin) << 32) | end; }
+
+    void reset(uint32_t begin, uint32_t end) { range.store(pack(begin, end), std::memory_order_relaxed); }
+
+    // 本线程从队头取一个块
+    bool pop_front(int& task) {
+        uint64_t cur = range.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t b = static_cast<uint32_t>(cur >> 32), e = static_cast<uint32_t>(cur);
+            if (b >= e) return false;
+            if (range.compare_exchange_weak(cur, pack(b + 1, e), std::memory_order_acq_rel)) {
+                task = static_cast<int>(b);
+                return true;
+            }
+        }
+    }
+
+    // 其他线程从队尾窃取一个块
+    bool steal_back(int& task) {
+        uint64_t cur = range.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t b = static_cast<uint32_t>(cur >> 32), e = static_cast<uint32_t>(cur);
+            if (b >= e) return false;
+            if (range.compare_exchange_weak(cur, pack(b, e - 1), std::memory_order_acq_rel)) {
+                task = static_cast<int>(e - 1);
+                return true;
+            }
+        }
+    }
+};
+
+// 每个线程的执行统计
+struct GemmWorkerStats {
+    int executed = 0;  // 执行的块数
+    int stolen = 0;    // 其中窃取来的块数
+};
+
+class GemmParallel {
+public:
+    explicit GemmParallel(ThreadPool& pool, const CacheConfig& cache = CacheConfig())
+        : pool_(pool), cache_(cache), ranges_(pool.size()), stats_(pool.size()),
+          a_bufs_(pool.size(), nullptr), b_bufs_(pool.size(), nullptr) {}
+
+    ~GemmParallel() { release_buffers(); }
+
+    GemmParallel(const GemmParallel&) = delete;
+    GemmParallel& operator=(const GemmParallel&) = delete;
+
+    const std::vector<GemmWorkerStats>& stats() const { return stats_; }
+    int tile_m() const { return tile_m_; }
+    int tile_n() const { return tile_n_; }
+
+    void operator()(const float* A, const float* B, float* C, int M, int N, int K, const TileSize& ts) {
+        const int nt = pool_.size();
+        GemmBlocking bk = gemm_blocking_from_tiles(ts, cache_, M, N, K);
+        choose_tiles(bk, M, N, nt);
+        ensure_buffers(bk);
+
+        const int tiles_m = (M + tile_m_ - 1) / tile_m_;
+        const int tiles_n = (N + tile_n_ - 1) / tile_n_;
+        const int tiles = tiles_m * tiles_n;
+        for (int t = 0; t < nt; ++t) {
+            ranges_[t].reset(static_cast<uint32_t>(static_cast<int64_t>(tiles) * t / nt),
+                             static_cast<uint32_t>(static_cast<int64_t>(tiles) * (t + 1) / nt));
+            stats_[t] = GemmWorkerStats();
+        }
+
+        pool_.run([&](int tid) {
+            auto run_tile = [&](int task) {
+                int i0 = (task / tiles_n) * tile_m_;
+                int j0 = (task % tiles_n) * tile_n_;
+                int mt = std::min(tile_m_, M - i0);
+                int nn = std::min(tile_n_, N - j0);
+                GemmBlocking tile_bk = bk;
+                tile_bk.nc = tile_n_;
+                gemm_packed(A + static_cast<size_t>(i0) * K, K, B + j0, N, C + static_cast<size_t>(i0) * N + j0, N,
+                            mt, nn, K, tile_bk, a_bufs_[tid], b_bufs_[tid]);
+            };
+
+            int task;
+            while (ranges_[tid].pop_front(task)) {
+                run_tile(task);
+                ++stats_[tid].executed;
+            }
+            // 自己的队列空了：依次从其他线程队尾窃取
+            for (int v = 1; v < nt; ++v) {
+                GemmTaskRange& victim = ranges_[(tid + v) % nt];
+                while (victim.steal_back(task)) {
+                    run_tile(task);
+                    ++stats_[tid].executed;
+                    ++stats_[tid].stolen;
+                }
+            }
+        });
+    }
+
+private:
+    // 选择输出块大小：
+    //   块宽 tile_n：每个线程的 B 面板（kc × tile_n）不超过半份 l3_size（已按共享的逻辑 CPU 数平分，不再除以线程数）
+    //   块高 tile_m：mc 的整数倍
+    //   块数至少是线程数的 4 倍，给窃取留出余地
+    void choose_tiles(const GemmBlocking& bk, int M, int N, int nt) {
+        auto round_up = [](int v, int r) { return (v + r - 1) / r * r; };
+        const int64_t fsize = sizeof(float);
+        int64_t per_thread_l3 = cache_.l3_size / 2;
+        tile_n_ = std::max(GEMM_NR, bk.nc);
+        while (tile_n_ > GEMM_NR && tile_n_ * bk.kc * fsize > per_thread_l3) tile_n_ -= GEMM_NR;
+        tile_n_ = std::min(tile_n_, round_up(N, GEMM_NR));
+        tile_m_ = std::min(round_up(M, GEMM_MR), bk.mc * 4);
+
+        auto tile_count = [&] { return ((M + tile_m_ - 1) / tile_m_) * ((N + tile_n_ - 1) / tile_n_); };
+        while (tile_count() < 4 * nt) {
+            if (tile_m_ > bk.mc) {
+                tile_m_ = std::max(bk.mc, round_up(tile_m_ / 2, GEMM_MR));
+            } else if (tile_n_ > 2 * GEMM_NR) {
+                tile_n_ = round_up(tile_n_ / 2, GEMM_NR);
+            } else if (tile_m_ > GEMM_MR) {
+                tile_m_ = round_up(tile_m_ / 2, GEMM_MR);
+            } else {
+                break;
+            }
+        }
+    }
+
+    // 为每个线程分配私有打包缓冲区，尺寸不足时才重新分配
+    void ensure_buffers(const GemmBlocking& bk) {
+        GemmBlocking need = bk;
+        need.nc = tile_n_;
+        size_t a_elems = gemm_pack_a_size(need), b_elems = gemm_pack_b_size(need);
+        if (a_elems <= a_capacity_ && b_elems <= b_capacity_) return;
+        release_buffers();
+        a_capacity_ = std::max(a_elems, a_capacity_);
+        b_capacity_ = std::max(b_elems, b_capacity_);
+        for (int t = 0; t < pool_.size(); ++t) {
+            a_bufs_[t] = static_cast<float*>(std::aligned_alloc(64, (a_capacity_ * sizeof(float) + 63) / 64 * 64));
+            b_bufs_[t] = static_cast<float*>(std::aligned_alloc(64, (b_capacity_ * sizeof(float) + 63) / 64 * 64));
+            if (!a_bufs_[t] || !b_bufs_[t]) throw std::bad_alloc();
+        }
+    }
+
+    void release_buffers() {
+        for (size_t t = 0; t < a_bufs_.size(); ++t) {
+            std::free(a_bufs_[t]);
+            std::free(b_bufs_[t]);
+            a_bufs_[t] = b_bufs_[t] = nullptr;
+        }
+    }
+
+    ThreadPool& pool_;
+    CacheConfig cache_;
+    std::vector<GemmTaskRange> ranges_;
+    std::vector<GemmWorkerStats> stats_;
+    std::vector<float*> a_bufs_;
+    std::vector<float*> b_bufs_;
+    size_t a_capacity_ = 0;
+    size_t b_capacity_ = 0;
+    int tile_m_ = 0;
+    int tile_n_ = 0;
+};
+
+#endif // GEMM_PARALLEL_H
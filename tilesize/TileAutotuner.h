@@ -0,0 +1,315 @@
+#ifndef TILE_AUTOTUNER_H
+#define TILE_AUTOTUNER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "TitleSizeCalculator.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+// 经验调优的分块搜索：
+//   1. 枚举候选 TileSize，用与 TileSizeCalculator 相同的缓存模型剪枝（L1 / L2 / L3 工作集不超过容量）
+//   2. 按 L2 级算术强度排序，取前若干个（外加启发式结果作为基线）在本机上实际计时
+//   3. 最快的配置按 (内核, CPU, M, N, K, dtype) 写入磁盘上的调优数据库，之后直接查表，不再预热和搜索
+// 不同内核、不同机器（或不同编译目标）的结果各占一条记录，共用一个数据库文件也不会互相覆盖。
+
+// 被调优的 GEMM：C += A * B，分块参数由 ts 给出（gemm_blocked / gemm_packed 的签名）
+using TileGemmKernel = std::function<void(const float* A, const float* B, float* C, int M, int N, int K,
+                                          const TileSize& ts)>;
+
+// 内核实际使用的分块参数：很多内核只用到 TileSize 的一部分（gemm_packed 只看 mc / nc / kc），
+// 映射结果相同的候选是同一个配置，只计时一次
+using TileEffectiveParams = std::function<std::vector<int>(const TileSize& ts, int M, int N, int K)>;
+
+// 一个被调优的内核：name 是数据库键的一部分，effective 为空时按 TileSize 的全部字段去重
+struct TileTuningTarget {
+    std::string name;
+    TileGemmKernel kernel;
+    TileEffectiveParams effective;
+};
+
+// CPU 标签：处理器型号（cpuid 品牌字符串）加编译目标的 SIMD 宽度，空白替换为 '_'
+inline std::string tuning_cpu_tag() {
+    std::string brand;
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned regs[12] = {0};
+    unsigned max_ext = __get_cpuid_max(0x80000000, nullptr);
+    if (max_ext >= 0x80000004) {
+        for (unsigned i = 0; i < 3; ++i) __get_cpuid(0x80000002 + i, &regs[4 * i], &regs[4 * i + 1], &regs[4 * i + 2], &regs[4 * i + 3]);
+        brand.assign(reinterpret_cast<const char*>(regs), sizeof(regs));
+        brand = brand.c_str();  // 去掉末尾的 '\0'
+    }
+#endif
+    std::string tag;
+    for (char c : brand) {
+        if (c == ' ' || c == '\t') {
+            if (!tag.empty() && tag.back() != '_') tag += '_';
+        } else {
+            tag += c;
+        }
+    }
+    while (!tag.empty() && tag.back() == '_') tag.pop_back();
+    if (tag.empty()) tag = "unknown_cpu";
+#if defined(__AVX512F__)
+    tag += "+avx512";
+#elif defined(__AVX2__)
+    tag += "+avx2";
+#else
+    tag += "+sse";
+#endif
+    return tag;
+}
+
+// 一条调优结果
+struct TuningRecord {
+    TileSize ts;
+    double gflops;  // 调优时测得的吞吐
+};
+
+// 调优数据库：文本文件，每行一条记录
+//   kernel cpu M N K dtype ti_inner ti_mid ti_outer tj_inner tj_mid tj_outer tk_mid gflops
+// 内核名与 CPU 标签不能含空白
+class TuningDatabase {
+public:
+    explicit TuningDatabase(const std::string& path = "tile_tuning.db", const std::string& cpu = tuning_cpu_tag())
+        : path_(path), cpu_(cpu) {
+        load();
+    }
+
+    // 查找本机（构造时给定的 CPU 标签）上 kernel 的记录
+    bool lookup(const std::string& kernel, int M, int N, int K, const std::string& dtype, TuningRecord& rec) const {
+        auto it = records_.find(Key(kernel, cpu_, M, N, K, dtype));
+        if (it == records_.end()) return false;
+        rec = it->second;
+        return true;
+    }
+
+    void store(const std::string& kernel, int M, int N, int K, const std::string& dtype, const TuningRecord& rec) {
+        records_[Key(kernel, cpu_, M, N, K, dtype)] = rec;
+    }
+
+    // 先写临时文件再改名，避免并发运行时读到写了一半的数据库
+    bool save() const {
+        std::string tmp = path_ + ".tmp";
+        std::ofstream out(tmp);
+        if (!out) {
+            std::cerr << "Warning: cannot write tuning database " << tmp << "\n";
+            return false;
+        }
+        out << "# kernel cpu M N K dtype ti_inner ti_mid ti_outer tj_inner tj_mid tj_outer tk_mid gflops\n";
+        for (const auto& kv : records_) {
+            const TileSize& t = kv.second.ts;
+            out << std::get<0>(kv.first) << ' ' << std::get<1>(kv.first) << ' ' << std::get<2>(kv.first) << ' '
+                << std::get<3>(kv.first) << ' ' << std::get<4>(kv.first) << ' ' << std::get<5>(kv.first) << ' '
+                << t.ti_inner << ' ' << t.ti_mid << ' ' << t.ti_outer << ' '
+                << t.tj_inner << ' ' << t.tj_mid << ' ' << t.tj_outer << ' ' << t.tk_mid << ' '
+                << kv.second.gflops << '\n';
+        }
+        out.close();
+        return out && std::rename(tmp.c_str(), path_.c_str()) == 0;
+    }
+
+    size_t size() const { return records_.size(); }
+    const std::string& path() const { return path_; }
+    const std::string& cpu() const { return cpu_; }
+
+private:
+    using Key = std::tuple<std::string, std::string, int, int, int, std::string>;
+
+    void load() {
+        std::ifstream in(path_);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream ss(line);
+            int M, N, K;
+            std::string kernel, cpu, dtype;
+            TuningRecord rec;
+            TileSize& t = rec.ts;
+            // 旧格式（没有 kernel / cpu 两列）的记录读不出数字列，直接跳过
+            if (ss >> kernel >> cpu >> M >> N >> K >> dtype >> t.ti_inner >> t.ti_mid >> t.ti_outer >> t.tj_inner >> t.tj_mid
+                   >> t.tj_outer >> t.tk_mid >> rec.gflops) {
+                records_[Key(kernel, cpu, M, N, K, dtype)] = rec;
+            }
+        }
+    }
+
+    std::string path_;
+    std::string cpu_;
+    std::map<Key, TuningRecord> records_;
+};
+
+// 搜索参数
+struct AutotuneOptions {
+    int max_candidates = 16;  // 实际计时的候选个数（按模型得分取前若干个）
+    int repeats = 3;          // 每个候选计时次数，取最快一次
+    bool verbose = false;     // 打印每个候选的测量结果
+};
+
+class TileAutotuner {
+public:
+    TileAutotuner(const CacheConfig& cache, TuningDatabase& db, const AutotuneOptions& opt = AutotuneOptions())
+        : cache_(cache), db_(db), opt_(opt) {}
+
+    // 通过缓存模型的候选，按算术强度从高到低排序
+    std::vector<TileSize> candidates(int M, int N, int K) const {
+        const int64_t fsize = sizeof(float);
+        const int64_t l1 = cache_.l1_size / fsize, l2 = cache_.l2_size / fsize, l3 = cache_.l3_size / fsize;
+        struct Scored {
+            TileSize ts;
+            double score;
+        };
+        std::vector<Scored> pool;
+
+        for (int ti_inner : {1, 2, 4, 8}) {
+            for (int tj_inner : {4, 8, 16, 32, 64}) {
+                for (int tk : {16, 32, 64, 128, 256, 512}) {
+                    // L1：一个内层块的 A 条带、B 条带与 C 块
+                    if (int64_t(ti_inner) * tk + int64_t(tk) * tj_inner + int64_t(ti_inner) * tj_inner > l1) continue;
+                    for (int ti_mid : {1, 2, 4, 8, 16, 32}) {
+                        for (int tj_mid : {1, 2, 4, 8, 16}) {
+                            int64_t ti = int64_t(ti_inner) * ti_mid, tj = int64_t(tj_inner) * tj_mid;
+                            if (ti > M * 2 || tj > N * 2 || tk > K * 2) continue;  // 远超问题规模的块没有意义
+                            // L2：中层块
+                            if (ti * tk + tk * tj + ti * tj > l2) continue;
+
+                            TileSize ts;
+                            ts.ti_inner = ti_inner;
+                            ts.ti_mid = ti_mid;
+                            ts.tj_inner = tj_inner;
+                            ts.tj_mid = tj_mid;
+                            ts.tk_mid = tk;
+                            fit_outer(ts, M, N, l3);
+                            pool.push_back({ts, double(ti * tj * tk) / double(ti * tk + tk * tj + ti * tj)});
+                        }
+                    }
+                }
+            }
+        }
+        std::stable_sort(pool.begin(), pool.end(), [](const Scored& a, const Scored& b) { return a.score > b.score; });
+
+        std::vector<TileSize> out;
+        for (const Scored& s : pool) out.push_back(s.ts);
+        return out;
+    }
+
+    // 查表命中直接返回，否则搜索、写库并保存
+    TileSize tune(int M, int N, int K, const std::string& dtype, const TileTuningTarget& target) {
+        TuningRecord rec;
+        if (db_.lookup(target.name, M, N, K, dtype, rec)) {
+            last_from_db_ = true;
+            return rec.ts;
+        }
+        last_from_db_ = false;
+
+        // 候选：启发式结果作为基线，其余按 tk 分组后轮流取各组得分最高的，
+        // 避免计时预算全部落在同一个 tk 附近；映射到内核参数后重复的候选跳过，不占计时名额
+        auto effective = [&](const TileSize& ts) {
+            if (target.effective) return target.effective(ts, M, N, K);
+            return std::vector<int>{ts.ti_inner, ts.ti_mid, ts.ti_outer, ts.tj_inner, ts.tj_mid, ts.tj_outer, ts.tk_mid};
+        };
+        std::set<std::vector<int>> seen;
+        std::vector<TileSize> trial;
+        auto try_add = [&](const TileSize& ts) {
+            if (seen.insert(effective(ts)).second) trial.push_back(ts);
+        };
+        try_add(TileSizeCalculator(cache_).compute(M, N, K));
+        std::map<int, std::vector<TileSize>> by_tk;
+        for (const TileSize& ts : candidates(M, N, K)) by_tk[ts.tk_mid].push_back(ts);
+        for (size_t rank = 0; static_cast<int>(trial.size()) < opt_.max_candidates; ++rank) {
+            bool any = false;
+            for (const auto& group : by_tk) {
+                if (rank >= group.second.size() || static_cast<int>(trial.size()) >= opt_.max_candidates) continue;
+                try_add(group.second[rank]);
+                any = true;
+            }
+            if (!any) break;
+        }
+        last_trials_ = static_cast<int>(trial.size());
+
+        std::vector<float> A(static_cast<size_t>(M) * K), B(static_cast<size_t>(K) * N), C(static_cast<size_t>(M) * N);
+        for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>(i % 7) * 0.25f;
+        for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<float>(i % 5) * 0.5f;
+
+        rec.gflops = -1.0;
+        for (const TileSize& ts : trial) {
+            double sec = measure(target.kernel, A, B, C, M, N, K, ts);
+            double gflops = 2.0 * M * N * K / sec * 1e-9;
+            if (opt_.verbose) {
+                std::cout << "  ti " << ts.ti_inner << "x" << ts.ti_mid << "x" << ts.ti_outer << "  tj " << ts.tj_inner
+                          << "x" << ts.tj_mid << "x" << ts.tj_outer << "  tk " << ts.tk_mid << ": " << gflops
+                          << " GFLOP/s\n";
+            }
+            if (gflops > rec.gflops) {
+                rec.gflops = gflops;
+                rec.ts = ts;
+            }
+        }
+
+        db_.store(target.name, M, N, K, dtype, rec);
+        db_.save();
+        return rec.ts;
+    }
+
+    bool last_from_db() const { return last_from_db_; }  // 最近一次 tune 是否命中数据库
+    int last_trials() const { return last_trials_; }     // 最近一次搜索实际计时的（去重后）候选数
+
+private:
+    // 外层分块数：整个 L3 级块的工作集不超过 L3，且不超过覆盖整个矩阵所需的块数
+    static void fit_outer(TileSize& ts, int M, int N, int64_t l3) {
+        int64_t ti = int64_t(ts.ti_inner) * ts.ti_mid, tj = int64_t(ts.tj_inner) * ts.tj_mid, tk = ts.tk_mid;
+        int max_io = static_cast<int>(std::max<int64_t>(1, (M + ti - 1) / ti));
+        int max_jo = static_cast<int>(std::max<int64_t>(1, (N + tj - 1) / tj));
+        ts.ti_outer = 1;
+        ts.tj_outer = 1;
+        auto l3_usage = [&](int io, int jo) {
+            int64_t bi = ti * io, bj = tj * jo;
+            return bi * tk + tk * bj + bi * bj;
+        };
+        while (true) {
+            bool grown = false;
+            if (ts.tj_outer * 2 <= max_jo && l3_usage(ts.ti_outer, ts.tj_outer * 2) <= l3 / 2) {
+                ts.tj_outer *= 2;
+                grown = true;
+            }
+            if (ts.ti_outer * 2 <= max_io && l3_usage(ts.ti_outer * 2, ts.tj_outer) <= l3 / 2) {
+                ts.ti_outer *= 2;
+                grown = true;
+            }
+            if (!grown) break;
+        }
+    }
+
+    double measure(const TileGemmKernel& kernel, const std::vector<float>& A, const std::vector<float>& B,
+                   std::vector<float>& C, int M, int N, int K, const TileSize& ts) const {
+        double best = 1e30;
+        for (int r = 0; r < std::max(1, opt_.repeats); ++r) {
+            std::fill(C.begin(), C.end(), 0.0f);
+            auto start = std::chrono::steady_clock::now();
+            kernel(A.data(), B.data(), C.data(), M, N, K, ts);
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(end - start).count());
+        }
+        return std::max(best, 1e-9);
+    }
+
+    CacheConfig cache_;
+    TuningDatabase& db_;
+    AutotuneOptions opt_;
+    bool last_from_db_ = false;
+    int last_trials_ = 0;
+};
+
+#endif // TILE_AUTOTUNER_H
@@ -0,0 +1,224 @@
+#ifndef Z3_TILE_SOLVER_H
+#define Z3_TILE_SOLVER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "z3++.h"
+#include "TitleSizeCalculator.h"
+
+// 基于 Z3 的多级分块求解：把 TileSizeCalculator 中用 while 循环逐步减半的容量条件写成约束，
+// 在可行域内最大化 L2 级算术强度，得到的分块一定满足全部约束（sat 即可行性证明）。
+//
+// 变量：ti_inner, tj_inner(= simd * tj_vec), ti_mid, tj_mid, tk_mid, ti_outer, tj_outer
+// 约束：
+//   寄存器   ti_inner * tj_vec 个累加器 + tj_vec 个 B 向量 + 1 个广播 <= 向量寄存器数
+//   SIMD     tj_inner 是 SIMD 宽度的整数倍
+//   L1       ti_inner * tk + tk * tj_inner + ti_inner * tj_inner <= L1
+//   L2       ti * tk + tk * tj + ti * tj <= L2                      （ti = ti_inner * ti_mid，tj 同理）
+//   L3       (ti*ti_outer) * tk + tk * (tj*tj_outer) + (ti*ti_outer) * (tj*tj_outer) <= L3
+//   整除     M % ti == 0、N % tj == 0、K % tk == 0（尽量满足，代价过高时逐个放宽）
+// 目标：先最大化 ti*tj*tk / (ti*tk + tk*tj + ti*tj)，再固定内层最大化 ti_outer * tj_outer。
+// 整除只作为次要目标：强度不低于最优的 90% 时才要求整除，否则边界块由内核自行处理。
+// Z3 的 optimize 不支持非线性目标，这里对阈值做二分，每一步只是一次可满足性检查。
+//
+// 编译：g++ -O2 -std=c++17 xxx.cpp -lz3
+
+struct Z3TileOptions {
+    int simd_width = 8;         // 每个向量寄存器的 float 个数（AVX2 为 8，AVX-512 为 16）
+    int vector_registers = 16;  // 可用向量寄存器数（AVX2 为 16，AVX-512 为 32）
+};
+
+struct Z3TileResult {
+    bool ok = false;         // 是否找到可行解
+    TileSize ts{};
+    double intensity = 0.0;  // ti*tj*tk / (ti*tk + tk*tj + ti*tj)：每搬运一个元素完成的乘加次数
+    bool divides_m = false;  // 最终解满足的整除条件
+    bool divides_n = false;
+    bool divides_k = false;
+};
+
+class Z3TileSolver {
+public:
+    explicit Z3TileSolver(const CacheConfig& cache, const Z3TileOptions& opt = Z3TileOptions())
+        : cache_(cache), opt_(opt) {}
+
+    Z3TileResult solve(int M, int N, int K) const {
+        using namespace z3;
+        context c;
+        solver s(c);
+
+        const int64_t fsize = sizeof(float);
+        const int64_t l1 = cache_.l1_size / fsize, l2 = cache_.l2_size / fsize, l3 = cache_.l3_size / fsize;
+        const int simd = opt_.simd_width;
+        const int m_max = std::max(M, 1), k_max = std::max(K, 1);
+        const int n_pad = std::max((N + simd - 1) / simd * simd, simd);
+
+        expr ti_inner = c.int_const("ti_inner"), tj_vec = c.int_const("tj_vec");
+        expr ti_mid = c.int_const("ti_mid"), tj_mid = c.int_const("tj_mid"), tk = c.int_const("tk_mid");
+        expr ti_outer = c.int_const("ti_outer"), tj_outer = c.int_const("tj_outer");
+        // 派生量直接写成乘积表达式，不引入额外变量
+        expr tj_inner = simd * tj_vec;
+        expr ti = ti_inner * ti_mid, tj = tj_inner * tj_mid;
+        expr bi = ti * ti_outer, bj = tj * tj_outer;  // L3 级块的行数 / 列数
+
+        // 取值范围
+        // 每个变量都给出显式上下界，非线性求解在有界整数上才快
+        const int regs = opt_.vector_registers;
+        s.add(ti_inner >= 1 && ti_inner <= regs && tj_vec >= 1 && tj_vec <= regs);
+        s.add(ti_mid >= 1 && ti_mid <= m_max && tj_mid >= 1 && tj_mid <= n_pad && tk >= 1 && tk <= k_max);
+        s.add(ti_outer >= 1 && ti_outer <= m_max && tj_outer >= 1 && tj_outer <= n_pad);
+        s.add(ti <= m_max && tj <= n_pad && tk <= k_max && bi <= m_max && bj <= n_pad);
+
+        // 寄存器
+        s.add(ti_inner * tj_vec + tj_vec + 1 <= regs);
+        // 缓存容量
+        s.add(ti_inner * tk + tk * tj_inner + ti_inner * tj_inner <= c.int_val(l1));
+        s.add(ti * tk + tk * tj + ti * tj <= c.int_val(l2));
+        s.add(bi * tk + tk * bj + bi * bj <= c.int_val(l3));
+        if (s.check() != sat) return Z3TileResult();
+
+        // 第一阶段：二分最大化算术强度（放大 SCALE 倍取整）。
+        // 上界：ti*tj*tk / (ti*tk + tk*tj + ti*tj) = 1 / (1/ti + 1/tj + 1/tk) 受矩阵尺寸限制，
+        // 又由 AM-GM 不超过 sqrt(L2/3)/3，上界收紧后不可满足的检查也很快
+        expr work = ti * tj * tk;
+        expr traffic = ti * tk + tk * tj + ti * tj;
+        double bound = std::min(1.0 / (1.0 / m_max + 1.0 / n_pad + 1.0 / k_max), std::sqrt(l2 / 3.0) / 3.0);
+        model best = s.get_model();
+        int64_t value = maximize_intensity(s, work, traffic, best, static_cast<int64_t>(bound * SCALE) + 1);
+
+        // 整除：在强度损失不超过 10% 的前提下尽量多满足。
+        // 写成“取 M 的某个因数”的有限析取，比 q * ti == M 这种无界乘积好解得多
+        const bool tiers[][3] = {{true, true, true}, {true, false, true}, {true, true, false}, {false, true, true},
+                                 {true, false, false}, {false, false, true}, {false, true, false}};
+        // 候选因数先在 C++ 里按 SIMD 宽度等硬约束过滤，明显无解的档位不必交给 Z3
+        std::vector<int> div_m = divisors(M), div_n, div_k;
+        for (int d : divisors(N))
+            if (d % simd == 0) div_n.push_back(d);
+        for (int d : divisors(K))  // ti_inner = 1、tj_inner = simd 时仍放不进 L1 的 tk 直接排除
+            if (d >= simd && int64_t(d) * (1 + simd) + simd <= l1) div_k.push_back(d);
+        Z3TileResult r;
+        for (const auto& t : tiers) {
+            if ((t[0] && div_m.empty()) || (t[1] && div_n.empty()) || (t[2] && div_k.empty())) continue;
+            s.push();
+            if (t[0]) s.add(one_of(c, ti, div_m));
+            if (t[1]) s.add(one_of(c, tj, div_n));
+            if (t[2]) s.add(one_of(c, tk, div_k));
+            s.add(c.int_val(SCALE) * work >= c.int_val(value * 9 / 10) * traffic);
+            if (s.check() == sat) {
+                best = s.get_model();
+                maximize_intensity(s, work, traffic, best, value);
+                r.divides_m = t[0];
+                r.divides_n = t[1];
+                r.divides_k = t[2];
+                break;
+            }
+            s.pop();
+        }
+
+        // 第二阶段：固定 L1 / L2 级分块，最大化 L3 级块覆盖的输出面积
+        for (const expr& v : {ti_inner, tj_vec, ti_mid, tj_mid, tk}) s.add(v == best.eval(v, true));
+        int64_t ti_val = eval_int(best, ti), tj_val = eval_int(best, tj);
+        int64_t olo = eval_int(best, ti_outer * tj_outer);
+        int64_t ohi = ((m_max + ti_val - 1) / ti_val) * ((n_pad + tj_val - 1) / tj_val);
+        while (olo < ohi) {
+            int64_t mid = olo + (ohi - olo + 1) / 2;
+            s.push();
+            s.add(ti_outer * tj_outer >= c.int_val(mid));
+            if (s.check() == sat) {
+                best = s.get_model();
+                olo = std::max(mid, eval_int(best, ti_outer * tj_outer));
+                s.pop();
+            } else {
+                s.pop();
+                ohi = mid - 1;
+            }
+        }
+
+        r.ok = true;
+        r.ts.ti_inner = static_cast<int>(eval_int(best, ti_inner));
+        r.ts.ti_mid = static_cast<int>(eval_int(best, ti_mid));
+        r.ts.ti_outer = static_cast<int>(eval_int(best, ti_outer));
+        r.ts.tj_inner = static_cast<int>(eval_int(best, tj_inner));
+        r.ts.tj_mid = static_cast<int>(eval_int(best, tj_mid));
+        r.ts.tj_outer = static_cast<int>(eval_int(best, tj_outer));
+        r.ts.tk_mid = static_cast<int>(eval_int(best, tk));
+        r.intensity = double(eval_int(best, work)) / double(std::max<int64_t>(1, eval_int(best, traffic)));
+        return r;
+    }
+
+private:
+    static constexpr int64_t SCALE = 1000;
+
+    // 在 s 当前约束下二分最大化 SCALE * work / traffic（相对精度 1%），best 从一个可行解出发并被更新。
+    // 所有变量都有界，每次检查都会终止；unknown 按不可满足处理，结果仍是可行解
+    static int64_t maximize_intensity(z3::solver& s, const z3::expr& work, const z3::expr& traffic,
+                                      z3::model& best, int64_t hi) {
+        z3::context& c = s.ctx();
+        auto value_of = [&](const z3::model& m) {
+            return eval_int(m, work) * SCALE / std::max<int64_t>(1, eval_int(m, traffic));
+        };
+        int64_t lo = value_of(best);
+        // 精度 1%：贴近最优值的不可满足检查代价最高，而最后 1% 的强度对性能没有意义
+        while (hi - lo > std::max<int64_t>(1, lo / 100)) {
+            int64_t mid = lo + (hi - lo + 1) / 2;
+            s.push();
+            s.add(c.int_val(SCALE) * work >= c.int_val(mid) * traffic);
+            if (s.check() == z3::sat) {
+                best = s.get_model();
+                lo = std::max(mid, value_of(best));
+                s.pop();
+            } else {
+                s.pop();
+                hi = mid - 1;
+            }
+        }
+        return lo;
+    }
+
+    // n 的全部因数
+    static std::vector<int> divisors(int n) {
+        std::vector<int> d;
+        for (int i = 1; static_cast<int64_t>(i) * i <= n; ++i) {
+            if (n % i) continue;
+            d.push_back(i);
+            if (i != n / i) d.push_back(n / i);
+        }
+        return d;
+    }
+
+    // e 取 values 中的某一个值；values 为空时不可满足
+    static z3::expr one_of(z3::context& c, const z3::expr& e, const std::vector<int>& values) {
+        z3::expr any = c.bool_val(false);
+        for (int v : values) any = any || e == v;
+        return any;
+    }
+
+    static int64_t eval_int(const z3::model& m, const z3::expr& e) {
+        return m.eval(e, true).get_numeral_int64();
+    }
+
+    CacheConfig cache_;
+    Z3TileOptions opt_;
+};
+
+// 与 print_tile_format 相同的 "ir::f32(...)" 分块格式
+inline std::string tile_split_format_a(const TileSize& ts) {
+    std::ostringstream ss;
+    ss << "ir::f32(" << ts.ti_inner << ", 1)(" << ts.ti_mid << ", 1)(1, " << ts.tk_mid << ")(" << ts.ti_outer
+       << ", 1)";
+    return ss.str();
+}
+
+inline std::string tile_split_format_b(const TileSize& ts) {
+    std::ostringstream ss;
+    ss << "ir::f32(1, " << ts.tj_inner << ")(1, " << ts.tj_mid << ")(" << ts.tk_mid << ", 1)(1, " << ts.tj_outer
+       << ")";
+    return ss.str();
+}
+
+#endif // Z3_TILE_SOLVER_H
@@ -1,4 +1,7 @@
 #include "TitleSizeCalculator.h"
+#include "GemmPacked.h"
+#include "GemmBlocked.h"
+#include <cmath>
 #include <iostream>
 
 // 打印分块格式
@@ -12,38 +15,7 @@ void print_tile_format(const TileSize& ts, int M, int N, int K) {
     std::cout << "  B: K = " << ts.tk_mid * (K / ts.tk_mid) << ", N = " << ts.tj_outer * ts.tj_mid * ts.tj_inner << "\n";
 }
 
-// 2.1 分块矩阵乘法实现
-void gemm_blocked(const float* A, const float* B, float* C, int M, int N, int K, const TileSize& ts) {
-    // 外层循环 (L3 级别)
-    for (int i0 = 0; i0 < M; i0 += ts.ti_outer * ts.ti_mid * ts.ti_inner) {
-        for (int j0 = 0; j0 < N; j0 += ts.tj_outer * ts.tj_mid * ts.tj_inner) {
-            for (int k0 = 0; k0 < K; k0 += ts.tk_mid) {
-                // 中层循环 (L2 级别)
-                for (int im = i0; im < std::min(i0 + ts.ti_outer * ts.ti_mid * ts.ti_inner, M); 
-                     im += ts.ti_mid * ts.ti_inner) {
-                    for (int jm = j0; jm < std::min(j0 + ts.tj_outer * ts.tj_mid * ts.tj_inner, N); 
-                         jm += ts.tj_mid * ts.tj_inner) {
-                        // 内层循环 (L1 级别)
-                        for (int i = im; i < std::min(im + ts.ti_mid * ts.ti_inner, M); 
-                             i += ts.ti_inner) {
-                            for (int j = jm; j < std::min(jm + ts.tj_mid * ts.tj_inner, N); 
-                                 j += ts.tj_inner) {
-                                for (int k = k0; k < std::min(k0 + ts.tk_mid, K); k++) {
-                                    // 计算 4x4 子块
-                                    for (int p = i; p < std::min(i + ts.ti_inner, M); p++) {
-                                        for (int q = j; q < std::min(j + ts.tj_inner, N); q++) {
-                                            C[p * N + q] += A[p * K + k] * B[k * N + q];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-}
+// 2.1 分块矩阵乘法实现见 GemmBlocked.h
 
 // 2.2 原生未分块矩阵乘法实现
 void gemm_naive(const float* A, const float* B, float* C, int M, int N, int K) {
@@ -76,6 +48,8 @@ void print_matrix(const float* mat, int rows, int cols, int max_rows = 5, int ma
 }
 
 // 3. 测试用例（对比分块和未分块）
+// 编译：g++ -O3 -mavx2 -mfma -std=c++17 main.cpp -o tile（加 -mavx512f 使用 AVX-512 微内核，
+// 加 -DPERF_COUNTERS_ENABLE 统计 gemm_blocked 的硬件计数器）
 int main() {
     // 矩阵维度
     const int M = 512;
@@ -117,10 +91,35 @@ int main() {
     clock_t end_blocked = clock();
     double time_blocked = static_cast<double>(end_blocked - start_blocked) / CLOCKS_PER_SEC;
 
+    // 测试填充前导维后的分块实现：512 列的行步长是 L1 组数 × 行大小的整数倍，同一列的各行落在同一组
+    PaddedMatrix<float> A_pad(M, K), B_pad(K, N), C_pad(M, N);
+    A_pad.load(A.data());
+    B_pad.load(B.data());
+    std::cout << "Running blocked GEMM on padded matrices (ld = " << A_pad.ld() << ", " << B_pad.ld() << ", "
+              << C_pad.ld() << ")...\n";
+    clock_t start_padded = clock();
+    gemm_blocked(A_pad, B_pad, C_pad, ts);
+    clock_t end_padded = clock();
+    double time_padded = static_cast<double>(end_padded - start_padded) / CLOCKS_PER_SEC;
+    std::vector<float> C_padded(M * N);
+    C_pad.store(C_padded.data());
+
+    // 测试打包 + 寄存器分块微内核实现
+    std::cout << "Running packed GEMM...\n";
+    std::vector<float> C_packed(M * N, 0.0f);
+    clock_t start_packed = clock();
+    gemm_packed(A.data(), B.data(), C_packed.data(), M, N, K, ts, cache);
+    clock_t end_packed = clock();
+    double time_packed = static_cast<double>(end_packed - start_packed) / CLOCKS_PER_SEC;
+
     // 输出结果
     std::cout << "Naive GEMM execution time: " << time_naive << " seconds\n";
     std::cout << "Blocked GEMM execution time: " << time_blocked << " seconds\n";
-    std::cout << "Performance improvement: " << (time_naive / time_blocked) << "x\n";
+    std::cout << "Padded blocked GEMM execution time: " << time_padded << " seconds\n";
+    std::cout << "Packed GEMM execution time: " << time_packed << " seconds ("
+              << 2.0 * M * N * K / time_packed * 1e-9 << " GFLOP/s)\n";
+    std::cout << "Performance improvement: " << (time_naive / time_blocked) << "x (blocked), "
+              << (time_naive / time_packed) << "x (packed)\n";
 
     // 验证结果一致性（打印前 5x5）
     std::cout << "Naive GEMM Matrix C (first 5x5):\n";
@@ -139,6 +138,29 @@ int main() {
     if (consistent) {
         std::cout << "Results are consistent between naive and blocked implementations.\n";
     }
+    // 填充只改变存储布局，运算顺序与紧凑版本相同，结果应逐位一致
+    if (C_padded == C_blocked) {
+        std::cout << "Results are consistent between compact and padded blocked implementations.\n";
+    } else {
+        std::cerr << "Error: Padded blocked result differs from compact blocked result\n";
+    }
+
+    // 打包版本使用 FMA，舍入与朴素实现不同，按相对误差检查
+    bool packed_ok = true;
+    for (int i = 0; i < M * N && packed_ok; i++) {
+        if (std::abs(C_naive[i] - C_packed[i]) > 1e-5f * std::abs(C_naive[i])) {
+            packed_ok = false;
+            std::cerr << "Error: Packed result differs at index " << i << "\n";
+        }
+    }
+    if (packed_ok) {
+        std::cout << "Results are consistent between naive and packed implementations.\n";
+    }
+
+#ifdef PERF_COUNTERS_ENABLE
+    // 加 -DPERF_COUNTERS_ENABLE 编译时，打印 gemm_blocked 内部作用域的硬件计数器
+    perf_scope_report();
+#endif
 
     return 0;
 }
\ No newline at end of file
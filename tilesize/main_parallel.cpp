@@ -0,0 +1,69 @@
+#include "TitleSizeCalculator.h"
+#include "GemmParallel.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+/*
+编译：
+g++ -O3 -mavx2 -mfma -std=c++17 -pthread main_parallel.cpp -o gemm_parallel
+执行：./gemm_parallel [最大线程数]
+*/
+
+// 初始化矩阵
+void init_matrix(float* mat, int rows, int cols, float base) {
+    for (int i = 0; i < rows * cols; i++) {
+        mat[i] = base + (i % 10);  // 简单初始化，避免全相同值
+    }
+}
+
+int main(int argc, char** argv) {
+    const int M = 1536;
+    const int N = 1536;
+    const int K = 1024;
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency());
+
+    CacheConfig cache;
+    TileSizeCalculator calculator(cache);
+    TileSize ts = calculator.compute(M, N, K);
+
+    std::vector<float> A(M * K), B(K * N), C_ref(M * N, 0.0f);
+    init_matrix(A.data(), M, K, 1.0f);
+    init_matrix(B.data(), K, N, 2.0f);
+
+    // 单线程打包 GEMM 作为基准
+    auto start = std::chrono::high_resolution_clock::now();
+    gemm_packed(A.data(), B.data(), C_ref.data(), M, N, K, ts, cache);
+    auto end = std::chrono::high_resolution_clock::now();
+    double t1 = std::chrono::duration<double>(end - start).count();
+    std::cout << "Single-thread packed GEMM: " << t1 << " s, " << 2.0 * M * N * K / t1 * 1e-9 << " GFLOP/s\n";
+
+    bool ok = true;
+    for (int nt = 1; nt <= max_threads; nt *= 2) {
+        ThreadPool pool(nt);
+        GemmParallel gemm(pool, cache);
+        std::vector<float> C(M * N, 0.0f);
+
+        start = std::chrono::high_resolution_clock::now();
+        gemm(A.data(), B.data(), C.data(), M, N, K, ts);
+        end = std::chrono::high_resolution_clock::now();
+        double t = std::chrono::duration<double>(end - start).count();
+
+        for (int i = 0; i < M * N; ++i) {
+            if (std::abs(C[i] - C_ref[i]) > 1e-5f * std::abs(C_ref[i])) {
+                std::cerr << "Error: parallel result differs at index " << i << "\n";
+                ok = false;
+                break;
+            }
+        }
+
+        std::cout << nt << " threads (tile " << gemm.tile_m() << "x" << gemm.tile_n() << "): " << t << " s, "
+                  << 2.0 * M * N * K / t * 1e-9 << " GFLOP/s, speedup " << t1 / t << "x, tiles/stolen:";
+        for (const GemmWorkerStats& s : gemm.stats()) std::cout << " " << s.executed << "/" << s.stolen;
+        std::cout << "\n";
+    }
+    std::cout << (ok ? "Results are consistent with single-thread packed GEMM.\n" : "Parallel GEMM FAILED.\n");
+    return ok ? 0 : 1;
+}